@@ -0,0 +1,207 @@
+// Swarm clock convergence and one-way latency on the simulated RF medium.
+// Every drone gets a random clock offset and oscillator drift; the ground
+// station is the time reference, the leader syncs to it and the followers
+// sync to the leader. The sync error of every drone against the ground
+// station clock is sampled while the swarm loops run, and the ground
+// station measures the leader -> GBS latency from PermissionToSend
+// timestamps.
+//
+//   ./bench/clock_sync_bench [--nodes N] [--seconds S] [--offset-ms MS]
+//                            [--drift-ppm PPM]
+#include "drone.hpp"
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include "swarm.hpp"
+#include "swarm_clock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  int nodes = 8;
+  int seconds = 15;
+  double offset_ms = 5000.0;
+  double drift_ppm = 50.0;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--nodes")
+      opt.nodes = std::max(2, std::atoi(value));
+    else if (key == "--seconds")
+      opt.seconds = std::max(2, std::atoi(value));
+    else if (key == "--offset-ms")
+      opt.offset_ms = std::atof(value);
+    else if (key == "--drift-ppm")
+      opt.drift_ppm = std::atof(value);
+  }
+  return opt;
+}
+
+double percentile(std::vector<double> v, double p) {
+  if (v.empty())
+    return 0.0;
+  std::sort(v.begin(), v.end());
+  const size_t i = static_cast<size_t>(p * static_cast<double>(v.size() - 1));
+  return v[i];
+}
+
+struct GroundStation {
+  SwarmClock clock; // reference: no samples, no local model
+  std::mutex mutex;
+  std::vector<double> latency_us;
+
+  void run(RadioInterface &radio, const std::atomic<bool> &stop) {
+    while (!stop.load()) {
+      RadioFrame frame;
+      if (!radio.receive(frame)) {
+        radio.waitForFrame(std::chrono::milliseconds(5));
+        continue;
+      }
+      if (const auto *req = frame.as<TimeSyncRequestPacket>()) {
+        TimeSyncResponsePacket resp{};
+        resp.target_drone_id = req->drone_id;
+        resp.originate_us = req->originate_us;
+        resp.receive_us = clock.toSwarm(frame.rx_time_us);
+        resp.transmit_us =
+            clock.now() + frameTxLeadUs(sizeof(resp), radio.dataRate());
+        radio.sendTo(BASE_RX, &resp, sizeof(resp), true);
+      } else if (const auto *perm = frame.as<PermissionToSendPacket>()) {
+        const int32_t age = swarmAge(
+            static_cast<uint32_t>(clock.toSwarm(frame.rx_time_us)),
+            perm->timestamp);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          latency_us.push_back(age);
+        }
+        CommandPacket cmd{};
+        cmd.timestamp = clock.now32();
+        std::strncpy(cmd.command, "no_need", MAX_COMMAND_LENGTH - 1);
+        radio.send(&cmd, sizeof(cmd));
+      }
+    }
+  }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+
+  SimMedium medium;
+  RadioInterface gbs_radio(std::make_unique<SimTransport>(medium));
+  gbs_radio.begin();
+  gbs_radio.configure(1, RadioDataRate::MEDIUM_RATE);
+  gbs_radio.setAddress(BASE_RX, BASE_TX);
+  GroundStation gbs;
+
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> offset(-opt.offset_ms * 1000.0,
+                                                opt.offset_ms * 1000.0);
+  std::uniform_real_distribution<double> drift(-opt.drift_ppm, opt.drift_ppm);
+
+  std::vector<DroneIdType> ids;
+  std::vector<std::unique_ptr<RadioInterface>> radios;
+  std::vector<std::unique_ptr<Drone>> drones;
+  for (int i = 0; i < opt.nodes; ++i) {
+    const double angle = 6.283185 * i / opt.nodes;
+    auto radio = std::make_unique<RadioInterface>(std::make_unique<SimTransport>(
+        medium, 10.0 * std::cos(angle), 10.0 * std::sin(angle)));
+    radio->begin();
+    radio->configure(1, RadioDataRate::MEDIUM_RATE);
+    radio->setAddress(BASE_TX, BASE_RX);
+    radio->startRxThread();
+    auto drone = std::make_unique<Drone>(*radio, i == 0);
+    const DroneIdType id = static_cast<DroneIdType>(i + 1);
+    drone->setNetworkId(id);
+    drone->setCurrentLeaderId(1);
+    drone->clock().setLocalModel(static_cast<int64_t>(offset(rng)),
+                                 drift(rng));
+    ids.push_back(id);
+    radios.push_back(std::move(radio));
+    drones.push_back(std::move(drone));
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] { gbs.run(gbs_radio, stop); });
+  for (size_t i = 0; i < drones.size(); ++i) {
+    threads.emplace_back([&, i] {
+      std::vector<DroneIdType> swarm(ids.begin() + 1, ids.end());
+      if (i == 0)
+        leaderLoop(*radios[i], *drones[i], swarm, &stop);
+      else
+        followerLoop(*radios[i], *drones[i], nullptr, &stop);
+    });
+  }
+
+  std::printf("Swarm clock sync: %d drones, offsets +-%.0f ms, drift +-%.0f "
+              "ppm\n",
+              opt.nodes, opt.offset_ms, opt.drift_ppm);
+  std::printf("%6s %7s %12s %12s %12s\n", "t [s]", "synced", "p50 |err|",
+              "max |err|", "leader err");
+
+  const auto start = std::chrono::steady_clock::now();
+  double converged_at = -1.0;
+  std::vector<double> final_errors;
+  for (int step = 1; step <= opt.seconds * 2; ++step) {
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(500 * step));
+    const uint64_t mono = monotonicMicros();
+    const int64_t reference = static_cast<int64_t>(gbs.clock.toSwarm(mono));
+    std::vector<double> errors;
+    int synced = 0;
+    for (const auto &drone : drones) {
+      const SwarmClock &c = drone->clock();
+      const int64_t swarm =
+          static_cast<int64_t>(c.toSwarm(c.fromMonotonic(mono)));
+      errors.push_back(std::fabs(static_cast<double>(swarm - reference)));
+      synced += c.synced() ? 1 : 0;
+    }
+    const double max_err = *std::max_element(errors.begin(), errors.end());
+    if (converged_at < 0 && synced == opt.nodes && max_err < 200.0)
+      converged_at = step * 0.5;
+    if (step % 2 == 0)
+      std::printf("%6.1f %4d/%-3d %9.0f us %9.0f us %9.0f us\n", step * 0.5,
+                  synced, opt.nodes, percentile(errors, 0.5), max_err,
+                  errors[0]);
+    final_errors = errors;
+  }
+  stop = true;
+  for (auto &t : threads)
+    t.join();
+
+  // Latency samples from the second half, after convergence.
+  std::vector<double> latency;
+  {
+    std::lock_guard<std::mutex> lock(gbs.mutex);
+    latency.assign(gbs.latency_us.begin() + gbs.latency_us.size() / 2,
+                   gbs.latency_us.end());
+  }
+  if (converged_at < 0)
+    std::printf("converged (all |err| < 200 us): no\n");
+  else
+    std::printf("converged (all |err| < 200 us): %.1f s\n", converged_at);
+  std::printf("final error      : p50 %.0f us, p99 %.0f us\n",
+              percentile(final_errors, 0.5), percentile(final_errors, 0.99));
+  std::printf("leader -> GBS    : %zu samples, p50 %.0f us, p90 %.0f us, "
+              "p99 %.0f us\n",
+              latency.size(), percentile(latency, 0.5),
+              percentile(latency, 0.9), percentile(latency, 0.99));
+  return 0;
+}
@@ -0,0 +1,323 @@
+// Micro-benchmarks of the drone_core hot paths with machine readable
+// output, for comparing releases. Runs anywhere: the radio is the replay
+// fake of include/replay.hpp, no module or simulator thread is involved.
+//
+//   ./bench/drone_bench [--filter NAME] [--min-ms MS] [--repeat R]
+//                       [--json FILE]
+//
+// Each benchmark is calibrated to run at least --min-ms, then timed
+// --repeat times; the median and the fastest run are reported in ns per
+// operation. The JSON layout (schema "drone_bench/1") keeps its keys and
+// benchmark names stable; new benchmarks are only appended.
+#include "drone.hpp"
+#include "packet_traits.hpp"
+#include "packets.hpp"
+#include "radio.hpp"
+#include "replay.hpp"
+#include "spsc_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  std::string filter;
+  int min_ms = 200;
+  int repeat = 5;
+  std::string json;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--filter")
+      opt.filter = value;
+    else if (key == "--min-ms")
+      opt.min_ms = std::max(1, std::atoi(value));
+    else if (key == "--repeat")
+      opt.repeat = std::clamp(std::atoi(value), 1, 100);
+    else if (key == "--json")
+      opt.json = value;
+  }
+  return opt;
+}
+
+// Keeps the compiler from dropping a result that is never read.
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0; // per timed run
+  double median_ns = 0;
+  double min_ns = 0;
+};
+
+using Body = std::function<void(uint64_t iterations)>;
+
+double runOnce(const Body &body, uint64_t iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  body(iterations);
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+Result measure(const std::string &name, const Body &body,
+               const Options &opt) {
+  // Kalibrasyon: en az min_ms sürecek tekrar sayısı
+  uint64_t iterations = 1;
+  const double target_ns = opt.min_ms * 1e6;
+  while (true) {
+    const double ns = runOnce(body, iterations);
+    if (ns >= target_ns || iterations >= (uint64_t{1} << 40))
+      break;
+    const double scale = ns > 0 ? target_ns / ns * 1.2 : 10.0;
+    iterations = static_cast<uint64_t>(
+        static_cast<double>(iterations) * std::clamp(scale, 1.5, 10.0));
+  }
+
+  std::vector<double> per_op;
+  for (int r = 0; r < opt.repeat; ++r)
+    per_op.push_back(runOnce(body, iterations) /
+                     static_cast<double>(iterations));
+  std::sort(per_op.begin(), per_op.end());
+  Result result;
+  result.name = name;
+  result.iterations = iterations;
+  result.median_ns = per_op[per_op.size() / 2];
+  result.min_ns = per_op.front();
+  return result;
+}
+
+TelemetryPacket sampleTelemetry(uint64_t i) {
+  TelemetryPacket tlm{};
+  tlm.drone_id = 2;
+  tlm.timestamp = static_cast<uint32_t>(i);
+  tlm.acceleration_x = static_cast<int16_t>(i);
+  tlm.acceleration_y = static_cast<int16_t>(i * 3);
+  tlm.acceleration_z = 16384;
+  tlm.battery_voltage = 3.7f;
+  tlm.altitude = 120.0f;
+  tlm.link_quality = 100.0f;
+  return tlm;
+}
+
+template <typename T> RadioFrame frameOf(const T &packet, uint8_t pipe) {
+  RadioFrame frame;
+  std::memcpy(frame.data.data(), &packet, sizeof(T));
+  frame.size = sizeof(T);
+  frame.pipe = pipe;
+  return frame;
+}
+
+ReplayFrame replayOf(const RadioFrame &frame) {
+  ReplayFrame f;
+  f.pipe = frame.pipe;
+  f.size = frame.size;
+  f.data = frame.data;
+  return f;
+}
+
+// What a follower typically reads in a superframe, without packets whose
+// handlers print.
+std::vector<RadioFrame> followerMix() {
+  TdmaScheduler scheduler;
+  scheduler.setMembers({2, 3, 4, 5, 6, 7, 8, 9});
+  PermissionToSendPacket perm{};
+  perm.target_drone_id = 2;
+  LeaderAnnouncementPacket ann{};
+  ann.new_leader_id = 1;
+  TimeSyncResponsePacket sync{};
+  sync.target_drone_id = 2;
+  LinkControlPacket ctl{};
+  ctl.target_drone_id = 2;
+  return {frameOf(scheduler.nextBeacon(1, 0), GROUP_PIPE),
+          frameOf(perm, UNICAST_PIPE), frameOf(ann, GROUP_PIPE),
+          frameOf(sync, UNICAST_PIPE), frameOf(ctl, 0)};
+}
+
+// Counts packets per type; stands in for Drone::PacketHandler.
+struct CountingHandler {
+  uint64_t counts[16] = {};
+  template <typename T> void operator()(const T &packet) {
+    counts[static_cast<uint8_t>(packet.type) & 15]++;
+  }
+};
+
+struct BenchRadio {
+  ReplayTransport *fake;
+  std::unique_ptr<RadioInterface> radio;
+  std::unique_ptr<Drone> drone;
+
+  BenchRadio() {
+    auto transport = std::make_unique<ReplayTransport>();
+    fake = transport.get();
+    radio = std::make_unique<RadioInterface>(std::move(transport));
+    radio->begin();
+    drone = std::make_unique<Drone>(*radio, false, "Bench");
+    JoinResponsePacket join{};
+    join.assigned_id = 2;
+    join.current_leader_id = 1;
+    join.unicast_address = unicastAddressByte(2);
+    join.group_address = groupAddressByte(0);
+    drone->applyJoinResponse(join);
+  }
+};
+
+std::vector<std::pair<std::string, Body>> benchmarks() {
+  std::vector<std::pair<std::string, Body>> list;
+
+  list.emplace_back("packet_serialize_telemetry", [](uint64_t n) {
+    RadioFrame frame;
+    for (uint64_t i = 0; i < n; ++i) {
+      const TelemetryPacket tlm = sampleTelemetry(i);
+      std::memcpy(frame.data.data(), &tlm, sizeof(tlm));
+      frame.size = sizeof(tlm);
+      keep(frame);
+    }
+  });
+
+  list.emplace_back("packet_deserialize_telemetry", [](uint64_t n) {
+    const RadioFrame frame = frameOf(sampleTelemetry(1), LEADER_PIPE);
+    float sum = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      keep(frame);
+      if (const auto *tlm = frame.as<TelemetryPacket>())
+        sum += tlm->altitude;
+    }
+    keep(sum);
+  });
+
+  list.emplace_back("packet_validate", [](uint64_t n) {
+    const std::vector<RadioFrame> mix = followerMix();
+    uint64_t valid = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      const RadioFrame &f = mix[i % mix.size()];
+      keep(f);
+      valid += isValidPacket(f.data.data(), f.size);
+    }
+    keep(valid);
+  });
+
+  list.emplace_back("packet_dispatch_mix", [](uint64_t n) {
+    const std::vector<RadioFrame> mix = followerMix();
+    CountingHandler handler;
+    for (uint64_t i = 0; i < n; ++i) {
+      const RadioFrame &f = mix[i % mix.size()];
+      keep(f);
+      dispatchPacket(handler, f.data.data(), f.size);
+    }
+    keep(handler.counts);
+  });
+
+  list.emplace_back("rx_ring_push_pop", [](uint64_t n) {
+    auto ring = std::make_unique<SpscRing<RadioFrame, 64>>();
+    const RadioFrame frame = frameOf(sampleTelemetry(1), LEADER_PIPE);
+    for (uint64_t i = 0; i < n; ++i) {
+      RadioFrame *slot = ring->acquire();
+      *slot = frame;
+      ring->publish();
+      const RadioFrame *front = ring->front();
+      keep(front->size);
+      ring->pop();
+    }
+  });
+
+  list.emplace_back("drone_update_sensors", [](uint64_t n) {
+    BenchRadio bench;
+    for (uint64_t i = 0; i < n; ++i) {
+      const auto v = static_cast<int16_t>(i);
+      bench.drone->updateSensors(v, v, 16384, v, v, v, 120.0f, 3.7f);
+    }
+  });
+
+  list.emplace_back("radio_receive", [](uint64_t n) {
+    BenchRadio bench;
+    const ReplayFrame f = replayOf(frameOf(sampleTelemetry(1), LEADER_PIPE));
+    RadioFrame frame;
+    for (uint64_t i = 0; i < n; ++i) {
+      bench.fake->push(f, i + 1); // fake FIFO write included
+      bench.radio->receive(frame);
+      keep(frame);
+    }
+  });
+
+  list.emplace_back("drone_handle_incoming_mix", [](uint64_t n) {
+    BenchRadio bench;
+    std::vector<ReplayFrame> mix;
+    for (const RadioFrame &f : followerMix())
+      mix.push_back(replayOf(f));
+    size_t handled = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      bench.fake->push(mix[i % mix.size()], i + 1);
+      handled += bench.drone->handleIncoming();
+    }
+    keep(handled);
+  });
+
+  return list;
+}
+
+void writeJson(std::FILE *out, const std::vector<Result> &results,
+               const Options &opt) {
+  std::fprintf(out, "{\n  \"schema\": \"drone_bench/1\",\n");
+#ifdef __VERSION__
+  std::fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+  std::fprintf(out, "  \"min_ms\": %d,\n  \"repeat\": %d,\n", opt.min_ms,
+               opt.repeat);
+  std::fprintf(out, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    std::fprintf(out,
+                 "    {\"name\": \"%s\", \"iterations\": %llu, "
+                 "\"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, "
+                 "\"ops_per_sec\": %.0f}%s\n",
+                 r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                 r.median_ns, r.min_ns,
+                 r.median_ns > 0 ? 1e9 / r.median_ns : 0.0,
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(out, "  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+
+  std::vector<Result> results;
+  for (const auto &[name, body] : benchmarks()) {
+    if (!opt.filter.empty() && name.find(opt.filter) == std::string::npos)
+      continue;
+    results.push_back(measure(name, body, opt));
+    const Result &r = results.back();
+    std::fprintf(stderr, "%-28s %10.2f ns/op  (min %.2f, %llu iterations)\n",
+                 r.name.c_str(), r.median_ns, r.min_ns,
+                 static_cast<unsigned long long>(r.iterations));
+  }
+
+  if (opt.json.empty()) {
+    writeJson(stdout, results, opt);
+    return 0;
+  }
+  std::FILE *out = std::fopen(opt.json.c_str(), "w");
+  if (!out) {
+    std::fprintf(stderr, "Could not write %s\n", opt.json.c_str());
+    return 1;
+  }
+  writeJson(out, results, opt);
+  std::fclose(out);
+  return 0;
+}
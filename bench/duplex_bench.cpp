@@ -0,0 +1,195 @@
+// Full duplex throughput of RadioInterface on the simulated medium.
+//
+//   ./bench/duplex_bench [--seconds S] [--rate 250k|1m|2m]
+//
+// Two nodes stream 32-byte frames to each other as fast as the link
+// allows. Each direction has a producer posting into the node's TX thread
+// and a consumer reading from the peer's RX thread. With two modules per
+// node (TX on the peer's RX channel) both directions are measured alone
+// and then at the same time; the combined rate should come close to the
+// sum of the two. For comparison a single transceiver per node streams in
+// one direction: a half duplex link shares that rate between both
+// directions (two saturated single modules only hear each other in the
+// gaps between their own frames).
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t ADDR_A = 0xF0F0F0F0AAULL;
+constexpr uint64_t ADDR_B = 0xF0F0F0F0BBULL;
+constexpr uint8_t CHANNEL_TO_B = 10;
+constexpr uint8_t CHANNEL_TO_A = 40;
+
+struct Options {
+  int seconds = 3;
+  RadioDataRate rate = RadioDataRate::HIGH_RATE;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+    if (key == "--seconds")
+      opt.seconds = std::max(1, std::atoi(value.c_str()));
+    else if (key == "--rate")
+      opt.rate = value == "250k" ? RadioDataRate::LOW_RATE
+                 : value == "1m" ? RadioDataRate::MEDIUM_RATE
+                                 : RadioDataRate::HIGH_RATE;
+  }
+  return opt;
+}
+
+struct Node {
+  std::unique_ptr<RadioInterface> radio;
+  DroneIdType id;
+};
+
+Node makeNode(SimMedium &medium, DroneIdType id, double x, bool duplex,
+              const Options &opt) {
+  Node node;
+  node.id = id;
+  if (duplex)
+    node.radio = std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, x, 0.0),
+        std::make_unique<SimTransport>(medium, x, 0.0));
+  else
+    node.radio = std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, x, 0.0));
+  RadioInterface &radio = *node.radio;
+  radio.begin();
+  const bool is_a = id == 1;
+  radio.configure(duplex && is_a ? CHANNEL_TO_A : CHANNEL_TO_B, opt.rate);
+  if (duplex)
+    radio.setTxChannel(is_a ? CHANNEL_TO_B : CHANNEL_TO_A);
+  radio.setAddress(is_a ? ADDR_B : ADDR_A, is_a ? ADDR_A : ADDR_B);
+  radio.startRxThread();
+  radio.startTxThread();
+  return node;
+}
+
+struct Direction {
+  Node *from;
+  Node *to;
+  uint64_t posted = 0;
+  uint64_t ring_full = 0;
+  uint64_t received = 0;
+  uint64_t lost = 0; // sequence gaps seen by the receiver
+};
+
+// Runs every direction at once for `seconds` and fills in the counters.
+void stream(std::vector<Direction> &dirs, int seconds) {
+  std::atomic<int> producing{static_cast<int>(dirs.size())};
+  std::vector<std::thread> threads;
+  const auto end =
+      std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  for (Direction &d : dirs) {
+    threads.emplace_back([&d, &producing, end] {
+      TelemetryPacket tlm{};
+      tlm.drone_id = d.from->id;
+      while (std::chrono::steady_clock::now() < end) {
+        tlm.timestamp = static_cast<uint32_t>(d.posted + 1);
+        if (d.from->radio->post(&tlm, sizeof(tlm))) {
+          d.posted++;
+        } else {
+          d.ring_full++;
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+      }
+      while (d.from->radio->txPending() > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      producing--;
+    });
+    threads.emplace_back([&d, &producing] {
+      RadioInterface &radio = *d.to->radio;
+      uint32_t last = 0;
+      auto quiet_since = std::chrono::steady_clock::now();
+      for (;;) {
+        RadioFrame frame;
+        if (radio.receive(frame)) {
+          quiet_since = std::chrono::steady_clock::now();
+          const auto *tlm = frame.as<TelemetryPacket>();
+          if (!tlm || tlm->drone_id != d.from->id)
+            continue;
+          d.received++;
+          if (tlm->timestamp > last + 1)
+            d.lost += tlm->timestamp - last - 1;
+          last = std::max(last, tlm->timestamp);
+          continue;
+        }
+        // Kaynak bittikten sonra 20 ms sessizlik: akış tamam
+        if (producing.load() == 0 &&
+            std::chrono::steady_clock::now() - quiet_since >
+                std::chrono::milliseconds(20))
+          return;
+        radio.waitForFrame(std::chrono::milliseconds(1));
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+}
+
+double report(const char *label, const std::vector<Direction> &dirs,
+              int seconds) {
+  double total = 0.0;
+  for (const Direction &d : dirs) {
+    const double rate = static_cast<double>(d.received) / seconds;
+    total += rate;
+    std::printf("%-26s %u->%u %7.0f frames/s %6.1f kbit/s  lost %llu, TX "
+                "failed %llu, ring full %llu\n",
+                label, d.from->id, d.to->id, rate,
+                rate * sizeof(TelemetryPacket) * 8 / 1000.0,
+                static_cast<unsigned long long>(d.lost),
+                static_cast<unsigned long long>(d.from->radio->txFailed()),
+                static_cast<unsigned long long>(d.ring_full));
+    label = "";
+  }
+  return total;
+}
+
+double run(bool duplex, bool a_to_b, bool b_to_a, const char *label,
+           const Options &opt) {
+  SimMedium medium;
+  Node a = makeNode(medium, 1, 0.0, duplex, opt);
+  Node b = makeNode(medium, 2, 5.0, duplex, opt);
+  std::vector<Direction> dirs;
+  if (a_to_b)
+    dirs.push_back({&a, &b});
+  if (b_to_a)
+    dirs.push_back({&b, &a});
+  stream(dirs, opt.seconds);
+  return report(label, dirs, opt.seconds);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  std::printf("%zu-byte frames, %d s per run\n\n", sizeof(TelemetryPacket),
+              opt.seconds);
+
+  const double ab = run(true, true, false, "Duplex, one direction", opt);
+  const double ba = run(true, false, true, "", opt);
+  const double both = run(true, true, true, "Duplex, both directions", opt);
+  const double single = run(false, true, false, "Single module, one way", opt);
+
+  std::printf("\nDuplex combined  : %.0f frames/s, %.0f%% of the two "
+              "directions alone (%.0f)\n",
+              both, 100.0 * both / (ab + ba), ab + ba);
+  std::printf("Half duplex      : %.0f frames/s shared, duplex gain x%.2f\n",
+              single,
+              single > 0 ? both / single : 0.0);
+  return 0;
+}
@@ -0,0 +1,228 @@
+// Goodput of FragmentSender/FragmentReceiver on the simulated medium.
+//
+//   ./bench/fragment_bench [--messages N] [--loss P] [--multicast 0|1]
+//                          [--rate 1m|2m]
+//
+// A drone (id 1) sends messages of several sizes to the ground station
+// (id 0); both run an RX thread. The baseline streams bare 32-byte frames
+// the same way the fragments go out (post() bursts of 16, flushTx(),
+// multicast when the fragments are), so "frame efficiency" is the
+// fragment rate that carried new data against the raw frame rate that
+// arrived. The remaining cost is the 6-byte fragment header (26 of 32
+// bytes) and the ACK round trips. Every reassembled message is compared
+// with what was sent (message ids count on from the sender's random one).
+#include "fragment.hpp"
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include "timebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t CHANNEL = 76;
+constexpr DroneIdType DRONE = 1;
+constexpr DroneIdType GBS = 0;
+constexpr size_t SIZES[] = {64, 256, 1024, 4096, FRAGMENT_MAX_MESSAGE};
+constexpr size_t RAW_BURST = 16;
+
+struct Options {
+  int messages = 40;
+  double loss = 0.0;
+  bool multicast = false;
+  RadioDataRate rate = RadioDataRate::HIGH_RATE;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+    if (key == "--messages")
+      opt.messages = std::max(1, std::atoi(value.c_str()));
+    else if (key == "--loss")
+      opt.loss = std::clamp(std::atof(value.c_str()), 0.0, 0.9);
+    else if (key == "--multicast")
+      opt.multicast = std::atoi(value.c_str()) != 0;
+    else if (key == "--rate")
+      opt.rate = value == "1m" ? RadioDataRate::MEDIUM_RATE
+                               : RadioDataRate::HIGH_RATE;
+  }
+  return opt;
+}
+
+// Drone ve GBS: her biri tek modül ve kendi RX thread'i
+struct Link {
+  std::unique_ptr<SimMedium> medium;
+  std::unique_ptr<RadioInterface> drone;
+  std::unique_ptr<RadioInterface> gbs;
+};
+
+Link makeLink(const Options &opt) {
+  SimMediumConfig cfg;
+  cfg.loss_probability = opt.loss;
+  Link link;
+  link.medium = std::make_unique<SimMedium>(cfg);
+  link.drone = std::make_unique<RadioInterface>(
+      std::make_unique<SimTransport>(*link.medium, 0.0, 0.0));
+  link.gbs = std::make_unique<RadioInterface>(
+      std::make_unique<SimTransport>(*link.medium, 10.0, 0.0));
+  link.drone->begin();
+  link.drone->configure(CHANNEL, opt.rate);
+  link.drone->setAddress(BASE_TX, fragmentAddress(DRONE));
+  link.gbs->begin();
+  link.gbs->configure(CHANNEL, opt.rate);
+  link.gbs->setAddress(BASE_RX, fragmentAddress(GBS));
+  link.drone->startRxThread();
+  link.gbs->startRxThread();
+  return link;
+}
+
+uint8_t patternByte(int message, size_t i) {
+  return static_cast<uint8_t>(message * 131 + i * 7 + (i >> 8));
+}
+
+// Çıplak 32 baytlık çerçeveler, parçalarla aynı burst düzeninde
+double rawFramesPerSecond(const Options &opt, size_t frames) {
+  Link link = makeLink(opt);
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> received{0};
+  std::thread rx([&] {
+    RadioFrame frame;
+    while (running.load()) {
+      if (link.gbs->receive(frame))
+        received++;
+      else
+        link.gbs->waitForFrame(std::chrono::milliseconds(1));
+    }
+  });
+  TelemetryPacket tlm{};
+  tlm.drone_id = DRONE;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < frames; ++i) {
+    tlm.timestamp = static_cast<uint32_t>(i);
+    link.drone->postTo(BASE_TX, &tlm, sizeof(tlm), opt.multicast);
+    if ((i + 1) % RAW_BURST == 0)
+      link.drone->flushTx();
+  }
+  link.drone->flushTx();
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  running = false;
+  rx.join();
+  return received.load() / secs;
+}
+
+struct Result {
+  double seconds = 0.0;
+  uint64_t bytes = 0;
+  uint64_t verified = 0;
+  uint64_t corrupt = 0;
+  FragmentSenderStats sender;
+  FragmentReceiverStats receiver;
+};
+
+Result runSize(const Options &opt, size_t size) {
+  Link link = makeLink(opt);
+  FragmentConfig cfg;
+  cfg.multicast = opt.multicast;
+  FragmentSender sender(*link.drone, DRONE, cfg);
+  FragmentReceiver receiver(*link.gbs, GBS, cfg);
+
+  Result result;
+  const uint8_t first = static_cast<uint8_t>(sender.messageId() + 1);
+  std::atomic<bool> running{true};
+  std::thread gbs([&] {
+    RadioFrame frame;
+    while (running.load()) {
+      if (!link.gbs->receive(frame)) {
+        link.gbs->waitForFrame(std::chrono::milliseconds(1));
+        continue;
+      }
+      const FragmentMessage *msg =
+          receiver.handleFrame(frame, monotonicMicros());
+      if (!msg)
+        continue;
+      bool ok = msg->size == size;
+      for (size_t i = 0; ok && i < size; ++i)
+        ok = msg->data[i] ==
+             patternByte(static_cast<uint8_t>(msg->message_id - first), i);
+      (ok ? result.verified : result.corrupt)++;
+    }
+  });
+
+  std::vector<uint8_t> message(size);
+  const auto start = std::chrono::steady_clock::now();
+  for (int m = 0; m < opt.messages; ++m) {
+    for (size_t i = 0; i < size; ++i)
+      message[i] = patternByte(m, i);
+    sender.start(GBS, message.data(), message.size());
+    RadioFrame frame;
+    while (sender.busy()) {
+      sender.poll(monotonicMicros());
+      bool any = false;
+      while (link.drone->receive(frame)) {
+        sender.handleFrame(frame, monotonicMicros());
+        any = true;
+      }
+      if (!any && sender.busy())
+        link.drone->waitForFrame(std::chrono::microseconds(200));
+    }
+    if (sender.state() == FragmentState::DELIVERED)
+      result.bytes += size;
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  running = false;
+  gbs.join();
+  result.sender = sender.stats();
+  result.receiver = receiver.stats();
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  std::printf("%d messages per size, loss %.0f%%, %s fragments\n\n",
+              opt.messages, opt.loss * 100.0,
+              opt.multicast ? "multicast" : "acknowledged");
+
+  const double raw = rawFramesPerSecond(opt, 4000);
+  std::printf("Raw 32-byte frames   : %7.0f frames/s %8.0f B/s payload\n\n",
+              raw, raw * 32);
+
+  std::printf("%7s %9s %10s %8s %7s %7s %8s %6s %9s\n", "size", "goodput",
+              "frag/s", "eff.", "rounds", "resent", "timeouts", "acks",
+              "verified");
+  for (size_t size : SIZES) {
+    const Result r = runSize(opt, size);
+    const double goodput = r.bytes / r.seconds;
+    const double useful = goodput / FRAGMENT_PAYLOAD;
+    std::printf("%7zu %7.0f/s %10.0f %7.1f%% %7llu %7llu %8llu %6llu %5llu/%d",
+                size, goodput, useful, 100.0 * useful / raw,
+                static_cast<unsigned long long>(r.sender.rounds),
+                static_cast<unsigned long long>(r.sender.resent),
+                static_cast<unsigned long long>(r.sender.timeouts),
+                static_cast<unsigned long long>(r.receiver.acks),
+                static_cast<unsigned long long>(r.verified), opt.messages);
+    if (r.corrupt || r.sender.failed)
+      std::printf("  corrupt %llu, failed %llu",
+                  static_cast<unsigned long long>(r.corrupt),
+                  static_cast<unsigned long long>(r.sender.failed));
+    std::printf("\n");
+  }
+  return 0;
+}
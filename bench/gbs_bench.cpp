@@ -0,0 +1,478 @@
+// Ground station ingest rate against the 2 Mbps line rate, with all 200
+// network ids joined.
+//
+//   ./bench/gbs_bench [--drones N] [--frames N] [--seconds S] [--senders K]
+//                     [--radios R]
+//
+// First the GroundStation handles a replayed mix of telemetry, leader
+// aggregates and delta compressed frames as fast as it can; the result is
+// compared with the frame budget of one 32-byte exchange at 2 Mbps
+// (tdmaExchangeUs). Next, drones that booted together (same temp id and
+// name, only the join nonce differs) join at once; each must take only
+// its own response and get an id of its own. Then K simulated radios join
+// the drones over the air
+// and transmit telemetry back to back at 2 Mbps for S seconds while the
+// ground station runs with its RX thread. It keeps up if every frame the
+// medium delivered was handled and no frame was dropped in a full FIFO.
+//
+// With R > 1 the same runs again with a RadioBank of R modules, one per
+// channel and K senders each, after a check of the bank's merge: frames
+// heard by two modules must come out once and in arrival order.
+#include "ground_station.hpp"
+#include "packet_traits.hpp"
+#include "radio.hpp"
+#include "radio_bank.hpp"
+#include "replay.hpp"
+#include "sim_radio.hpp"
+#include "spectrum.hpp"
+#include "tdma.hpp"
+#include "telemetry_codec.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  int drones = GBS_MAX_DRONES;
+  int frames = 2000000;
+  int seconds = 5;
+  int senders = 1;
+  int radios = 3;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--drones")
+      opt.drones = std::clamp(std::atoi(value), 1, int{GBS_MAX_DRONES});
+    else if (key == "--frames")
+      opt.frames = std::max(1, std::atoi(value));
+    else if (key == "--seconds")
+      opt.seconds = std::max(1, std::atoi(value));
+    else if (key == "--senders")
+      opt.senders = std::clamp(std::atoi(value), 1, 16);
+    else if (key == "--radios")
+      opt.radios = std::clamp(std::atoi(value), 1, int{RADIO_BANK_MAX});
+  }
+  return opt;
+}
+
+template <typename T> ReplayFrame replayOf(const T &packet) {
+  ReplayFrame f;
+  f.size = sizeof(T);
+  std::memcpy(f.data.data(), &packet, sizeof(T));
+  return f;
+}
+
+JoinRequestPacket joinRequest(DroneIdType temp_id, uint32_t nonce) {
+  JoinRequestPacket req{};
+  req.temp_id = temp_id;
+  req.nonce = nonce;
+  std::snprintf(req.requested_name, MAX_NODE_NAME_LENGTH, "Drone%u", temp_id);
+  return req;
+}
+
+TelemetryPacket telemetry(DroneIdType id, uint32_t n) {
+  TelemetryPacket tlm{};
+  tlm.drone_id = id;
+  tlm.timestamp = n * 10000;
+  tlm.acceleration_x = static_cast<int16_t>(n * 7);
+  tlm.acceleration_y = static_cast<int16_t>(n * 3);
+  tlm.acceleration_z = 16384;
+  tlm.gyroscope_x = static_cast<int16_t>(n);
+  tlm.battery_voltage = 3.9f - 0.0001f * static_cast<float>(n % 1000);
+  tlm.altitude = 120.0f;
+  tlm.link_quality = 100.0f;
+  return tlm;
+}
+
+// One stream cycling over the drones: a TelemetryPacket from each, an
+// aggregate of three followers every fourth frame and a compressed frame
+// every eighth.
+std::vector<ReplayFrame> ingestMix(int drones) {
+  std::vector<ReplayFrame> mix;
+  std::vector<TelemetryEncoder> encoders;
+  for (int id = 1; id <= drones; ++id)
+    encoders.emplace_back(static_cast<DroneIdType>(id));
+  for (uint32_t n = 0; n < 64; ++n) {
+    for (int id = 1; id <= drones; ++id) {
+      const auto self = static_cast<DroneIdType>(id);
+      const size_t i = mix.size();
+      if (i % 8 == 7) {
+        TelemetryEncoder &enc = encoders[static_cast<size_t>(id - 1)];
+        for (uint32_t k = 0; k < 4 && enc.push(telemetry(self, n * 4 + k)); ++k)
+          ;
+        const CompressedTelemetryPacket frame = enc.takeFrame();
+        enc.acknowledge(frame);
+        mix.push_back(replayOf(frame));
+      } else if (i % 4 == 3) {
+        AggregateTelemetryPacket agg{};
+        agg.leader_id = 1;
+        agg.sequence = static_cast<uint8_t>(i);
+        agg.count = 3;
+        for (uint8_t e = 0; e < 3; ++e) {
+          agg.entries[e].drone_id =
+              static_cast<DroneIdType>((id + e) % drones + 1);
+          agg.entries[e].acceleration[2] = 64;
+        }
+        mix.push_back(replayOf(agg));
+      } else {
+        mix.push_back(replayOf(telemetry(self, n)));
+      }
+    }
+  }
+  return mix;
+}
+
+void replayIngest(const Options &opt) {
+  auto transport = std::make_unique<ReplayTransport>();
+  ReplayTransport &fake = *transport;
+  RadioInterface radio(std::move(transport));
+  radio.begin();
+  GroundStationConfig cfg;
+  cfg.expire_us = 0;
+  GroundStation gbs(radio, cfg);
+  gbs.begin();
+
+  for (int id = 1; id <= opt.drones; ++id)
+    fake.push(replayOf(joinRequest(static_cast<DroneIdType>(id),
+                                   static_cast<uint32_t>(id))),
+              1);
+  gbs.poll(SIZE_MAX);
+
+  const std::vector<ReplayFrame> mix = ingestMix(opt.drones);
+  const auto frames = static_cast<size_t>(opt.frames);
+  const auto start = std::chrono::steady_clock::now();
+  // FIFO'yu üçer çerçeve doldur, modül gibi
+  for (size_t i = 0; i < frames;) {
+    for (size_t k = 0; k < 3 && i < frames; ++k, ++i)
+      fake.push(mix[i % mix.size()], i + 1);
+    gbs.poll();
+  }
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  const uint32_t budget_us =
+      tdmaExchangeUs(sizeof(TelemetryPacket), RadioDataRate::HIGH_RATE);
+  const double line_rate = 1e6 / budget_us;
+  const double ns_per_frame = secs * 1e9 / static_cast<double>(frames);
+  const GroundStationStats &s = gbs.stats();
+  std::printf("Replay ingest   : %zu drones joined, leader %d\n",
+              gbs.table().activeCount(), gbs.leader() ? *gbs.leader() : -1);
+  std::printf("Frames          : %zu in %.3f s, %.0f frames/s, %.0f ns/frame\n",
+              frames, secs, frames / secs, ns_per_frame);
+  std::printf("Samples         : %llu (%llu unknown, %llu undecodable)\n",
+              static_cast<unsigned long long>(s.telemetry),
+              static_cast<unsigned long long>(s.unknown),
+              static_cast<unsigned long long>(s.undecodable));
+  std::printf("2 Mbps budget   : %u us per 32-byte exchange, %.0f frames/s, "
+              "headroom x%.0f\n",
+              budget_us, line_rate, (frames / secs) / line_rate);
+}
+
+// Two modules on one channel hear every frame, 30 us apart; one of them
+// also hears a frame of its own every other step. The merged stream must
+// hold each payload once, oldest first.
+void bankMerge(const Options &opt) {
+  auto t0 = std::make_unique<ReplayTransport>();
+  auto t1 = std::make_unique<ReplayTransport>();
+  ReplayTransport &fake0 = *t0;
+  ReplayTransport &fake1 = *t1;
+  RadioInterface radio0(std::move(t0));
+  RadioInterface radio1(std::move(t1));
+  radio0.begin();
+  radio1.begin();
+  RadioBank bank;
+  bank.add(radio0);
+  bank.add(radio1);
+
+  const auto steps = static_cast<uint32_t>(opt.frames / 2);
+  uint64_t unique = 0;
+  uint64_t out_of_order = 0;
+  uint64_t last = 0;
+  BankFrame out;
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < steps; ++n) {
+    const uint64_t t = 1000 + uint64_t{n} * 100;
+    const auto id = static_cast<DroneIdType>(n % static_cast<uint32_t>(opt.drones) + 1);
+    const ReplayFrame both = replayOf(telemetry(id, 2 * n));
+    fake1.push(both, t + 30);
+    fake0.push(both, t);
+    unique++;
+    if (n % 2) {
+      fake1.push(replayOf(telemetry(id, 2 * n + 1)), t + 60);
+      unique++;
+    }
+    while (bank.next(out, t)) {
+      out_of_order += out.frame.rx_time_us < last;
+      last = out.frame.rx_time_us;
+    }
+  }
+  while (bank.next(out, UINT64_MAX / 2)) {
+    out_of_order += out.frame.rx_time_us < last;
+    last = out.frame.rx_time_us;
+  }
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  const RadioBankStats &s = bank.stats();
+  const uint64_t heard = s.frames[0] + s.frames[1];
+  std::printf("\nBank merge      : %llu frames heard by 2 modules, %.0f ns/frame\n",
+              static_cast<unsigned long long>(heard),
+              secs * 1e9 / static_cast<double>(heard));
+  std::printf("Merged stream   : %llu delivered of %llu unique, %llu duplicates "
+              "dropped, %llu out of order\n",
+              static_cast<unsigned long long>(s.delivered),
+              static_cast<unsigned long long>(unique),
+              static_cast<unsigned long long>(s.duplicates),
+              static_cast<unsigned long long>(out_of_order));
+  const bool exact = s.delivered == unique && out_of_order == 0;
+  std::printf("Exactly once    : %s\n", exact ? "yes" : "NO");
+}
+
+// Drones booted in the same second: one temp id and name, different
+// nonces. All repeat their request every 10-30 ms until a response echoing
+// their own nonce arrives; the others' responses are heard and skipped.
+void concurrentJoin() {
+  constexpr size_t DRONES = 16;
+  constexpr DroneIdType TEMP_ID = 7;
+  SimMedium medium;
+  RadioInterface gbs_radio(std::make_unique<SimTransport>(medium, 0.0, 0.0));
+  gbs_radio.begin();
+  gbs_radio.configure(JOIN_CHANNEL, RadioDataRate::HIGH_RATE);
+  GroundStation gbs(gbs_radio);
+  gbs.begin();
+  gbs_radio.startRxThread();
+  std::atomic<bool> stop{false};
+  std::thread gbs_thread([&] { gbs.run(stop); });
+
+  std::vector<std::unique_ptr<RadioInterface>> drones;
+  for (size_t k = 0; k < DRONES; ++k) {
+    drones.push_back(std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, 5.0 + k, 3.0)));
+    drones.back()->begin();
+    drones.back()->configure(JOIN_CHANNEL, RadioDataRate::HIGH_RATE);
+    drones.back()->setAddress(BASE_TX, BASE_RX);
+  }
+
+  std::vector<DroneIdType> ids(DRONES, 0);
+  std::atomic<uint64_t> foreign{0};
+  std::vector<std::thread> threads;
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (size_t k = 0; k < DRONES; ++k) {
+    threads.emplace_back([&, k] {
+      RadioInterface &radio = *drones[k];
+      const uint32_t nonce = 0x9E3779B9u * static_cast<uint32_t>(k + 1);
+      const JoinRequestPacket req = joinRequest(TEMP_ID, nonce);
+      for (uint32_t n = 0;
+           !ids[k] && std::chrono::steady_clock::now() < deadline; ++n) {
+        radio.send(&req, sizeof(req));
+        // Aynı anda açılanlar aynı aralıkla tekrarlamasın
+        const auto until = std::chrono::steady_clock::now() +
+                           std::chrono::milliseconds(10 + (nonce >> n % 28) % 21);
+        while (!ids[k] && std::chrono::steady_clock::now() < until) {
+          RadioFrame frame;
+          if (!radio.receive(frame)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+          }
+          const auto *p = frame.as<JoinResponsePacket>();
+          if (!p)
+            continue;
+          if (p->nonce == req.nonce && p->temp_id == req.temp_id)
+            ids[k] = p->assigned_id;
+          else
+            foreign++;
+        }
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  stop = true;
+  gbs_thread.join();
+  gbs_radio.stopRxThread();
+
+  const size_t joined = static_cast<size_t>(
+      std::count_if(ids.begin(), ids.end(), [](DroneIdType id) { return id; }));
+  std::vector<DroneIdType> unique = ids;
+  std::sort(unique.begin(), unique.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+  std::printf("\nConcurrent join : %zu drones with temp id %u, %zu joined, "
+              "%zu distinct ids, %llu foreign responses skipped\n",
+              DRONES, TEMP_ID, joined, unique.size(),
+              static_cast<unsigned long long>(foreign.load()));
+  std::printf("Join traffic    : %llu requests answered, %llu collisions\n",
+              static_cast<unsigned long long>(gbs.stats().joins),
+              static_cast<unsigned long long>(medium.stats().collisions));
+  const bool distinct = joined == DRONES && unique.size() == DRONES &&
+                        gbs.table().activeCount() == DRONES;
+  std::printf("Distinct ids    : %s\n", distinct ? "yes" : "NO");
+}
+
+void simIngest(const Options &opt, int radios) {
+  SimMedium medium;
+  std::vector<std::unique_ptr<RadioInterface>> modules;
+  RadioBank bank;
+  for (int r = 0; r < radios; ++r) {
+    modules.push_back(std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, 0.0, 10.0 * r)));
+    modules.back()->begin();
+    modules.back()->configure(static_cast<uint8_t>(JOIN_CHANNEL + 12 * r),
+                              RadioDataRate::HIGH_RATE);
+    if (radios > 1)
+      bank.add(*modules.back());
+  }
+  std::unique_ptr<GroundStation> gbs_ptr =
+      radios > 1 ? std::make_unique<GroundStation>(bank)
+                 : std::make_unique<GroundStation>(*modules[0]);
+  GroundStation &gbs = *gbs_ptr;
+  gbs.begin();
+  if (radios > 1)
+    bank.start();
+  else
+    modules[0]->startRxThread();
+
+  std::atomic<bool> stop{false};
+  std::thread gbs_thread([&] { gbs.run(stop); });
+
+  // Her modüle K gönderici; katılma hepsinde JOIN_CHANNEL üzerinden
+  const size_t per_module = static_cast<size_t>(opt.senders);
+  std::vector<std::unique_ptr<RadioInterface>> senders;
+  for (size_t k = 0; k < per_module * modules.size(); ++k) {
+    senders.push_back(std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, 5.0 + k, 0.0)));
+    senders.back()->begin();
+    senders.back()->configure(JOIN_CHANNEL, RadioDataRate::HIGH_RATE);
+    senders.back()->setAddress(BASE_TX, BASE_RX);
+  }
+
+  // Kimlikler havadan alınır; atanan kanalın modülüne göre paylaştırılır
+  std::vector<std::vector<DroneIdType>> by_module(modules.size());
+  for (int temp = 1; temp <= opt.drones; ++temp) {
+    RadioInterface &radio = *senders[static_cast<size_t>(temp) % senders.size()];
+    const JoinRequestPacket req = joinRequest(static_cast<DroneIdType>(temp),
+                                              static_cast<uint32_t>(temp));
+    for (int attempt = 0; attempt < 5; ++attempt) {
+      radio.send(&req, sizeof(req));
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+      std::optional<JoinResponsePacket> resp;
+      while (!resp && std::chrono::steady_clock::now() < deadline) {
+        RadioFrame frame;
+        if (!radio.receive(frame)) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+          continue;
+        }
+        const auto *p = frame.as<JoinResponsePacket>();
+        if (p && p->nonce == req.nonce && p->temp_id == req.temp_id)
+          resp = *p;
+      }
+      if (resp) {
+        size_t module = 0;
+        for (size_t r = 0; r < modules.size(); ++r)
+          if (modules[r]->channel() == resp->assigned_channel)
+            module = r;
+        by_module[module].push_back(resp->assigned_id);
+        break;
+      }
+    }
+  }
+  std::vector<std::vector<DroneIdType>> ids(senders.size());
+  for (size_t r = 0; r < by_module.size(); ++r)
+    for (size_t i = 0; i < by_module[r].size(); ++i)
+      ids[r * per_module + i % per_module].push_back(by_module[r][i]);
+  // Göndericiler artık yalnızca yollar: teslim edilen her çerçeve GBS'nin
+  for (size_t k = 0; k < senders.size(); ++k) {
+    senders[k]->closeListeningPipe(1);
+    senders[k]->setChannel(modules[k / per_module]->channel());
+  }
+  medium.resetStats();
+
+  std::atomic<uint64_t> sent{0};
+  std::vector<std::thread> threads;
+  const auto end = std::chrono::steady_clock::now() +
+                   std::chrono::seconds(opt.seconds);
+  for (size_t k = 0; k < senders.size(); ++k) {
+    threads.emplace_back([&, k] {
+      RadioInterface &radio = *senders[k];
+      for (uint32_t n = 0; std::chrono::steady_clock::now() < end; ++n) {
+        if (ids[k].empty())
+          return;
+        const TelemetryPacket tlm = telemetry(ids[k][n % ids[k].size()], n);
+        if (radio.send(&tlm, sizeof(tlm)))
+          sent++;
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  // Kuyrukta kalanlar işlensin
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  stop = true;
+  gbs_thread.join();
+  bank.stop();
+  modules[0]->stopRxThread();
+
+  const SimMediumStats m = medium.stats();
+  const SwarmTable &t = gbs.table();
+  uint64_t samples = 0;
+  for (size_t id = 1; id <= GBS_MAX_DRONES; ++id)
+    samples += t.samples[id];
+  uint64_t stalls = 0;
+  for (const auto &module : modules)
+    stalls += module->rxRingStalls();
+  const double secs = opt.seconds;
+  std::printf("\nSimulated 2 Mbps: %d module(s), %zu sender(s), %zu drones "
+              "joined over the air\n",
+              radios, senders.size(), t.activeCount());
+  for (size_t r = 0; r < modules.size(); ++r)
+    std::printf("  module %zu     : channel %u, %zu drones, leader %d\n", r,
+                modules[r]->channel(), by_module[r].size(),
+                gbs.leader(r) ? *gbs.leader(r) : -1);
+  std::printf("Telemetry ACKed : %llu (%.0f frames/s)\n",
+              static_cast<unsigned long long>(sent.load()),
+              static_cast<double>(sent.load()) / secs);
+  std::printf("Delivered       : %llu, collisions %llu, RX overflows %llu, "
+              "RX ring stalls %llu\n",
+              static_cast<unsigned long long>(m.delivered),
+              static_cast<unsigned long long>(m.collisions),
+              static_cast<unsigned long long>(m.rx_overflows),
+              static_cast<unsigned long long>(stalls));
+  if (radios > 1)
+    std::printf("Bank            : %llu delivered, %llu duplicates, %llu late\n",
+                static_cast<unsigned long long>(bank.stats().delivered),
+                static_cast<unsigned long long>(bank.stats().duplicates),
+                static_cast<unsigned long long>(bank.stats().late));
+  std::printf("GBS samples     : %llu stored in the table\n",
+              static_cast<unsigned long long>(samples));
+  const bool kept_up = m.rx_overflows == 0 && samples >= sent.load();
+  std::printf("Kept up         : %s\n", kept_up ? "yes" : "NO");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  replayIngest(opt);
+  concurrentJoin();
+  simIngest(opt, 1);
+  if (opt.radios > 1) {
+    bankMerge(opt);
+    simIngest(opt, opt.radios);
+  }
+  return 0;
+}
@@ -0,0 +1,193 @@
+// Aggregate telemetry rate and TDMA slot utilisation versus swarm size on
+// the simulated RF medium. For every swarm size the leader/follower loops of
+// src/swarm.cpp run for a few seconds while a ground station counts the
+// telemetry samples relayed by the leader and the uplink frames carrying
+// them. Superframes and slots are counted by the leader as it sends its
+// beacons, so a beacon the ground station misses does not inflate the
+// slot fill.
+//
+//   ./bench/tdma_bench [--sizes 2,4,8,16] [--seconds S] [--loss P]
+#include "drone.hpp"
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include "swarm.hpp"
+#include "tdma.hpp"
+#include "timebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  std::vector<int> sizes{2, 4, 8, 12, 16, 19, 24, 32};
+  int seconds = 3;
+  double loss = 0.0;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+    if (key == "--sizes") {
+      opt.sizes.clear();
+      std::stringstream ss(value);
+      for (std::string item; std::getline(ss, item, ',');)
+        opt.sizes.push_back(std::max(2, std::atoi(item.c_str())));
+    } else if (key == "--seconds") {
+      opt.seconds = std::max(1, std::atoi(value.c_str()));
+    } else if (key == "--loss") {
+      opt.loss = std::atof(value.c_str());
+    }
+  }
+  return opt;
+}
+
+struct Counters {
+  std::atomic<uint64_t> telemetry{0};
+  std::atomic<uint64_t> uplink{0};
+  LeaderLoopStats leader;
+};
+
+struct Result {
+  uint64_t telemetry = 0;
+  uint64_t uplink = 0;
+  uint64_t slots = 0;
+  uint64_t superframes = 0;
+  size_t reporting = 0;
+  SimMediumStats medium;
+};
+
+// Ground station listening to telemetry on BASE_TX.
+void groundStation(RadioInterface &radio, const std::atomic<bool> &stop,
+                   Counters &counters, std::set<DroneIdType> &reporters) {
+  while (!stop.load()) {
+    RadioFrame frame;
+    if (!radio.receive(frame)) {
+      radio.waitForFrame(std::chrono::milliseconds(5));
+      continue;
+    }
+    if (const auto *agg = frame.as<AggregateTelemetryPacket>()) {
+      counters.uplink++;
+      counters.telemetry += agg->count;
+      for (uint8_t i = 0; i < agg->count && i < MAX_AGGREGATE_ENTRIES; ++i)
+        reporters.insert(agg->entries[i].drone_id);
+    } else if (const auto *perm = frame.as<PermissionToSendPacket>()) {
+      if (perm->target_drone_id != 0)
+        continue;
+      CommandPacket cmd{};
+      cmd.timestamp = static_cast<uint32_t>(monotonicMicros());
+      std::strncpy(cmd.command, "no_need", MAX_COMMAND_LENGTH - 1);
+      radio.send(&cmd, sizeof(cmd));
+    }
+  }
+}
+
+Result run(int nodes, const Options &opt) {
+  SimMediumConfig cfg;
+  cfg.loss_probability = opt.loss;
+  SimMedium medium(cfg);
+
+  RadioInterface gbs(std::make_unique<SimTransport>(medium));
+  gbs.begin();
+  gbs.configure(1, RadioDataRate::MEDIUM_RATE);
+  gbs.setAddress(BASE_RX, BASE_TX);
+
+  std::vector<DroneIdType> ids;
+  for (int i = 1; i <= nodes; ++i)
+    ids.push_back(static_cast<DroneIdType>(i));
+
+  std::vector<std::unique_ptr<RadioInterface>> radios;
+  std::vector<std::unique_ptr<Drone>> drones;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    // Drones on a small circle around the ground station.
+    const double angle = 6.283185 * static_cast<double>(i) / nodes;
+    auto radio = std::make_unique<RadioInterface>(std::make_unique<SimTransport>(
+        medium, 10.0 * std::cos(angle), 10.0 * std::sin(angle)));
+    radio->begin();
+    radio->configure(1, RadioDataRate::MEDIUM_RATE);
+    radio->setAddress(BASE_TX, BASE_RX);
+    radio->startRxThread();
+    auto drone = std::make_unique<Drone>(*radio, i == 0);
+    drone->setNetworkId(ids[i]);
+    drone->setCurrentLeaderId(ids.front());
+    radios.push_back(std::move(radio));
+    drones.push_back(std::move(drone));
+  }
+
+  std::atomic<bool> stop{false};
+  Counters counters;
+  std::set<DroneIdType> reporters;
+  std::vector<std::thread> threads;
+  threads.emplace_back(groundStation, std::ref(gbs), std::cref(stop),
+                       std::ref(counters), std::ref(reporters));
+  for (size_t i = 0; i < drones.size(); ++i) {
+    threads.emplace_back([&, i] {
+      std::vector<DroneIdType> swarm(ids.begin() + 1, ids.end());
+      if (i == 0)
+        leaderLoop(*radios[i], *drones[i], swarm, &stop, &counters.leader);
+      else
+        followerLoop(*radios[i], *drones[i], nullptr, &stop);
+    });
+  }
+
+  // Let the first beacons go out before measuring.
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  const uint64_t tlm0 = counters.telemetry;
+  const uint64_t up0 = counters.uplink;
+  const uint64_t slots0 = counters.leader.slots;
+  const uint64_t sf0 = counters.leader.superframes;
+  medium.resetStats();
+  std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+  stop = true;
+  for (auto &t : threads)
+    t.join();
+
+  Result result;
+  result.telemetry = counters.telemetry - tlm0;
+  result.uplink = counters.uplink - up0;
+  result.slots = counters.leader.slots - slots0;
+  result.superframes = counters.leader.superframes - sf0;
+  result.reporting = reporters.size();
+  result.medium = medium.stats();
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  const double secs = static_cast<double>(opt.seconds);
+  const uint32_t exchange_us =
+      tdmaExchangeUs(sizeof(TelemetryPacket), RadioDataRate::MEDIUM_RATE);
+
+  std::printf("TDMA telemetry benchmark: %d s per size, loss %.2f\n",
+              opt.seconds, opt.loss);
+  // Uplink airtime is leader -> GBS; the last column is the airtime one
+  // relayed frame per sample would need.
+  std::printf("%6s %7s %8s %9s %9s %7s %9s %8s %10s\n", "nodes", "sf/s",
+              "tlm/s", "per-drone", "reported", "slot %", "uplink/s",
+              "uplink %", "unpacked %");
+  for (int nodes : opt.sizes) {
+    const Result r = run(nodes, opt);
+    const double fill = r.slots ? 100.0 * r.telemetry / r.slots : 0.0;
+    const double airtime = 100.0 * exchange_us / (secs * 1e6);
+    std::printf("%6d %7.1f %8.1f %9.2f %5zu/%-3d %7.1f %9.1f %8.1f %10.1f\n",
+                nodes, r.superframes / secs, r.telemetry / secs,
+                r.telemetry / secs / (nodes - 1), r.reporting, nodes - 1, fill,
+                r.uplink / secs, airtime * r.uplink, airtime * r.telemetry);
+  }
+  return 0;
+}
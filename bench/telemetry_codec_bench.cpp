@@ -0,0 +1,218 @@
+// Encode/decode throughput and compression ratio of the telemetry codec
+// (include/telemetry_codec.hpp).
+//
+//   ./bench/telemetry_codec_bench [--csv FILE] [--ack-loss P] [--keyframe N]
+//
+// FILE holds t_ms,ax,ay,az,gx,gy,gz lines as written by
+// `./examples/mpu_terminal --csv`. Without it a synthetic 100 Hz hover
+// trace (gravity, motor vibration, slow attitude changes) is used.
+#include "telemetry_codec.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  std::string csv;
+  double ack_loss = 0.0;
+  int keyframe = 64;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--csv")
+      opt.csv = value;
+    else if (key == "--ack-loss")
+      opt.ack_loss = std::atof(value);
+    else if (key == "--keyframe")
+      opt.keyframe = std::clamp(std::atoi(value), 1, 255);
+  }
+  return opt;
+}
+
+// Recorded IMU rows turned into telemetry with slowly changing battery,
+// altitude and link fields.
+std::vector<TelemetryPacket> loadCsv(const std::string &path) {
+  std::vector<TelemetryPacket> samples;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream row(line);
+    long t_ms;
+    int v[6];
+    if (!(row >> t_ms >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5]))
+      continue;
+    TelemetryPacket tlm{};
+    tlm.timestamp = 1700000000u + static_cast<uint32_t>(t_ms / 1000);
+    tlm.acceleration_x = static_cast<int16_t>(v[0]);
+    tlm.acceleration_y = static_cast<int16_t>(v[1]);
+    tlm.acceleration_z = static_cast<int16_t>(v[2]);
+    tlm.gyroscope_x = static_cast<int16_t>(v[3]);
+    tlm.gyroscope_y = static_cast<int16_t>(v[4]);
+    tlm.gyroscope_z = static_cast<int16_t>(v[5]);
+    tlm.battery_voltage = 12.6f - 0.00002f * static_cast<float>(t_ms);
+    tlm.altitude = 10.0f;
+    tlm.link_quality = 100.0f;
+    samples.push_back(tlm);
+  }
+  return samples;
+}
+
+std::vector<TelemetryPacket> synthesise(size_t count) {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<TelemetryPacket> samples;
+  samples.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const double t = static_cast<double>(i) / 100.0;
+    const double roll = 0.15 * std::sin(0.4 * t);
+    const double pitch = 0.10 * std::sin(0.27 * t + 1.0);
+    auto clamp16 = [](double v) {
+      return static_cast<int16_t>(std::clamp(std::lround(v), -32768L, 32767L));
+    };
+    TelemetryPacket tlm{};
+    tlm.timestamp = 1700000000u + static_cast<uint32_t>(t);
+    // +-2 g range: 16384 LSB/g; +-250 dps range: 131 LSB/dps.
+    tlm.acceleration_x = clamp16(16384 * std::sin(pitch) + 40 * noise(rng));
+    tlm.acceleration_y = clamp16(-16384 * std::sin(roll) + 40 * noise(rng));
+    tlm.acceleration_z = clamp16(16384 * std::cos(roll) * std::cos(pitch) +
+                                 60 * noise(rng));
+    tlm.gyroscope_x = clamp16(131 * 57.3 * 0.06 * std::cos(0.4 * t) +
+                              15 * noise(rng));
+    tlm.gyroscope_y = clamp16(131 * 57.3 * 0.027 * std::cos(0.27 * t + 1.0) +
+                              15 * noise(rng));
+    tlm.gyroscope_z = clamp16(-12 + 10 * noise(rng));
+    tlm.battery_voltage = static_cast<float>(12.6 - 0.002 * t);
+    tlm.altitude = static_cast<float>(10.0 + 0.5 * std::sin(0.1 * t));
+    tlm.rpd = 1;
+    tlm.retries = static_cast<uint8_t>(i % 50 == 0 ? 1 : 0);
+    tlm.link_quality = 100.0f;
+    samples.push_back(tlm);
+  }
+  return samples;
+}
+
+std::vector<CompressedTelemetryPacket>
+encodeAll(const std::vector<TelemetryPacket> &samples, const Options &opt,
+          std::mt19937 &rng) {
+  std::bernoulli_distribution lost(opt.ack_loss);
+  std::vector<CompressedTelemetryPacket> frames;
+  frames.reserve(samples.size());
+  TelemetryEncoder encoder(1, static_cast<uint8_t>(opt.keyframe));
+  auto flush = [&] {
+    frames.push_back(encoder.takeFrame());
+    if (!lost(rng))
+      encoder.acknowledge(frames.back());
+  };
+  for (const TelemetryPacket &tlm : samples) {
+    if (!encoder.push(tlm)) {
+      flush();
+      encoder.push(tlm);
+    }
+  }
+  if (!encoder.empty())
+    flush();
+  return frames;
+}
+
+template <typename F> double bestSeconds(int rounds, F &&f) {
+  double best = 1e30;
+  for (int r = 0; r < rounds; ++r) {
+    const auto t0 = std::chrono::steady_clock::now();
+    f();
+    const auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  std::vector<TelemetryPacket> samples =
+      opt.csv.empty() ? synthesise(60000) : loadCsv(opt.csv);
+  if (samples.empty()) {
+    std::fprintf(stderr, "no samples in %s\n", opt.csv.c_str());
+    return 1;
+  }
+
+  std::mt19937 rng(1);
+  std::vector<CompressedTelemetryPacket> frames = encodeAll(samples, opt, rng);
+
+  // Round trip check against the quantised input.
+  TelemetryDecoder decoder;
+  std::vector<TelemetryPacket> decoded(samples.size());
+  size_t out = 0, undecodable = 0, keyframes = 0;
+  for (const auto &frame : frames) {
+    keyframes += (frame.flags & 0x80) ? 1 : 0;
+    const size_t n =
+        decoder.decode(frame, decoded.data() + out, decoded.size() - out);
+    undecodable += n == 0;
+    out += n;
+  }
+  size_t mismatches = 0;
+  double max_alt_err = 0, max_batt_err = 0;
+  for (size_t i = 0; i < out; ++i) {
+    const TelemetryPacket &a = samples[i];
+    const TelemetryPacket &b = decoded[i];
+    if (a.acceleration_x != b.acceleration_x ||
+        a.acceleration_z != b.acceleration_z || a.gyroscope_y != b.gyroscope_y ||
+        a.timestamp != b.timestamp || a.retries != b.retries)
+      mismatches++;
+    max_alt_err =
+        std::max<double>(max_alt_err, std::fabs(a.altitude - b.altitude));
+    max_batt_err = std::max<double>(
+        max_batt_err, std::fabs(a.battery_voltage - b.battery_voltage));
+  }
+
+  const int rounds = 5;
+  const double enc_s = bestSeconds(rounds, [&] {
+    std::mt19937 r(1);
+    frames = encodeAll(samples, opt, r);
+  });
+  size_t sink = 0;
+  const double dec_s = bestSeconds(rounds, [&] {
+    TelemetryDecoder d;
+    size_t o = 0;
+    for (const auto &frame : frames)
+      o += d.decode(frame, decoded.data() + o, decoded.size() - o);
+    sink += o;
+  });
+
+  const double n = static_cast<double>(samples.size());
+  const double wire = static_cast<double>(frames.size()) * 32.0;
+  std::printf("Telemetry codec benchmark\n");
+  std::printf("  input            : %s, %zu samples\n",
+              opt.csv.empty() ? "synthetic 100 Hz hover" : opt.csv.c_str(),
+              samples.size());
+  std::printf("  ack loss         : %.2f, keyframe every %d samples\n",
+              opt.ack_loss, opt.keyframe);
+  std::printf("  frames           : %zu (%zu keyframes, %zu undecodable)\n",
+              frames.size(), keyframes, undecodable);
+  std::printf("  samples / frame  : %.2f\n", n / frames.size());
+  std::printf("  bytes / sample   : %.2f (raw TelemetryPacket: %zu)\n",
+              wire / n, sizeof(TelemetryPacket));
+  std::printf("  compression      : %.2fx\n",
+              n * sizeof(TelemetryPacket) / wire);
+  std::printf("  round trip       : %zu decoded, %zu mismatches, max error "
+              "altitude %.4f m, battery %.4f V\n",
+              out, mismatches, max_alt_err, max_batt_err);
+  std::printf("  encode           : %.1f ns/sample (%.1f Msample/s)\n",
+              enc_s * 1e9 / n, n / enc_s / 1e6);
+  std::printf("  decode           : %.1f ns/sample (%.1f Msample/s)\n",
+              dec_s * 1e9 / n, n / dec_s / 1e6);
+  return sink == 0;
+}
@@ -0,0 +1,200 @@
+// Leader period bursts: blocking send() per frame against post() bursts.
+//
+//   ./bench/tx_burst_bench [--bursts N] [--turnaround US] [--rate 1m|2m]
+//
+// Every burst is what a leader sends after the TDMA slots: four aggregate
+// frames and a PermissionToSend to the ground station and three commands
+// to followers' unicast addresses. A single transceiver pays the RX->TX
+// turnaround (RF24 txDelay, default 250 us) for every blocking send();
+// post() + flushTx() pays it once per burst and writes the frames to one
+// address back to back. The duplex node has no turnaround; the simulator
+// does not model the SPI upload and status polling between two blocking
+// writes that the TX FIFO hides on hardware, so there both should match.
+// Completions are counted in the post() callbacks.
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include "swarm_address.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t CHANNEL = 76;
+constexpr DroneIdType FOLLOWERS[] = {2, 3, 4};
+
+struct Options {
+  int bursts = 400;
+  int turnaround_us = 250;
+  RadioDataRate rate = RadioDataRate::HIGH_RATE;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+    if (key == "--bursts")
+      opt.bursts = std::max(1, std::atoi(value.c_str()));
+    else if (key == "--turnaround")
+      opt.turnaround_us = std::max(0, std::atoi(value.c_str()));
+    else if (key == "--rate")
+      opt.rate = value == "1m" ? RadioDataRate::MEDIUM_RATE
+                               : RadioDataRate::HIGH_RATE;
+  }
+  return opt;
+}
+
+struct Frame {
+  uint64_t address;
+  std::vector<uint8_t> bytes;
+};
+
+template <typename T> Frame frameOf(uint64_t address, const T &packet) {
+  const auto *p = reinterpret_cast<const uint8_t *>(&packet);
+  return {address, std::vector<uint8_t>(p, p + sizeof(T))};
+}
+
+std::vector<Frame> leaderBurst() {
+  std::vector<Frame> burst;
+  for (uint8_t seq = 0; seq < 4; ++seq) {
+    AggregateTelemetryPacket agg{};
+    agg.leader_id = 1;
+    agg.sequence = seq;
+    agg.count = 3;
+    burst.push_back(frameOf(BASE_TX, agg));
+  }
+  for (DroneIdType id : FOLLOWERS) {
+    CommandPacket cmd{};
+    cmd.target_drone_id = id;
+    std::snprintf(cmd.command, sizeof(cmd.command), "hover");
+    burst.push_back(frameOf(swarmAddress(unicastAddressByte(id)), cmd));
+  }
+  PermissionToSendPacket perm{};
+  burst.push_back(frameOf(BASE_TX, perm));
+  return burst;
+}
+
+enum class Mode { BLOCKING, BURST, TX_THREAD };
+
+struct Result {
+  double us_per_burst = 0.0;
+  uint64_t acked = 0;
+  uint64_t failed = 0;
+};
+
+Result run(bool duplex, Mode mode, const Options &opt) {
+  SimMediumConfig cfg;
+  cfg.turnaround = std::chrono::microseconds(opt.turnaround_us);
+  SimMedium medium(cfg);
+
+  // Alıcılar: GBS ve üç takipçi, her biri kendi RX thread'iyle
+  std::vector<std::unique_ptr<RadioInterface>> receivers;
+  auto addReceiver = [&](uint64_t address, double x) {
+    receivers.push_back(std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, x, 0.0)));
+    RadioInterface &r = *receivers.back();
+    r.begin();
+    r.configure(CHANNEL, opt.rate);
+    r.setAddress(BASE_RX, address);
+    r.startRxThread();
+  };
+  addReceiver(BASE_TX, 20.0);
+  for (DroneIdType id : FOLLOWERS)
+    addReceiver(swarmAddress(unicastAddressByte(id)), 5.0 * id);
+
+  std::unique_ptr<RadioInterface> leader =
+      duplex ? std::make_unique<RadioInterface>(
+                   std::make_unique<SimTransport>(medium, 0.0, 0.0),
+                   std::make_unique<SimTransport>(medium, 0.0, 0.0))
+             : std::make_unique<RadioInterface>(
+                   std::make_unique<SimTransport>(medium, 0.0, 0.0));
+  leader->begin();
+  leader->configure(CHANNEL, opt.rate);
+  leader->setAddress(BASE_TX, BASE_RX);
+  if (mode == Mode::TX_THREAD)
+    leader->startTxThread();
+
+  std::atomic<bool> draining{true};
+  std::thread drain([&] {
+    while (draining.load()) {
+      RadioFrame frame;
+      bool any = false;
+      for (auto &r : receivers)
+        while (r->receive(frame))
+          any = true;
+      if (!any)
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  });
+
+  const std::vector<Frame> burst = leaderBurst();
+  Result result;
+  auto done = [&result](const TxCompletion &c) {
+    (c.success ? result.acked : result.failed)++;
+  };
+  const auto start = std::chrono::steady_clock::now();
+  for (int b = 0; b < opt.bursts; ++b) {
+    for (const Frame &f : burst) {
+      if (mode == Mode::BLOCKING) {
+        const bool ok =
+            leader->sendTo(f.address, f.bytes.data(), f.bytes.size());
+        (ok ? result.acked : result.failed)++;
+      } else {
+        leader->postTo(f.address, f.bytes.data(), f.bytes.size(), false,
+                       done);
+      }
+    }
+    if (mode != Mode::BLOCKING)
+      leader->flushTx();
+  }
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  result.us_per_burst = secs * 1e6 / opt.bursts;
+
+  leader->stopTxThread();
+  draining = false;
+  drain.join();
+  return result;
+}
+
+void report(const char *label, const Result &r, double baseline,
+            size_t frames) {
+  std::printf("%-28s %7.0f us/burst %6.0f frames/s  acked %llu, failed %llu",
+              label, r.us_per_burst, frames * 1e6 / r.us_per_burst,
+              static_cast<unsigned long long>(r.acked),
+              static_cast<unsigned long long>(r.failed));
+  if (baseline > 0)
+    std::printf("  x%.2f", baseline / r.us_per_burst);
+  std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  const size_t frames = leaderBurst().size();
+  std::printf("%zu frames per burst, %d bursts, turnaround %d us\n\n", frames,
+              opt.bursts, opt.turnaround_us);
+
+  const Result single = run(false, Mode::BLOCKING, opt);
+  report("Single, blocking send()", single, 0, frames);
+  report("Single, post() + flushTx()", run(false, Mode::BURST, opt),
+         single.us_per_burst, frames);
+  report("Single, TX thread", run(false, Mode::TX_THREAD, opt),
+         single.us_per_burst, frames);
+
+  const Result duplex = run(true, Mode::BLOCKING, opt);
+  report("Duplex, blocking send()", duplex, 0, frames);
+  report("Duplex, post() + flushTx()", run(true, Mode::BURST, opt),
+         duplex.us_per_burst, frames);
+  return 0;
+}
@@ -0,0 +1,138 @@
+// Reads the metrics segment of a running drone (see include/metrics.hpp)
+// and prints counters, per packet type rates and latency percentiles. The
+// drone is not paused; start it with --metrics first.
+//
+//   ./examples/drone_metrics [--name /rf24drone-metrics] [--interval MS]
+//                            [--once 1]
+//
+// Rates are per second over the last interval; percentiles cover the
+// whole run and are bucket lower edges, i.e. within 12.5% below the value.
+#include "metrics.hpp"
+#include "packet_traits.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Options {
+  std::string name = METRICS_DEFAULT_NAME;
+  int interval_ms = 1000;
+  bool once = false;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--name")
+      opt.name = value;
+    else if (key == "--interval")
+      opt.interval_ms = std::max(50, std::atoi(value));
+    else if (key == "--once")
+      opt.once = std::atoi(value) != 0;
+  }
+  return opt;
+}
+
+// Nanoseconds as us with one decimal; batch sizes are printed as is.
+std::string formatValue(MetricHistogram h, uint64_t v) {
+  char buf[32];
+  if (h == MetricHistogram::POLL_BATCH || h == MetricHistogram::RX_THREAD_BATCH)
+    std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v));
+  else
+    std::snprintf(buf, sizeof(buf), "%.1fus", v / 1000.0);
+  return buf;
+}
+
+void print(const MetricsSnapshot &now, const MetricsSnapshot &prev,
+           double seconds) {
+  auto rate = [&](uint64_t cur, uint64_t old) {
+    return seconds > 0 ? (cur - std::min(cur, old)) / seconds : 0.0;
+  };
+
+  std::printf("pid %d, %u recording threads\n", now.pid, now.threads);
+  for (size_t i = 0; i < METRIC_COUNTERS; i++)
+    std::printf("  %-20s %12llu  %10.1f/s\n",
+                metricCounterName(static_cast<MetricCounter>(i)),
+                static_cast<unsigned long long>(now.counters[i]),
+                rate(now.counters[i], prev.counters[i]));
+
+  std::printf("  %-22s %8s %10s\n", "packet", "rx/s", "tx/s");
+  for (size_t t = 0; t < METRICS_PACKET_TYPES; t++) {
+    if (!now.rx_packets[t] && !now.tx_packets[t])
+      continue;
+    std::printf("  %-22s %8.1f %10.1f\n",
+                packetTypeName(static_cast<PacketType>(t)),
+                rate(now.rx_packets[t], prev.rx_packets[t]),
+                rate(now.tx_packets[t], prev.tx_packets[t]));
+  }
+
+  std::printf("  %-20s %10s %10s %10s %10s %10s %10s\n", "histogram", "count",
+              "mean", "p50", "p90", "p99", "max");
+  for (size_t i = 0; i < METRIC_HISTOGRAMS; i++) {
+    const auto h = static_cast<MetricHistogram>(i);
+    const HistogramSnapshot &s = now.histograms[i];
+    if (!s.count)
+      continue;
+    std::printf("  %-20s %10llu %10s %10s %10s %10s %10s\n",
+                metricHistogramName(h),
+                static_cast<unsigned long long>(s.count),
+                formatValue(h, static_cast<uint64_t>(s.mean())).c_str(),
+                formatValue(h, s.percentile(0.5)).c_str(),
+                formatValue(h, s.percentile(0.9)).c_str(),
+                formatValue(h, s.percentile(0.99)).c_str(),
+                formatValue(h, s.max).c_str());
+  }
+  std::printf("\n");
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+
+  MetricsReader reader;
+  if (!reader.open(opt.name)) {
+    std::cerr << "No metrics segment " << opt.name
+              << " (start the drone with --metrics)\n";
+    return 1;
+  }
+
+  MetricsSnapshot prev;
+  auto prev_time = std::chrono::steady_clock::now();
+  bool first = true;
+  while (true) {
+    MetricsSnapshot now;
+    if (!reader.read(now)) {
+      std::cerr << "Metrics segment " << opt.name << " is not readable\n";
+      return 1;
+    }
+    if (now.pid != prev.pid)
+      first = true; // a restarted drone replaces the segment
+    const auto t = std::chrono::steady_clock::now();
+    const double seconds =
+        first ? 0.0 : std::chrono::duration<double>(t - prev_time).count();
+    // --once still waits an interval so that the rates are filled in
+    if (!opt.once || !first) {
+      print(now, prev, seconds);
+      if (opt.once)
+        return 0;
+    }
+    prev = now;
+    prev_time = t;
+    first = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(opt.interval_ms));
+    // Mapped segments outlive an exiting drone, so look the name up again
+    if (!reader.open(opt.name)) {
+      std::cerr << "Metrics segment " << opt.name << " is gone\n";
+      return 0;
+    }
+  }
+}
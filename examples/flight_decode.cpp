@@ -0,0 +1,281 @@
+// Decodes a flight recorder file (see include/flight_recorder.hpp) with the
+// packet structs of include/packets.hpp, and optionally exports it as pcap.
+//
+//   ./examples/flight_decode FILE [--pcap out.pcap] [--tail N] [--hex 1]
+//
+// The pcap uses LINKTYPE_USER0 (147). Each packet starts with a 16-byte
+// pseudo header, then the raw nRF24 payload:
+//
+//   0 version (1)   1 direction (0 rx, 1 tx, 2 ack payload)   2 pipe
+//   3 channel       4 data rate (0 250k, 1 1M, 2 2M)           5 ARC
+//   6 flags (1 acked, 2 rpd, 4 multicast)   7 payload length
+//   8 destination address of a TX, little endian (8 bytes)
+//
+// In Wireshark map DLT_USER0 to a dissector via Preferences > Protocols >
+// DLT_USER, or just read the payload bytes.
+#include "flight_recorder.hpp"
+#include "packet_traits.hpp"
+#include "packets.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct Options {
+  std::string file;
+  std::string pcap;
+  size_t tail = 0; // 0: all records
+  bool hex = false;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  int i = 1;
+  if (i < argc && argv[i][0] != '-')
+    opt.file = argv[i++];
+  for (; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--pcap")
+      opt.pcap = value;
+    else if (key == "--tail")
+      opt.tail = static_cast<size_t>(std::max(0, std::atoi(value)));
+    else if (key == "--hex")
+      opt.hex = std::atoi(value) != 0;
+  }
+  return opt;
+}
+
+const char *rateName(RadioDataRate rate) {
+  switch (rate) {
+  case RadioDataRate::LOW_RATE:
+    return "250k";
+  case RadioDataRate::MEDIUM_RATE:
+    return "1M";
+  case RadioDataRate::HIGH_RATE:
+    return "2M";
+  }
+  return "?";
+}
+
+const char *directionName(FlightDirection d) {
+  switch (d) {
+  case FlightDirection::RX:
+    return "RX ";
+  case FlightDirection::TX:
+    return "TX ";
+  case FlightDirection::ACK_PAYLOAD:
+    return "ACK";
+  }
+  return "?  ";
+}
+
+std::string text(const char *s, size_t max) {
+  return std::string(s, strnlen(s, max));
+}
+
+// One line per packet, field names as in packets.hpp.
+struct Printer {
+  void operator()(const CommandPacket &p) {
+    std::printf("COMMAND target=%u ts=%u \"%s\"", p.target_drone_id,
+                p.timestamp, text(p.command, MAX_COMMAND_LENGTH).c_str());
+  }
+  void operator()(const TelemetryPacket &p) {
+    std::printf("TELEMETRY id=%u ts=%u acc=%d,%d,%d gyro=%d,%d,%d "
+                "bat=%.2f alt=%.1f rpd=%u retries=%u link=%.0f%%",
+                p.drone_id, p.timestamp, p.acceleration_x, p.acceleration_y,
+                p.acceleration_z, p.gyroscope_x, p.gyroscope_y,
+                p.gyroscope_z, static_cast<double>(p.battery_voltage),
+                static_cast<double>(p.altitude), p.rpd, p.retries,
+                static_cast<double>(p.link_quality));
+  }
+  void operator()(const JoinRequestPacket &p) {
+    std::printf("JOIN_REQUEST temp=%u nonce=%08X ts=%u name=\"%s\"",
+                p.temp_id, p.nonce, p.timestamp,
+                text(p.requested_name, MAX_NODE_NAME_LENGTH).c_str());
+  }
+  void operator()(const JoinResponsePacket &p) {
+    std::printf("JOIN_RESPONSE id=%u leader=%u channel=%u unicast=0x%02X "
+                "group=0x%02X ts=%u for temp=%u nonce=%08X",
+                p.assigned_id, p.current_leader_id, p.assigned_channel,
+                p.unicast_address, p.group_address, p.timestamp, p.temp_id,
+                p.nonce);
+  }
+  void operator()(const HeartbeatPacket &p) {
+    std::printf("HEARTBEAT src=%u ts=%u", p.source_drone_id, p.timestamp);
+  }
+  void operator()(const LeaderAnnouncementPacket &p) {
+    std::printf("LEADER_ANNOUNCEMENT leader=%u ts=%u", p.new_leader_id,
+                p.timestamp);
+  }
+  void operator()(const PermissionToSendPacket &p) {
+    std::printf("PERMISSION_TO_SEND target=%u ts=%u", p.target_drone_id,
+                p.timestamp);
+  }
+  void operator()(const LeaderRequestPacket &p) {
+    std::printf("LEADER_REQUEST id=%u ts=%u", p.drone_id, p.timestamp);
+  }
+  void operator()(const BeaconPacket &p) {
+    std::printf("BEACON leader=%u sf=%u ts=%u offset=%uus slot=%uus slots=",
+                p.leader_id, p.superframe, p.timestamp, p.slot_offset_us,
+                p.slot_us);
+    const size_t n = std::min<size_t>(p.slot_count, MAX_TDMA_SLOTS);
+    for (size_t i = 0; i < n; i++)
+      std::printf(i ? ",%u" : "%u", p.slots[i]);
+  }
+  void operator()(const AggregateTelemetryPacket &p) {
+    std::printf("AGGREGATE leader=%u seq=%u ids=", p.leader_id, p.sequence);
+    const size_t n = std::min<size_t>(p.count, MAX_AGGREGATE_ENTRIES);
+    for (size_t i = 0; i < n; i++)
+      std::printf(i ? ",%u" : "%u", p.entries[i].drone_id);
+  }
+  void operator()(const CompressedTelemetryPacket &p) {
+    std::printf("COMPRESSED id=%u seq=%u ref=%u samples=%u%s", p.drone_id,
+                p.sequence, p.reference, p.flags & 0x7F,
+                p.flags & 0x80 ? " keyframe" : "");
+  }
+  void operator()(const TimeSyncRequestPacket &p) {
+    std::printf("TIME_SYNC_REQUEST id=%u t1=%llu", p.drone_id,
+                static_cast<unsigned long long>(p.originate_us));
+  }
+  void operator()(const TimeSyncResponsePacket &p) {
+    std::printf("TIME_SYNC_RESPONSE target=%u t1=%llu t2=%llu t3=%llu",
+                p.target_drone_id,
+                static_cast<unsigned long long>(p.originate_us),
+                static_cast<unsigned long long>(p.receive_us),
+                static_cast<unsigned long long>(p.transmit_us));
+  }
+  void operator()(const LinkControlPacket &p) {
+    std::printf("LINK_CONTROL target=%u ts=%u rate=%s pa=%u retries=%u/%u",
+                p.target_drone_id, p.timestamp,
+                rateName(static_cast<RadioDataRate>(p.data_rate)),
+                p.power_level, p.retries >> 4, p.retries & 0x0F);
+  }
+  void operator()(const FragmentPacket &p) {
+    std::printf("FRAGMENT src=%u msg=%u %u/%u len=%u%s", p.source_id,
+                p.message_id, p.index, p.count,
+                p.length & ~FRAGMENT_ACK_REQUEST,
+                p.length & FRAGMENT_ACK_REQUEST ? " ack?" : "");
+  }
+  void operator()(const FragmentAckPacket &p) {
+    std::printf("FRAGMENT_ACK src=%u target=%u msg=%u base=%u sack=",
+                p.source_id, p.target_id, p.message_id, p.base);
+    for (uint8_t byte : p.received)
+      std::printf("%02X", byte);
+  }
+};
+
+void printHex(const uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    std::printf(i ? " %02X" : "%02X", data[i]);
+}
+
+void printEntry(const FlightLog &log, const FlightEntry &e, bool hex) {
+  const double t = static_cast<int64_t>(e.time_us - log.start_monotonic_us) /
+                   1e6;
+  std::printf("%12.6f %s ch%-3u %-4s p%u", t, directionName(e.direction),
+              e.channel, rateName(e.data_rate), e.pipe);
+  if (e.direction == FlightDirection::TX)
+    std::printf(" arc=%-2s %s",
+                e.arc == TX_ARC_UNKNOWN ? "?"
+                                        : std::to_string(e.arc).c_str(),
+                e.flags & FLIGHT_MULTICAST ? "mcast"
+                : e.flags & FLIGHT_ACKED   ? "ack  "
+                                           : "LOST ");
+  else
+    std::printf(" %s", e.flags & FLIGHT_RPD ? "rpd" : "   ");
+  std::printf("  ");
+  Printer printer;
+  if (!dispatchPacket(printer, e.data, e.size)) {
+    std::printf("? type=%u len=%u ", e.size ? e.data[0] : 0, e.size);
+    printHex(e.data, e.size);
+  } else if (hex) {
+    std::printf("  [");
+    printHex(e.data, e.size);
+    std::printf("]");
+  }
+  std::printf("\n");
+}
+
+template <typename T> void put(std::ofstream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool writePcap(const std::string &path, const FlightLog &log) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    return false;
+  constexpr uint32_t LINKTYPE_USER0 = 147;
+  put<uint32_t>(out, 0xA1B2C3D4); // microsecond timestamps, host order
+  put<uint16_t>(out, 2);
+  put<uint16_t>(out, 4);
+  put<int32_t>(out, 0);
+  put<uint32_t>(out, 0);
+  put<uint32_t>(out, 65535);
+  put<uint32_t>(out, LINKTYPE_USER0);
+
+  for (const FlightEntry &e : log.entries) {
+    const uint64_t unix_us = log.unixMicros(e);
+    uint8_t pseudo[16] = {1,
+                          static_cast<uint8_t>(e.direction),
+                          e.pipe,
+                          e.channel,
+                          static_cast<uint8_t>(e.data_rate),
+                          e.arc,
+                          e.flags,
+                          e.size};
+    for (size_t i = 0; i < 8; i++)
+      pseudo[8 + i] = static_cast<uint8_t>(e.address >> (8 * i));
+    const uint32_t len = sizeof(pseudo) + e.size;
+    put<uint32_t>(out, static_cast<uint32_t>(unix_us / 1000000));
+    put<uint32_t>(out, static_cast<uint32_t>(unix_us % 1000000));
+    put<uint32_t>(out, len);
+    put<uint32_t>(out, len);
+    out.write(reinterpret_cast<const char *>(pseudo), sizeof(pseudo));
+    out.write(reinterpret_cast<const char *>(e.data), e.size);
+  }
+  return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  if (opt.file.empty()) {
+    std::cerr << "usage: flight_decode FILE [--pcap out.pcap] [--tail N] "
+                 "[--hex 1]\n";
+    return 2;
+  }
+
+  FlightLog log;
+  if (!readFlightLog(opt.file, log)) {
+    std::cerr << opt.file << " is not a flight recorder file\n";
+    return 1;
+  }
+
+  std::printf("# pid %d, %llu frames written, %zu kept (ring of %u), "
+              "%llu torn\n",
+              log.pid, static_cast<unsigned long long>(log.written),
+              log.entries.size(), log.capacity,
+              static_cast<unsigned long long>(log.torn));
+  const size_t first = opt.tail && opt.tail < log.entries.size()
+                           ? log.entries.size() - opt.tail
+                           : 0;
+  for (size_t i = first; i < log.entries.size(); i++)
+    printEntry(log, log.entries[i], opt.hex);
+
+  if (!opt.pcap.empty()) {
+    if (!writePcap(opt.pcap, log)) {
+      std::cerr << "Could not write " << opt.pcap << "\n";
+      return 1;
+    }
+    std::cerr << "Wrote " << log.entries.size() << " frames to " << opt.pcap
+              << "\n";
+  }
+  return 0;
+}
@@ -1,27 +1,83 @@
+// Reads MPU6050 data and prints it to the terminal.
+//
+//   ./examples/mpu_terminal               human readable, 2 Hz
+//   ./examples/mpu_terminal --csv [HZ]    t_ms,ax,ay,az,gx,gy,gz lines for
+//                                         recording (default 100 Hz, up to
+//                                         1000 Hz through the sensor FIFO)
 #include "mpu6050.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <string>
 #include <thread>
 
-int main() {
+static void printCsv(double t_ms, const ImuSample &s) {
+    std::cout << static_cast<long long>(t_ms) << ',' << s.accel[0] << ','
+              << s.accel[1] << ',' << s.accel[2] << ',' << s.gyro[0] << ','
+              << s.gyro[1] << ',' << s.gyro[2] << '\n';
+}
+
+int main(int argc, char **argv) {
+    const bool csv = argc > 1 && std::string(argv[1]) == "--csv";
+    const int hz = csv && argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
     Mpu6050 sensor;
     if (!sensor.init()) {
         std::cerr << "Failed to initialize MPU6050" << std::endl;
         return 1;
     }
 
-    std::cout << "MPU6050 initialized. Reading data..." << std::endl;
+    // The sensor paces the samples itself; drain its FIFO every 20 ms and
+    // timestamp each sample from its index.
+    if (csv && hz <= MPU6050_MAX_RATE_HZ &&
+        sensor.enableFifo(static_cast<uint16_t>(hz))) {
+        const double period_ms = 1000.0 / sensor.sampleRateHz();
+        ImuSample batch[MPU6050_FIFO_BYTES / MPU6050_SAMPLE_BYTES];
+        uint64_t index = 0;
+        uint32_t overflows = 0;
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const int n = sensor.readFifo(batch, std::size(batch));
+            if (n < 0) {
+                std::cerr << "Sensor read error" << std::endl;
+                continue;
+            }
+            if (sensor.fifoOverflows() != overflows) {
+                overflows = sensor.fifoOverflows();
+                std::cerr << "FIFO overflow, samples dropped" << std::endl;
+            }
+            for (int i = 0; i < n; ++i)
+                printCsv(period_ms * static_cast<double>(index++), batch[i]);
+            std::cout.flush();
+        }
+    }
+
+    if (!csv)
+        std::cout << "MPU6050 initialized. Reading data..." << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    const auto period = csv ? std::chrono::microseconds(1000000 / hz)
+                            : std::chrono::microseconds(500000);
+    auto next = start;
     while (true) {
-        int16_t ax, ay, az;
-        int16_t gx, gy, gz;
-        if (sensor.readAcceleration(ax, ay, az) && sensor.readGyro(gx, gy, gz)) {
-            std::cout << "AX: " << ax << " AY: " << ay << " AZ: " << az
-                      << " | GX: " << gx << " GY: " << gy << " GZ: " << gz
-                      << std::endl;
+        ImuSample s;
+        if (sensor.readSample(s)) {
+            if (csv) {
+                const auto t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                printCsv(static_cast<double>(t.count()), s);
+            } else {
+                std::cout << "AX: " << s.accel[0] << " AY: " << s.accel[1]
+                          << " AZ: " << s.accel[2] << " | GX: " << s.gyro[0]
+                          << " GY: " << s.gyro[1] << " GZ: " << s.gyro[2]
+                          << std::endl;
+            }
         } else {
             std::cerr << "Sensor read error" << std::endl;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        next += period;
+        std::this_thread::sleep_until(next);
     }
 
     return 0;
@@ -0,0 +1,434 @@
+// Runs the leader/follower loops of src/swarm.cpp for a virtual swarm on
+// the in-process simulated RF medium and reports what reached the ground
+// station. No radio hardware is needed.
+//
+//   ./examples/swarm_sim [--nodes N] [--seconds S] [--loss P]
+//                        [--latency US] [--radius M] [--rx-thread 0|1]
+//                        [--ack-payload 0|1] [--unicast 0|1]
+//                        [--swarms K] [--wifi 1,6,11] [--wifi-duty D]
+//                        [--scan 0|1] [--adapt 0|1] [--metrics 0|1]
+//                        [--record FILE]
+//
+// With --ack-payload 1 downlink commands ride on ACK payloads: the ground
+// station preloads its answer to the leader's PermissionToSend, and the
+// leader relays follower commands on the ACK of the target's telemetry.
+// With --unicast 1 (default) every drone opens its unicast and group pipes
+// and replies go to the addressee's pipe, so the other radios drop them.
+// --swarms runs K independent swarms side by side and --wifi adds busy
+// Wi-Fi channels. With --scan 1 (default) each ground station surveys the
+// band with RPD sweeps before its swarm starts and assigns a quiet channel
+// through the JoinResponse; with --scan 0 everybody stays on JOIN_CHANNEL.
+// --adapt 1 turns on link adaptation: the leader moves each follower's
+// uplink between 250 kbps and 2 Mbps and lowers its PA level when the link
+// is strong. Spread the swarm out (e.g. --radius 80) to see rates diverge.
+// --metrics 1 records the hot path metrics of all simulated drones into
+// the shared segment (examples/drone_metrics can watch it) and prints the
+// latency percentiles at the end. --record writes the first leader's
+// radio traffic to a flight recorder file (read it with flight_decode).
+#include "drone.hpp"
+#include "metrics.hpp"
+#include "packets.hpp"
+#include "radio.hpp"
+#include "sim_radio.hpp"
+#include "swarm.hpp"
+#include "swarm_clock.hpp"
+#include "timebase.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  int nodes = 12;
+  int seconds = 10;
+  double loss = 0.0;
+  int latency_us = 0;
+  double radius = 20.0;
+  bool rx_thread = false;
+  bool ack_payload = false;
+  bool unicast = true;
+  int swarms = 1;
+  std::vector<int> wifi;
+  double wifi_duty = 0.3;
+  bool scan = true;
+  bool adapt = false;
+  bool metrics = false;
+  std::string record;
+};
+
+Options parseArgs(int argc, char **argv) {
+  Options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const char *value = argv[i + 1];
+    if (key == "--nodes")
+      opt.nodes = std::max(1, std::atoi(value));
+    else if (key == "--seconds")
+      opt.seconds = std::max(1, std::atoi(value));
+    else if (key == "--loss")
+      opt.loss = std::atof(value);
+    else if (key == "--latency")
+      opt.latency_us = std::atoi(value);
+    else if (key == "--radius")
+      opt.radius = std::atof(value);
+    else if (key == "--rx-thread")
+      opt.rx_thread = std::atoi(value) != 0;
+    else if (key == "--ack-payload")
+      opt.ack_payload = std::atoi(value) != 0;
+    else if (key == "--unicast")
+      opt.unicast = std::atoi(value) != 0;
+    else if (key == "--swarms")
+      opt.swarms = std::max(1, std::atoi(value));
+    else if (key == "--wifi-duty")
+      opt.wifi_duty = std::atof(value);
+    else if (key == "--scan")
+      opt.scan = std::atoi(value) != 0;
+    else if (key == "--adapt")
+      opt.adapt = std::atoi(value) != 0;
+    else if (key == "--metrics")
+      opt.metrics = std::atoi(value) != 0;
+    else if (key == "--record")
+      opt.record = value;
+    else if (key == "--wifi") {
+      std::stringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ','))
+        opt.wifi.push_back(std::atoi(item.c_str()));
+    }
+  }
+  return opt;
+}
+
+struct GroundStats {
+  std::array<std::atomic<uint64_t>, 256> counts{};
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint64_t> command_frames{0}; // sent as their own frames
+};
+
+CommandPacket makeCommand(const SwarmClock &clock, DroneIdType target,
+                          const char *text) {
+  CommandPacket cmd{};
+  cmd.target_drone_id = target;
+  cmd.timestamp = clock.now32();
+  std::strncpy(cmd.command, text, MAX_COMMAND_LENGTH - 1);
+  return cmd;
+}
+
+// Minimal ground station: counts what it hears, including the follower
+// samples inside aggregated uplink frames, serves as the swarm time
+// reference and answers the leader's PermissionToSend with a "no_need"
+// command. Once a second it also addresses a "status" command to the next
+// follower. With ACK payloads both are preloaded on the leader's pipe
+// instead of being sent; any ACKed leader frame takes them along.
+void groundStation(RadioInterface &radio, const std::atomic<bool> &stop,
+                   const std::vector<DroneIdType> &followers,
+                   DroneIdType leader, const Options &opt,
+                   GroundStats &stats) {
+  const bool ack_payload = opt.ack_payload;
+  auto addressOf = [&](DroneIdType id) {
+    return opt.unicast ? swarmAddress(unicastAddressByte(id)) : BASE_RX;
+  };
+  SwarmClock clock;
+  auto next_status = std::chrono::steady_clock::now();
+  size_t next_follower = 0;
+  std::optional<CommandPacket> status;
+  bool status_armed = false;
+
+  auto arm = [&] {
+    radio.flushAckPayloads();
+    if (status)
+      radio.queueAckPayload(1, &*status, sizeof(*status));
+    const CommandPacket idle = makeCommand(clock, 0, "no_need");
+    radio.queueAckPayload(1, &idle, sizeof(idle));
+    status_armed = status.has_value();
+  };
+  if (ack_payload)
+    arm();
+
+  while (!stop.load()) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!status && !followers.empty() && now >= next_status) {
+      status = makeCommand(clock, followers[next_follower++ % followers.size()],
+                           "status");
+      next_status = now + std::chrono::seconds(1);
+      if (ack_payload)
+        arm();
+    }
+
+    RadioFrame frame;
+    if (!radio.receive(frame)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    stats.counts[frame.data[0]]++;
+    if (ack_payload && frame.pipe == 1) {
+      // The ACK of this frame took the head of the payload queue along
+      if (status_armed)
+        status.reset();
+      arm();
+    }
+    if (const auto *agg = frame.as<AggregateTelemetryPacket>()) {
+      stats.samples += agg->count;
+      leader = agg->leader_id;
+    }
+    if (const auto *req = frame.as<TimeSyncRequestPacket>()) {
+      TimeSyncResponsePacket resp{};
+      resp.target_drone_id = req->drone_id;
+      resp.originate_us = req->originate_us;
+      resp.receive_us = clock.toSwarm(frame.rx_time_us);
+      resp.transmit_us =
+            clock.now() + frameTxLeadUs(sizeof(resp), radio.dataRate());
+      radio.sendTo(addressOf(req->drone_id), &resp, sizeof(resp), true);
+      if (ack_payload)
+        arm(); // leaving RX mode flushed the payloads
+    }
+    const auto *perm = frame.as<PermissionToSendPacket>();
+    if (perm && perm->target_drone_id == 0 && !ack_payload) {
+      if (status) {
+        radio.sendTo(addressOf(status->target_drone_id), &*status,
+                     sizeof(*status));
+        stats.command_frames++;
+        status.reset();
+      }
+      const CommandPacket cmd = makeCommand(clock, 0, "no_need");
+      radio.sendTo(addressOf(leader), &cmd, sizeof(cmd));
+      stats.command_frames++;
+    }
+  }
+}
+
+// One ground station and its drones.
+struct SimSwarm {
+  std::unique_ptr<RadioInterface> gbs;
+  GroundStats stats;
+  std::vector<std::unique_ptr<RadioInterface>> radios;
+  std::vector<std::unique_ptr<Drone>> drones;
+  std::vector<DroneIdType> ids;
+  uint8_t channel = JOIN_CHANNEL;
+  float survey_busy = 0.0f; // occupancy the survey saw on `channel`
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const Options opt = parseArgs(argc, argv);
+  if (opt.metrics)
+    metricsOpen();
+
+  SimMediumConfig cfg;
+  cfg.loss_probability = opt.loss;
+  cfg.latency = std::chrono::microseconds(opt.latency_us);
+  for (int ch : opt.wifi)
+    cfg.interferers.push_back(wifiInterferer(ch, opt.wifi_duty));
+  SimMedium medium(cfg);
+
+  std::atomic<bool> stop{false};
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> pos(-opt.radius, opt.radius);
+  FlightRecorder recorder; // outlives the radios and their RX threads
+  if (!opt.record.empty() && !recorder.open(opt.record))
+    std::cerr << "Could not open " << opt.record << "\n";
+  std::vector<std::unique_ptr<SimSwarm>> swarms;
+  std::vector<std::thread> threads;
+
+  // Swarms start one after another so that each survey hears the ones
+  // already flying. They overlap in space, half a radius apart.
+  for (int k = 0; k < opt.swarms; ++k) {
+    auto sw = std::make_unique<SimSwarm>();
+    const double x0 = k * opt.radius / 2.0;
+    sw->gbs = std::make_unique<RadioInterface>(
+        std::make_unique<SimTransport>(medium, x0, 0.0));
+    RadioInterface &gbs = *sw->gbs;
+    gbs.begin();
+    gbs.configure(JOIN_CHANNEL, RadioDataRate::MEDIUM_RATE);
+    gbs.setAddress(BASE_RX, BASE_TX);
+    if (opt.scan) {
+      const SpectrumSurvey survey = surveySpectrum(gbs);
+      sw->channel = selectChannel(survey, {}, static_cast<uint32_t>(k));
+      sw->survey_busy = survey.occupancy(sw->channel);
+      gbs.setChannel(sw->channel);
+    }
+
+    for (int i = 1; i <= opt.nodes; ++i)
+      sw->ids.push_back(static_cast<DroneIdType>(i));
+    for (DroneIdType id : sw->ids) {
+      auto radio = std::make_unique<RadioInterface>(std::make_unique<SimTransport>(
+          medium, x0 + pos(rng), pos(rng)));
+      radio->begin();
+      auto drone = std::make_unique<Drone>(*radio, false,
+                                           "Sim" + std::to_string(id));
+      // Katılma yanıtı havadan gelmiş gibi uygulanır
+      JoinResponsePacket resp{};
+      resp.assigned_id = id;
+      resp.current_leader_id = sw->ids.front();
+      resp.assigned_channel = sw->channel;
+      // GBS'nin saati senkronsuz SwarmClock: aynı makinenin monotonik saati
+      resp.timestamp = static_cast<uint32_t>(monotonicMicros());
+      if (opt.unicast) {
+        resp.unicast_address = unicastAddressByte(id);
+        resp.group_address =
+            groupAddressByte(static_cast<uint8_t>((id - 1) / 4));
+      }
+      drone->applyJoinResponse(resp);
+      drone->clearRoleChanged();
+      drone->setAckPayloads(opt.ack_payload);
+      drone->setLinkAdaptation(opt.adapt);
+      radio->configure(resp.assigned_channel, RadioDataRate::MEDIUM_RATE);
+      radio->setAddress(BASE_TX, BASE_RX);
+      if (opt.rx_thread)
+        radio->startRxThread();
+      if (k == 0 && id == sw->ids.front() && recorder.isOpen())
+        radio->setFlightRecorder(&recorder);
+      sw->radios.push_back(std::move(radio));
+      sw->drones.push_back(std::move(drone));
+    }
+
+    SimSwarm &ref = *sw;
+    threads.emplace_back([&opt, &stop, &ref] {
+      const std::vector<DroneIdType> followers(ref.ids.begin() + 1,
+                                               ref.ids.end());
+      groundStation(*ref.gbs, stop, followers, ref.ids.front(), opt,
+                    ref.stats);
+    });
+    for (size_t i = 0; i < ref.drones.size(); ++i) {
+      threads.emplace_back([&stop, &ref, i] {
+        RadioInterface &radio = *ref.radios[i];
+        Drone &drone = *ref.drones[i];
+        std::vector<DroneIdType> members = ref.ids;
+        members.erase(members.begin() + static_cast<std::ptrdiff_t>(i));
+        while (!stop.load()) {
+          if (drone.isLeader())
+            leaderLoop(radio, drone, members, &stop);
+          else
+            followerLoop(radio, drone, nullptr, &stop);
+        }
+      });
+    }
+    swarms.push_back(std::move(sw));
+  }
+  medium.resetStats();
+
+  std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+  stop = true;
+  for (auto &t : threads)
+    t.join();
+
+  const SimMediumStats s = medium.stats();
+  const double secs = static_cast<double>(opt.seconds);
+  uint64_t relayed_ack = 0, relayed_frames = 0;
+  uint64_t unicast_rx = 0, foreign = 0;
+  uint64_t command_frames = 0, samples = 0;
+  uint64_t link_controls = 0, steps_up = 0, steps_down = 0, fallbacks = 0;
+  std::array<uint64_t, LinkAdapter::RUNGS> rungs{};
+  std::array<uint64_t, 256> counts{};
+  // Leader's view of its followers' slots over the last second
+  const uint64_t now_us = monotonicMicros();
+  uint64_t slot_attempts = 0, slot_heard = 0;
+  float worst_link = 100.0f;
+  for (const auto &sw : swarms) {
+    for (const auto &drone : sw->drones) {
+      if (drone->isLeader()) {
+        for (DroneIdType id : sw->ids) {
+          const LinkQuality q = drone->linkStats().quality(id, now_us);
+          if (!q.seen || id == drone->getNetworkId())
+            continue;
+          slot_attempts += q.window.attempts;
+          slot_heard += q.window.delivered;
+          worst_link = std::min(worst_link, 100.0f * q.delivery);
+        }
+      }
+      relayed_ack += drone->downlinkViaAck();
+      relayed_frames += drone->downlinkSeparate();
+      unicast_rx += drone->rxFrames(UNICAST_PIPE);
+      foreign += drone->foreignFrames();
+      link_controls += drone->linkControls();
+      for (DroneIdType id : sw->ids) {
+        if (const LinkAdapter *link = drone->linkTo(id)) {
+          rungs[link->rung()]++;
+          steps_up += link->stepsUp();
+          steps_down += link->stepsDown();
+          fallbacks += link->fallbacks();
+        }
+      }
+    }
+    command_frames += sw->stats.command_frames;
+    samples += sw->stats.samples;
+    for (size_t t = 0; t < counts.size(); ++t)
+      counts[t] += sw->stats.counts[t];
+  }
+  std::cout << "=== Swarm simulation ===\n"
+            << "Nodes          : " << opt.nodes << " x " << opt.swarms
+            << " swarm(s)\n"
+            << "Duration       : " << opt.seconds << " s\n"
+            << "On-air frames  : " << s.transmissions << "\n"
+            << "Delivered      : " << s.delivered << "\n"
+            << "Collisions     : " << s.collisions << " (" << s.interfered
+            << " by interferers)\n"
+            << "Lost           : " << s.lost << "\n"
+            << "RX overflows   : " << s.rx_overflows << "\n"
+            << "Writes acked   : " << s.acked << "\n"
+            << "Writes failed  : " << s.failed << "\n"
+            << "ACK payloads   : " << s.ack_payloads << "\n"
+            << "GBS commands   : " << command_frames << " separate frames\n"
+            << "Relayed cmds   : " << relayed_ack << " on ACKs, "
+            << relayed_frames << " separate\n"
+            << "Unicast RX     : " << unicast_rx << " frames\n"
+            << "Foreign RX     : " << foreign
+            << " frames read for other drones\n"
+            << "GBS uplink     : "
+            << counts[static_cast<size_t>(PacketType::AGGREGATE_TELEMETRY)]
+            << " aggregate frames\n"
+            << "GBS telemetry  : " << samples << " samples (" << samples / secs
+            << " /s)\n"
+            << "GBS permission : "
+            << counts[static_cast<size_t>(PacketType::PERMISSION_TO_SEND)]
+            << "\n"
+            << "GBS leader req : "
+            << counts[static_cast<size_t>(PacketType::LEADER_REQUEST)]
+            << "\n";
+  std::cout << "Slot delivery  : "
+            << (slot_attempts ? 100.0 * slot_heard / slot_attempts : 0.0)
+            << "% last second, worst follower " << worst_link << "%\n";
+  if (opt.adapt) {
+    std::cout << "Link controls  : " << link_controls << " on ACKs, "
+              << steps_up << " up, " << steps_down << " down, " << fallbacks
+              << " fallbacks\n"
+              << "Uplink rungs   : " << rungs[0] << " x 250k, " << rungs[1]
+              << " x 1M, " << rungs[2] << " x 2M, " << rungs[3]
+              << " x 2M/PA high, " << rungs[4] << " x 2M/PA low\n";
+  }
+  for (size_t k = 0; k < swarms.size(); ++k) {
+    const SimSwarm &sw = *swarms[k];
+    std::cout << "Swarm " << k << "        : channel "
+              << static_cast<int>(sw.channel) << " (survey "
+              << 100.0f * sw.survey_busy << "% busy), "
+              << sw.stats.samples / secs << " samples/s\n";
+  }
+  MetricsSnapshot metrics;
+  if (metricsSnapshot(metrics)) {
+    for (size_t i = 0; i < METRIC_HISTOGRAMS; ++i) {
+      const HistogramSnapshot &h = metrics.histograms[i];
+      if (h.count == 0)
+        continue;
+      std::cout << metricHistogramName(static_cast<MetricHistogram>(i))
+                << " : n " << h.count << ", p50 " << h.percentile(0.5)
+                << ", p99 " << h.percentile(0.99) << ", max " << h.max
+                << "\n";
+    }
+    metricsClose();
+  }
+  std::cout << std::flush;
+  return 0;
+}
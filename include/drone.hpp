@@ -1,20 +1,40 @@
 #pragma once
 
+#include "link_adapter.hpp"
+#include "link_stats.hpp"
 #include "packets.hpp"
 #include "radio.hpp"
+#include "sensor_sampler.hpp"
+#include "swarm_address.hpp"
+#include "swarm_clock.hpp"
+#include "tdma.hpp"
+#include "telemetry_aggregator.hpp"
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <optional>
-#include <queue>
 #include <string>
-#include <array>
+#include <unordered_map>
 
 class Drone {
 public:
+  // Commands older than this (swarm time) are ignored once synced.
+  static constexpr int32_t COMMAND_MAX_AGE_US = 50000;
+  // Before the first sync, swarm time is only known from the JoinResponse
+  // timestamp (no delay or drift correction), so the bound is coarse.
+  // Without a JoinResponse every command is ignored.
+  static constexpr int32_t COMMAND_MAX_AGE_UNSYNCED_US = 500000;
+
   Drone(RadioInterface &radio_ref, bool is_leader_init = false,
         const std::string &initial_name = "UnknownDrone");
 
   DroneIdType getTempId() const;
+  // Per boot random, never 0; sent in JoinRequests (see JoinRequestPacket).
+  uint32_t getJoinNonce() const;
+  // True if `resp` answers this drone's JoinRequest: other drones joining
+  // at the same time hear it as well.
+  bool isMyJoinResponse(const JoinResponsePacket &resp) const;
   std::optional<DroneIdType> getNetworkId() const;
   bool isLeader() const;
   const std::string &getName() const;
@@ -26,29 +46,127 @@ public:
 
   void setNetworkId(DroneIdType net_id);
   void clearNetworkId();
+  // Takes over id, addressing and leader from a JoinResponse. Switching to
+  // `assigned_channel` is left to the caller.
+  void applyJoinResponse(const JoinResponsePacket &resp);
+  // Opens the unicast and group reading pipes for the address bytes from a
+  // JoinResponse (0 closes the pipe). With a unicast pipe open, replies to
+  // other drones are addressed to theirs instead of BASE_RX.
+  void setAddressing(uint8_t unicast_address, uint8_t group_address);
+  bool unicastEnabled() const { return unicast_address_ != 0; }
+  // Frames read per reading pipe, and frames that were read only to be
+  // dropped because they targeted another drone.
+  uint64_t rxFrames(uint8_t pipe) const;
+  uint64_t foreignFrames() const { return foreign_frames_; }
   void setLeaderStatus(bool status);
   void setName(const std::string &new_name);
 
   void updateSensors(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy,
                      int16_t gz, float altitude, float battery_voltage);
-
-  void handleIncoming(); // Gelen paketlere göre tepki verir
-  void sendTelemetry();  // Sadece izin aldıysa gönderir
+  // Telemetry timestamp is the sample time, not the call time.
+  void updateSensors(const SensorReading &reading, float altitude,
+                     float battery_voltage);
+
+  size_t handleIncoming(); // Gelen paketlere göre tepki verir
+  void handleFrame(const RadioFrame &frame); // Tek bir çerçeveyi işler
+  bool sendTelemetry();    // İzin aldıysa ya da TDMA slotundaysa gönderir
+  size_t forwardTelemetry(); // Lider: telemetriyi GBS'ye tek burst'te iletir
+
+  // Sends a TimeSyncRequest to the current TX address when one is due.
+  // `mono_us` is the monotonic time of the request; replay passes its
+  // recorded timeline so that the exchange matches the frame stamps.
+  bool requestTimeSync();
+  bool requestTimeSync(uint64_t mono_us);
+  // Reference side: answers the queued requests without ACK, each to the
+  // requester's unicast pipe, or to `address` when unicast is off.
+  size_t answerTimeSync(uint64_t address);
+  SwarmClock &clock() { return clock_; }
+  const SwarmClock &clock() const { return clock_; }
+
+  // Leader downlink. Commands for followers are queued and, with ACK
+  // payloads enabled, preloaded on the follower pipe right before the
+  // target's TDMA slot so they return with its telemetry ACK. Commands
+  // that miss DOWNLINK_MAX_ROUNDS slots are sent as separate frames.
+  void setAckPayloads(bool enabled);
+  bool ackPayloads() const { return ack_payloads_; }
+  bool queueDownlink(const CommandPacket &cmd);
+  // Called at the start of `target`'s slot: settles the previous slot's
+  // payload and arms the one for `target` on `pipe`.
+  void armDownlink(DroneIdType target, uint8_t pipe);
+  // Leader period: sends the commands that could not ride on an ACK, to
+  // the target's unicast pipe or multicast to `address`. Like
+  // forwardTelemetry() it writes them as one burst (RadioInterface::post).
+  size_t flushDownlink(uint64_t address);
+  uint64_t downlinkViaAck() const { return downlink_via_ack_; }
+  uint64_t downlinkSeparate() const { return downlink_separate_; }
+
+  // Link adaptation (include/link_adapter.hpp). The leader keeps one
+  // LinkAdapter per follower, listens at that follower's rate in its slot
+  // and hands changed settings out on the ACK of its telemetry; followers
+  // use the settings they got for their slot uplink and stay at the base
+  // rate otherwise.
+  void setLinkAdaptation(bool enabled, const LinkAdapterConfig &config = {});
+  bool linkAdaptation() const { return link_adaptation_; }
+  const LinkAdapterConfig &linkConfig() const { return link_config_; }
+  // Leader, at the start of `owner`'s slot: feeds the previous slot to its
+  // adapter, switches to `owner`'s rate and preloads a pending
+  // LinkControl. Call before armDownlink(), which queues behind it.
+  void openSlot(DroneIdType owner, uint8_t pipe);
+  // Leader, after the last slot: settles it and returns to the base rate.
+  void closeSlots();
+  const LinkAdapter *linkTo(DroneIdType peer) const;
+  uint64_t linkControls() const { return link_controls_; }
+  // Per-peer delivery, retries, RPD and arrival gaps (include/
+  // link_stats.hpp): writes to the leader and the ground station (id 0),
+  // follower slots on the leader, beacons on followers.
+  const LinkStatsTable &linkStats() const { return link_stats_; }
+  // Follower: settings of the slot uplink, and the end of that uplink
+  // (back to the base rate once telemetry and time sync went out).
+  const LinkSettings &uplinkSettings() const { return uplink_; }
+  void finishUplink();
+
+  std::chrono::steady_clock::time_point lastHeartbeat() const;
+  // PermissionToSend received and not used by sendTelemetry() yet.
+  bool hasPermissionToSend() const { return has_permission_to_send_; }
+
+  // Slot assigned by the last TDMA beacon, until it has been used.
+  std::optional<TdmaSlot> tdmaSlot() const;
 
   void printDroneInfo() const;
 
 private:
-  struct RawPacket {
-    PacketType type;
-    std::array<uint8_t, 32> data{};
-    size_t size = 0;
+  static constexpr size_t RX_QUEUE_DEPTH = 16;
+  // Sync every superframe until the drift fit has samples, then slower.
+  static constexpr uint64_t SYNC_FAST_INTERVAL_US = 100000;
+  static constexpr uint64_t SYNC_INTERVAL_US = 1000000;
+  static constexpr uint8_t DOWNLINK_MAX_ROUNDS = 2;
+
+  struct PendingSync {
+    DroneIdType drone_id;
+    uint64_t originate_us;
+    uint64_t receive_us;
+  };
+
+  struct PendingDownlink {
+    CommandPacket cmd;
+    uint8_t rounds; // slots of its target that passed without delivery
+  };
+
+  struct PeerLink {
+    LinkAdapter adapter;
+    LinkSettings active; // what the follower uses, as far as we know
   };
 
-  size_t packetSize(PacketType type) const;
+  // Adapts the handle* members below to the compile-time packet dispatcher.
+  struct PacketHandler;
+
   void pollRadio();
 
   RadioInterface &radio;
   DroneIdType temp_id_;
+  uint32_t join_nonce_ = 0;
+  // Swarm minus local time (32-bit) from the JoinResponse timestamp.
+  std::optional<uint32_t> join_offset_;
   std::optional<DroneIdType> network_id_;
   bool is_leader_;
   bool has_permission_to_send_ = false;
@@ -56,7 +174,44 @@ private:
   TelemetryPacket telemetry;
   uint32_t total_sends_ = 0;
   uint32_t failed_sends_ = 0;
-  std::queue<RawPacket> rx_queue_;
+  // Frames are received straight into this pool and dispatched in place.
+  std::array<RadioFrame, RX_QUEUE_DEPTH> rx_queue_{};
+  size_t rx_head_ = 0;
+  size_t rx_count_ = 0;
+  std::chrono::steady_clock::time_point last_heartbeat_{};
+  std::optional<TdmaSlot> tdma_slot_;
+  uint64_t frame_rx_us_ = 0; // receive time of the frame being handled
+  uint8_t frame_pipe_ = 0;   // reading pipe of that frame
+  uint8_t unicast_address_ = 0;
+  uint8_t group_address_ = 0;
+  std::array<uint64_t, 6> rx_frames_{};
+  uint64_t foreign_frames_ = 0;
+  TelemetryAggregator aggregator_; // follower samples waiting for uplink
+  SwarmClock clock_;
+  std::optional<uint64_t> sync_originate_; // outstanding request
+  uint64_t next_sync_us_ = 0;
+  std::array<PendingSync, MAX_TDMA_SLOTS> sync_queue_{};
+  size_t sync_count_ = 0;
+  bool ack_payloads_ = false;
+  std::array<PendingDownlink, MAX_TDMA_SLOTS> downlink_{};
+  size_t downlink_count_ = 0;
+  std::optional<DroneIdType> armed_target_; // payload waiting in the module
+  bool armed_delivered_ = false;
+  uint8_t armed_pipe_ = 0;
+  uint64_t downlink_via_ack_ = 0;
+  uint64_t downlink_separate_ = 0;
+  bool link_adaptation_ = false;
+  LinkAdapterConfig link_config_;
+  std::unordered_map<DroneIdType, PeerLink> links_;
+  std::optional<DroneIdType> slot_owner_;
+  uint8_t slot_uplinks_ = 0; // owner frames heard in the open slot
+  uint8_t slot_arc_ = 0;     // ARC the owner reported
+  uint8_t slot_pipe_ = 0;
+  std::optional<LinkSettings> link_armed_; // LinkControl in the ACK FIFO
+  uint64_t link_controls_ = 0;
+  LinkSettings uplink_;
+  uint8_t uplink_miss_run_ = 0;
+  LinkStatsTable link_stats_;
 
   std::optional<DroneIdType> current_leader_id_;
   bool role_changed_ = false;
@@ -73,5 +228,26 @@ private:
 
   void handleLeaderRequest(const LeaderRequestPacket &req);
 
+  void handleBeacon(const BeaconPacket &beacon);
+
+  void handleTimeSyncRequest(const TimeSyncRequestPacket &req);
+
+  void handleTimeSyncResponse(const TimeSyncResponsePacket &resp);
+
+  void handleLinkControl(const LinkControlPacket &ctl);
+
   void handleUndefined();
+
+  bool isForMe(DroneIdType target); // counts frames for other drones
+  // Unicast address of `target`, or `fallback` when unicast is off.
+  uint64_t addressOf(DroneIdType target, uint64_t fallback) const;
+  void noteUplink(DroneIdType source); // armed payload went back to source
+  void settleSlot();
+  LinkSettings baseLink() const;
+  void settleDownlink();
+  void dropDownlink(size_t index);
+  // Queues a frame for the next burst (address 0: the TX address), writing
+  // the queue first when it is full.
+  void queueTx(uint64_t address, const void *data, size_t size,
+               bool multicast, TxCallback done);
 };
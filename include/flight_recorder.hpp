@@ -0,0 +1,137 @@
+#pragma once
+
+#include "transport.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================== Flight Recorder ==================== //
+//
+// Every frame the radio sends or receives, appended to a ring of fixed
+// 64-byte records in a memory-mapped file. Writing a record is one atomic
+// add for its index and a 64-byte copy into the page cache; no system
+// call, no lock. The kernel writes the dirty pages back on its own, also
+// after the process crashed, so the file ends with the last frames before
+// the crash. Only a power loss can drop what was not written back yet
+// (flush() forces it).
+//
+// A record carries its sequence number, stored last: a reader keeps the
+// records whose number matches their position, which drops a record torn
+// by a crash and the ones already overwritten by a newer lap of the ring.
+// examples/flight_decode prints a recording and exports it as pcap.
+
+enum class FlightDirection : uint8_t {
+  RX = 0,
+  TX = 1,
+  ACK_PAYLOAD = 2, // came back with the ACK of our own write
+};
+
+// Record flags
+constexpr uint8_t FLIGHT_ACKED = 0x01;     // TX: write was acknowledged
+constexpr uint8_t FLIGHT_RPD = 0x02;       // RX: RPD latched (> -64 dBm)
+constexpr uint8_t FLIGHT_MULTICAST = 0x04; // TX: no ACK requested
+
+struct FlightRecord {
+  std::atomic<uint64_t> seq; // position + 1, 0 while being written
+  uint64_t time_us;          // monotonicMicros()
+  uint64_t address;          // TX: destination pipe address
+  FlightDirection direction;
+  uint8_t pipe;
+  uint8_t size;
+  uint8_t arc;
+  uint8_t flags;
+  uint8_t channel;
+  uint8_t data_rate; // RadioDataRate
+  uint8_t reserved;
+  uint8_t data[32];
+};
+static_assert(sizeof(FlightRecord) == 64, "one cache line per record");
+
+constexpr uint32_t FLIGHT_MAGIC = 0x31464652; // "RFF1"
+constexpr uint32_t FLIGHT_VERSION = 1;
+
+// First page of the file.
+struct FlightHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t capacity;         // records in the ring
+  uint64_t start_unix_us;    // wall clock at open()
+  uint64_t start_monotonic_us;
+  int32_t pid;
+  uint32_t reserved;
+  std::atomic<uint64_t> next; // records written so far
+};
+constexpr size_t FLIGHT_HEADER_BYTES = 4096;
+static_assert(sizeof(FlightHeader) <= FLIGHT_HEADER_BYTES);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+class FlightRecorder {
+public:
+  static constexpr size_t DEFAULT_RECORDS = 65536; // 4 MiB
+
+  FlightRecorder() = default;
+  ~FlightRecorder();
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+  // Creates or truncates `path` with room for `records` frames.
+  bool open(const std::string &path, size_t records = DEFAULT_RECORDS);
+  void close();
+  bool isOpen() const { return header_ != nullptr; }
+
+  // Thread safe; frames longer than 32 bytes are cut.
+  void record(FlightDirection direction, const void *data, size_t size,
+              uint64_t time_us, uint8_t pipe = 0, uint8_t arc = 0,
+              uint8_t flags = 0, uint8_t channel = 0,
+              RadioDataRate rate = RadioDataRate::MEDIUM_RATE,
+              uint64_t address = 0);
+
+  // Starts write-back of the dirty pages (msync MS_ASYNC).
+  void flush();
+  uint64_t recorded() const;
+
+private:
+  FlightHeader *header_ = nullptr;
+  FlightRecord *records_ = nullptr;
+  size_t capacity_ = 0;
+  size_t bytes_ = 0;
+};
+
+// ---- reader side ----
+
+// Plain copy of a record for offline tools.
+struct FlightEntry {
+  uint64_t seq;
+  uint64_t time_us;
+  uint64_t address;
+  FlightDirection direction;
+  uint8_t pipe;
+  uint8_t size;
+  uint8_t arc;
+  uint8_t flags;
+  uint8_t channel;
+  RadioDataRate data_rate;
+  uint8_t data[32];
+};
+
+struct FlightLog {
+  uint32_t capacity = 0;
+  uint64_t start_unix_us = 0;
+  uint64_t start_monotonic_us = 0;
+  int32_t pid = 0;
+  uint64_t written = 0;  // records ever written
+  uint64_t torn = 0;     // slots skipped as incomplete
+  std::vector<FlightEntry> entries; // oldest first
+
+  // Wall clock time of a record.
+  uint64_t unixMicros(const FlightEntry &e) const {
+    return start_unix_us +
+           static_cast<int64_t>(e.time_us - start_monotonic_us);
+  }
+};
+
+// Reads a recorder file, also one still being written or left by a crash.
+bool readFlightLog(const std::string &path, FlightLog &log);
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "packets.hpp"
+#include "radio.hpp"
+#include "swarm_address.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==================== Fragmentation ==================== //
+//
+// Messages longer than a frame (mission plans, configuration blobs, log
+// chunks) are cut into FragmentPackets of FRAGMENT_PAYLOAD bytes:
+//
+//  - the sender posts every outstanding fragment in one go, so they leave
+//    back to back as TX bursts (RadioInterface::post), and sets
+//    FRAGMENT_ACK_REQUEST on the last one of the round,
+//  - the receiver copies each fragment straight into a reassembly buffer
+//    from a fixed pool and answers an ACK request with a selective
+//    acknowledgement: the first missing fragment and a bitmap of the
+//    FRAGMENT_ACK_WINDOW after it, enough for most messages in one frame,
+//  - the next round resends only what the map reports missing, plus
+//    fragments whose own write failed. A round that gets no answer
+//    within `ack_timeout_us` resends just the last fragment as a probe.
+//
+// Link level ACK and retransmission stay on for fragments, so the map
+// only has to fill the gaps the link did not repair (a full receiver, a
+// multicast send). The selective ACKs go to fragmentAddress() of the
+// sender without link ACK: their retries would collide with the next
+// round of a half duplex peer, and a lost one is covered by the probe.
+
+constexpr size_t FRAGMENT_MAX_COUNT = 255;
+constexpr size_t FRAGMENT_MAX_MESSAGE = FRAGMENT_MAX_COUNT * FRAGMENT_PAYLOAD;
+constexpr size_t FRAGMENT_ACK_WINDOW = FRAGMENT_ACK_BYTES * 8;
+
+// Where a node receives fragment traffic: the ground station (id 0) on
+// BASE_TX, drones on their unicast pipe. Ids above UNICAST_MAX_ID have no
+// pipe of their own and only hear BASE_RX; a FragmentPacket carries no
+// target, so they can send messages and get their ACKs (which do) there,
+// but cannot be sent to.
+constexpr uint64_t fragmentAddress(DroneIdType id) {
+  return id == 0 ? BASE_TX
+                 : unicastAddressByte(id) ? swarmAddress(unicastAddressByte(id))
+                                          : BASE_RX;
+}
+
+constexpr bool fragmentReachable(DroneIdType id) {
+  return id == 0 || unicastAddressByte(id) != 0;
+}
+
+struct FragmentConfig {
+  uint32_t ack_timeout_us = 20000;
+  // Rounds in a row that get no new fragment acknowledged before the
+  // message is given up.
+  uint8_t max_rounds = 16;
+  // Reassembly buffers; the oldest unfinished message gives way.
+  size_t slots = 4;
+  // A message is dropped after this long without a fragment; a finished
+  // one is kept until then only to answer repeated ACK requests.
+  uint64_t expire_us = 2000000;
+  // Fragments without link ACK (several receivers); the selective ACK
+  // then does all of the recovery.
+  bool multicast = false;
+};
+
+struct FragmentSenderStats {
+  uint64_t messages = 0;
+  uint64_t delivered = 0;
+  uint64_t failed = 0;
+  uint64_t fragments = 0;   // written, first copies and resends
+  uint64_t resent = 0;      // of those, resends
+  uint64_t rounds = 0;
+  uint64_t timeouts = 0;    // rounds without an answer
+};
+
+enum class FragmentState : uint8_t { IDLE, SENDING, DELIVERED, FAILED };
+
+class FragmentSender {
+public:
+  FragmentSender(RadioInterface &radio, DroneIdType self,
+                 FragmentConfig config = {});
+
+  // Starts sending `size` bytes to `dest`. False while a message is still
+  // in flight, if it is empty or longer than FRAGMENT_MAX_MESSAGE, or if
+  // `dest` has no fragment address (fragmentReachable).
+  bool start(DroneIdType dest, const void *data, size_t size);
+  // Writes the next round when one is due; call it from the node loop.
+  void poll(uint64_t now_us);
+  // Feeds a received frame; true if it was an ACK for this sender.
+  bool handleFrame(const RadioFrame &frame, uint64_t now_us);
+
+  FragmentState state() const { return state_; }
+  bool busy() const { return state_ == FragmentState::SENDING; }
+  // Id of the last message started; the first one is random, so that a
+  // restarted sender does not repeat ids a receiver still remembers.
+  uint8_t messageId() const { return message_id_; }
+  const FragmentSenderStats &stats() const { return stats_; }
+
+private:
+  void sendRound(uint64_t now_us);
+  void queue(const FragmentPacket &frag, size_t index, bool request);
+
+  RadioInterface &radio_;
+  DroneIdType self_;
+  FragmentConfig config_;
+  FragmentSenderStats stats_;
+  FragmentState state_ = FragmentState::IDLE;
+  DroneIdType dest_ = 0;
+  uint8_t message_id_ = 0;
+  uint8_t count_ = 0;
+  size_t size_ = 0;
+  std::vector<uint8_t> message_; // FRAGMENT_MAX_MESSAGE, allocated once
+  std::array<bool, FRAGMENT_MAX_COUNT> pending_{};
+  uint8_t rounds_ = 0;   // since the last progress
+  size_t acked_ = 0;     // fragments known to have arrived
+  bool first_round_ = true;
+  bool waiting_ = false; // a round is out, its ACK not in yet
+  bool request_failed_ = false; // the round's ACK request was not written
+  uint64_t deadline_us_ = 0;
+};
+
+// A reassembled message; the bytes stay valid until the next
+// handleFrame() call.
+struct FragmentMessage {
+  DroneIdType source = 0;
+  uint8_t message_id = 0;
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+};
+
+struct FragmentReceiverStats {
+  uint64_t fragments = 0;
+  uint64_t duplicates = 0;
+  uint64_t messages = 0;
+  uint64_t acks = 0;
+  uint64_t evicted = 0; // unfinished messages pushed out or expired
+};
+
+class FragmentReceiver {
+public:
+  FragmentReceiver(RadioInterface &radio, DroneIdType self,
+                   FragmentConfig config = {});
+
+  // Feeds a received frame. Returns the message a fragment completed,
+  // nullptr otherwise (other packet types included).
+  const FragmentMessage *handleFrame(const RadioFrame &frame,
+                                     uint64_t now_us);
+
+  const FragmentReceiverStats &stats() const { return stats_; }
+
+private:
+  struct Slot {
+    bool used = false;
+    bool complete = false;
+    DroneIdType source = 0;
+    uint8_t message_id = 0;
+    uint8_t count = 0;
+    uint8_t have = 0;
+    size_t size = 0;
+    uint64_t last_us = 0;
+    std::array<bool, FRAGMENT_MAX_COUNT> received{};
+    std::array<uint8_t, FRAGMENT_MAX_MESSAGE> data;
+  };
+
+  Slot &slotFor(const FragmentPacket &frag, uint64_t now_us);
+  void sendAck(const Slot &slot);
+
+  RadioInterface &radio_;
+  DroneIdType self_;
+  FragmentConfig config_;
+  FragmentReceiverStats stats_;
+  std::vector<Slot> slots_; // the pool, allocated once
+  FragmentMessage done_;
+};
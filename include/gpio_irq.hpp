@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Falling-edge events of a GPIO line through the Linux gpiochip character
+// device. Used to wake the radio RX thread on the nRF24 IRQ pin (active
+// low) instead of polling the module over SPI.
+class GpioIrqLine {
+public:
+  GpioIrqLine() = default;
+  ~GpioIrqLine();
+
+  GpioIrqLine(const GpioIrqLine &) = delete;
+  GpioIrqLine &operator=(const GpioIrqLine &) = delete;
+
+  bool open(const std::string &chip, unsigned line);
+  void close();
+  bool isOpen() const { return fd >= 0; }
+
+  // Pollable descriptor that becomes readable on an edge.
+  int eventFd() const { return fd; }
+
+  // Consumes queued edge events without blocking.
+  void clear();
+
+private:
+  int fd = -1;
+};
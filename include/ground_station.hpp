@@ -0,0 +1,164 @@
+#pragma once
+
+#include "packets.hpp"
+#include "radio.hpp"
+#include "radio_bank.hpp"
+#include "swarm_address.hpp"
+#include "swarm_clock.hpp"
+#include "telemetry_codec.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+// ==================== Ground Station ==================== //
+//
+// The GBS side of the protocol: hands out network ids to JoinRequests,
+// designates the leader and replaces it when it falls silent, answers the
+// leader's PermissionToSend and time sync requests and ingests every form
+// of telemetry (plain, aggregated by the leader, delta compressed).
+//
+// With a RadioBank every module serves its own swarm on its own channel.
+// Joins are spread over the modules, fewest drones first, through the
+// JoinResponse's assigned_channel; each module's swarm has its own leader.
+// Replies go out on the module the request came in on.
+//
+// Per drone state lives in SwarmTable, one array per field indexed by
+// DroneIdType. Ingesting a frame touches the few columns it updates, and
+// scans such as leader selection or expiry walk one dense array instead
+// of striding over whole records.
+
+constexpr size_t SWARM_TABLE_SIZE = 256; // every DroneIdType value
+constexpr DroneIdType GBS_MAX_DRONES = 200; // ids handed out are 1..200
+
+struct SwarmTable {
+  // Membership; temp_id 0 marks a free id. The join nonce recognises a
+  // repeated request (temp ids and names are not unique).
+  std::array<DroneIdType, SWARM_TABLE_SIZE> temp_id{};
+  std::array<uint32_t, SWARM_TABLE_SIZE> nonce{};
+  std::array<uint64_t, SWARM_TABLE_SIZE> joined_us{};
+  std::array<uint64_t, SWARM_TABLE_SIZE> last_seen_us{};
+  std::array<uint8_t, SWARM_TABLE_SIZE> radio{}; // module of its swarm
+  // Link: frames heard from the drone itself, telemetry samples (also via
+  // the leader), EWMA of the gap between samples and the drone's own view
+  // of its uplink from the last full TelemetryPacket.
+  std::array<uint32_t, SWARM_TABLE_SIZE> frames{};
+  std::array<uint32_t, SWARM_TABLE_SIZE> samples{};
+  std::array<uint64_t, SWARM_TABLE_SIZE> last_sample_us{};
+  std::array<float, SWARM_TABLE_SIZE> gap_us{};
+  std::array<uint8_t, SWARM_TABLE_SIZE> retries{};
+  std::array<float, SWARM_TABLE_SIZE> link_quality{};
+  // Last telemetry. Aggregated samples only carry the high IMU byte.
+  std::array<uint32_t, SWARM_TABLE_SIZE> timestamp{};
+  std::array<int16_t, SWARM_TABLE_SIZE> accel_x{}, accel_y{}, accel_z{};
+  std::array<int16_t, SWARM_TABLE_SIZE> gyro_x{}, gyro_y{}, gyro_z{};
+  std::array<float, SWARM_TABLE_SIZE> battery{};
+  std::array<float, SWARM_TABLE_SIZE> altitude{};
+  // Cold
+  std::array<std::array<char, MAX_NODE_NAME_LENGTH>, SWARM_TABLE_SIZE> name{};
+
+  bool active(DroneIdType id) const { return temp_id[id] != 0; }
+  size_t activeCount() const;
+  void clear(DroneIdType id);
+  // Last telemetry of `id` gathered back into packet form.
+  TelemetryPacket telemetry(DroneIdType id) const;
+};
+
+struct GroundStationConfig {
+  // assigned_channel of JoinResponses with one module, 0: keep. A bank
+  // assigns the channel of the module it picked; for module 0, which also
+  // takes the joins and so visits JOIN_CHANNEL, this one.
+  uint8_t channel = 0;
+  bool unicast = true;  // hand out unicast and group addresses
+  // Drones per group address; 14 spreads 200 ids over the 15 groups.
+  uint8_t group_size = 14;
+  // The leader is replaced after this long without a frame from it.
+  uint64_t leader_timeout_us = 3000000;
+  // Ids silent this long are freed; 0 keeps them.
+  uint64_t expire_us = 60000000;
+};
+
+struct GroundStationStats {
+  uint64_t frames = 0;
+  uint64_t telemetry = 0; // samples ingested, all forms
+  uint64_t unknown = 0;   // telemetry of ids that never joined
+  uint64_t undecodable = 0; // compressed frames without their reference
+  uint64_t joins = 0;     // JoinResponses sent (retries included)
+  uint64_t join_full = 0; // requests refused, no free id
+  uint64_t leader_changes = 0;
+  uint64_t time_syncs = 0;
+  uint64_t commands = 0;
+  uint64_t expired = 0;
+};
+
+class GroundStation {
+public:
+  explicit GroundStation(RadioInterface &radio,
+                         GroundStationConfig config = {});
+  // Reads the merged stream of `bank`; start() the bank separately.
+  explicit GroundStation(RadioBank &bank, GroundStationConfig config = {});
+
+  // Listens on BASE_TX, where drones and the leader transmit.
+  void begin();
+
+  // Reads and handles up to `max` pending frames; returns how many.
+  size_t poll(size_t max = 64);
+  // `radio` is the module index the frame arrived on.
+  void handleFrame(const RadioFrame &frame, uint8_t radio = 0);
+  // Leader watchdog and id expiry, every few milliseconds is enough.
+  void tick(uint64_t now_us);
+  // poll() and tick() until `stop`, sleeping on the radio in between.
+  void run(const std::atomic<bool> &stop);
+
+  // Sent to the leader when it next asks for permission. Target 0 is the
+  // leader itself.
+  void queueCommand(DroneIdType target, const char *text);
+  // Announces `id` as leader of its module's swarm; false if it is not an
+  // active drone.
+  bool designateLeader(DroneIdType id);
+
+  std::optional<DroneIdType> leader(size_t radio = 0) const {
+    return leaders_[radio];
+  }
+  size_t radios() const { return radios_.size(); }
+  const SwarmTable &table() const { return table_; }
+  const GroundStationStats &stats() const { return stats_; }
+  SwarmClock &clock() { return clock_; }
+
+private:
+  struct PacketHandler;
+
+  void handleJoinRequest(const JoinRequestPacket &req);
+  void handleTelemetry(const TelemetryPacket &tlm);
+  void handleAggregate(const AggregateTelemetryPacket &agg);
+  void handleCompressed(const CompressedTelemetryPacket &frame);
+  void handlePermission(const PermissionToSendPacket &perm);
+  void handleTimeSync(const TimeSyncRequestPacket &req);
+  void handleLeaderRequest(const LeaderRequestPacket &req);
+  void heard(DroneIdType id); // a frame from the drone itself
+  bool ingest(DroneIdType id);  // bookkeeping of one sample
+  void store(const TelemetryPacket &tlm);
+  std::optional<DroneIdType> assignId(const JoinRequestPacket &req);
+  void release(DroneIdType id);
+  uint64_t addressOf(DroneIdType id) const;
+  bool leaderAlive(size_t radio, uint64_t now_us) const;
+  uint8_t leastLoadedRadio() const;
+
+  std::vector<RadioInterface *> radios_;
+  RadioBank *bank_ = nullptr;
+  GroundStationConfig config_;
+  SwarmTable table_;
+  // Delta decoders are large and only used by drones that compress.
+  std::unique_ptr<std::array<TelemetryDecoder, SWARM_TABLE_SIZE>> decoders_;
+  std::array<std::optional<DroneIdType>, RADIO_BANK_MAX> leaders_{};
+  std::deque<CommandPacket> commands_;
+  SwarmClock clock_;
+  GroundStationStats stats_;
+  uint64_t frame_rx_us_ = 0; // arrival time of the frame being handled
+  uint8_t frame_radio_ = 0;  // and its module
+  uint64_t next_tick_us_ = 0;
+};
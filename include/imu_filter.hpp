@@ -0,0 +1,96 @@
+#pragma once
+
+#include "mpu6050.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// ==================== IMU Filter ==================== //
+//
+// Batch kernel for raw MPU6050 samples. A block is laid out as structure
+// of arrays so each stage runs over one channel at a time, a full SIMD
+// register of consecutive samples per instruction:
+//
+//   calibrate  raw int16 -> (raw - bias) * scale          [g, rad/s]
+//   low-pass   IMU_FIR_TAPS windowed-sinc FIR per channel
+//   attitude   complementary filter: integrated gyro pulled towards the
+//              accelerometer tilt (roll, pitch)
+//
+// The vector code is written once over a traits class
+// (imu_filter_kernels.hpp) and built for AVX2+FMA (chosen at run time),
+// SSE2 on other x86-64, NEON on ARM builds with NEON enabled and plain
+// float otherwise, e.g. on the ARMv6 Pi Zero. The complementary filter
+// recursion is serial and stays scalar; the vector part prepares its
+// per-sample input.
+
+constexpr size_t IMU_BLOCK = 128; // samples per block, multiple of 8
+constexpr size_t IMU_FIR_TAPS = 32;
+constexpr size_t IMU_CHANNELS = 6;
+
+enum ImuChannel : size_t { IMU_AX, IMU_AY, IMU_AZ, IMU_GX, IMU_GY, IMU_GZ };
+
+struct ImuBlock {
+  size_t count = 0;
+  alignas(32) int16_t raw[IMU_CHANNELS][IMU_BLOCK] = {}; // input, LSB
+  alignas(32) float value[IMU_CHANNELS][IMU_BLOCK] = {}; // g, rad/s
+  alignas(32) float roll[IMU_BLOCK] = {};                // rad
+  alignas(32) float pitch[IMU_BLOCK] = {};               // rad
+};
+
+// Transposes up to IMU_BLOCK - block.count samples into the block;
+// returns how many were taken.
+size_t appendSamples(ImuBlock &block, const ImuSample *samples, size_t n);
+
+struct ImuCalibration {
+  float bias[IMU_CHANNELS] = {};                         // LSB
+  float accel_scale = 1.0f / 16384.0f;                   // g/LSB, +-2 g
+  float gyro_scale = 3.14159265f / (180.0f * 131.0f);    // rad/s/LSB, +-250 dps
+};
+
+struct ImuFilterConfig {
+  float sample_rate_hz = 1000.0f;
+  float cutoff_hz = 40.0f;     // FIR low-pass corner
+  float attitude_tau_s = 0.5f; // complementary filter time constant
+};
+
+enum class ImuKernel { AUTO, SCALAR, SIMD };
+
+struct ImuKernelOps;
+
+class ImuFilter {
+public:
+  explicit ImuFilter(ImuFilterConfig config = {}, ImuCalibration cal = {},
+                     ImuKernel kernel = ImuKernel::AUTO);
+
+  // Filters block.raw[..count] into block.value, roll and pitch.
+  // Successive blocks continue the same stream.
+  void process(ImuBlock &block);
+  void reset();
+
+  // Bias from a stationary, level recording: gyro to zero, accel to
+  // (0, 0, 1 g).
+  static ImuCalibration calibrateStationary(const ImuSample *samples,
+                                            size_t n,
+                                            ImuCalibration base = {});
+
+  const char *kernelName() const;
+  const ImuCalibration &calibration() const { return cal_; }
+  const ImuFilterConfig &config() const { return config_; }
+  float roll() const { return roll_; }
+  float pitch() const { return pitch_; }
+
+private:
+  static constexpr size_t HISTORY = IMU_FIR_TAPS - 1;
+
+  ImuFilterConfig config_;
+  ImuCalibration cal_;
+  const ImuKernelOps *ops_;
+  alignas(32) float taps_[IMU_FIR_TAPS];
+  // FIR input per channel: HISTORY samples of the previous block, then
+  // the calibrated current block.
+  alignas(32) float work_[IMU_CHANNELS][HISTORY + IMU_BLOCK];
+  float alpha_;
+  float dt_;
+  bool primed_ = false;
+  float roll_ = 0.0f;
+  float pitch_ = 0.0f;
+};
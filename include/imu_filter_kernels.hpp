@@ -0,0 +1,109 @@
+#pragma once
+
+// Vector kernels behind ImuFilter, written once over a traits class V:
+//
+//   F, M            float vector and comparison mask types
+//   W               lanes per vector
+//   load/store      unaligned float access, loadi16 widens int16 lanes
+//   set1 add sub mul div sqrt abs min max
+//   fmadd(a, b, c)  a * b + c
+//   gt(a, b)        lane mask a > b, select(m, a, b) picks a where m is set
+//   copysign(a, s)  |a| with the sign of s
+//
+// Every function here is a template or internal to the including
+// translation unit, so the AVX2 translation unit, built with -mavx2, never
+// shares code with the baseline one.
+
+#include "imu_filter.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Kernel table chosen by ImuFilter. Sample counts are multiples of 8.
+struct ImuKernelOps {
+  const char *name;
+  void (*calibrate)(const int16_t *raw, float *out, size_t n, float bias,
+                    float scale);
+  // `in` is preceded by IMU_FIR_TAPS - 1 samples of history.
+  void (*fir)(const float *in, float *out, size_t n, const float *taps);
+  // Per-sample input u of the complementary filter
+  // angle[i] = alpha * angle[i - 1] + u[i].
+  void (*attitude)(const float *ax, const float *ay, const float *az,
+                   const float *gx, const float *gy, float *roll_u,
+                   float *pitch_u, size_t n, float alpha, float dt);
+};
+
+const ImuKernelOps &imuScalarKernels();
+// Best vector kernels built into this binary for this CPU, or nullptr.
+const ImuKernelOps *imuSimdKernels();
+#ifdef RF24DRONE_HAS_AVX2
+const ImuKernelOps &imuAvx2Kernels();
+#endif
+
+namespace {
+
+// atan2 from a minimax polynomial on [0, 1] and octant folding; about
+// 1e-5 rad worst case, far below the sensor noise.
+template <class V> typename V::F imuAtan2(typename V::F y, typename V::F x) {
+  using F = typename V::F;
+  const F ay = V::abs(y);
+  const F ax = V::abs(x);
+  const F hi = V::max(V::max(ax, ay), V::set1(1e-30f));
+  const F a = V::div(V::min(ax, ay), hi);
+  const F s = V::mul(a, a);
+  F p = V::fmadd(V::set1(-0.0464964749f), s, V::set1(0.15931422f));
+  p = V::fmadd(p, s, V::set1(-0.327622764f));
+  F r = V::fmadd(p, V::mul(s, a), a);
+  r = V::select(V::gt(ay, ax), V::sub(V::set1(1.57079633f), r), r);
+  r = V::select(V::gt(V::set1(0.0f), x), V::sub(V::set1(3.14159265f), r), r);
+  return V::copysign(r, y);
+}
+
+template <class V>
+void imuCalibrateKernel(const int16_t *raw, float *out, size_t n, float bias,
+                        float scale) {
+  const auto b = V::set1(bias);
+  const auto k = V::set1(scale);
+  for (size_t i = 0; i < n; i += V::W)
+    V::store(out + i, V::mul(V::sub(V::loadi16(raw + i), b), k));
+}
+
+template <class V>
+void imuFirKernel(const float *in, float *out, size_t n, const float *taps) {
+  typename V::F h[IMU_FIR_TAPS];
+  for (size_t k = 0; k < IMU_FIR_TAPS; ++k)
+    h[k] = V::set1(taps[k]);
+  for (size_t i = 0; i < n; i += V::W) {
+    auto acc = V::mul(h[0], V::load(in + i));
+    for (size_t k = 1; k < IMU_FIR_TAPS; ++k)
+      acc = V::fmadd(h[k], V::load(in + i - k), acc);
+    V::store(out + i, acc);
+  }
+}
+
+template <class V>
+void imuAttitudeKernel(const float *ax, const float *ay, const float *az,
+                       const float *gx, const float *gy, float *roll_u,
+                       float *pitch_u, size_t n, float alpha, float dt) {
+  const auto gyro_gain = V::set1(alpha * dt);
+  const auto accel_gain = V::set1(1.0f - alpha);
+  const auto zero = V::set1(0.0f);
+  for (size_t i = 0; i < n; i += V::W) {
+    const auto x = V::load(ax + i);
+    const auto y = V::load(ay + i);
+    const auto z = V::load(az + i);
+    const auto roll = imuAtan2<V>(y, z);
+    const auto pitch =
+        imuAtan2<V>(V::sub(zero, x), V::sqrt(V::fmadd(y, y, V::mul(z, z))));
+    V::store(roll_u + i,
+             V::fmadd(gyro_gain, V::load(gx + i), V::mul(accel_gain, roll)));
+    V::store(pitch_u + i, V::fmadd(gyro_gain, V::load(gy + i),
+                                   V::mul(accel_gain, pitch)));
+  }
+}
+
+template <class V> ImuKernelOps imuMakeKernels(const char *name) {
+  return ImuKernelOps{name, &imuCalibrateKernel<V>, &imuFirKernel<V>,
+                      &imuAttitudeKernel<V>};
+}
+
+} // namespace
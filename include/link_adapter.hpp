@@ -0,0 +1,115 @@
+#pragma once
+
+#include "packets.hpp"
+#include "transport.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// ==================== Link Adaptation ==================== //
+//
+// Followers sit at very different distances from their leader. Instead of
+// one data rate and full power for everybody, the leader keeps a
+// LinkAdapter per follower, fed once per superframe with what it saw in
+// that follower's slot: whether the uplink arrived, its retransmission
+// count and whether it was strong enough to latch RPD. The adapter walks a
+// ladder of settings ordered from robust to efficient:
+//
+//   rung 0: 250 kbps, PA max    (-94 dBm sensitivity, long links)
+//   rung 1:   1 Mbps, PA max    (join and base rate)
+//   rung 2:   2 Mbps, PA max
+//   rung 3:   2 Mbps, PA high   (only with RPD, i.e. above -64 dBm)
+//   rung 4:   2 Mbps, PA low
+//
+// Losses or retransmissions step down at once; stepping up needs clean
+// windows in a row, and a step up that fails right away doubles that
+// count (up to 16) so a marginal link does not flap. The leader sends the
+// chosen settings in a LinkControlPacket and listens at that rate in the
+// follower's slot; both ends fall back to the base rung after
+// `fallback_misses` uplinks in a row got lost.
+
+struct LinkSettings {
+  RadioDataRate rate = RadioDataRate::MEDIUM_RATE;
+  RadioPowerLevel power = RadioPowerLevel::MAX_POWER;
+  uint8_t retry_delay = 5; // (n + 1) * 250 us, RF24::begin() default
+  uint8_t retry_count = 15;
+
+  bool operator==(const LinkSettings &) const = default;
+};
+
+struct LinkAdapterConfig {
+  uint8_t window = 8;     // uplink slots per decision
+  uint8_t up_windows = 2; // clean windows in a row before a step up
+  // Lost uplinks or mean retransmissions in a window that step down. A
+  // slot can also stay empty because the follower missed the beacon, so
+  // a single miss is not held against the link.
+  uint8_t down_misses = 3;
+  float down_arc = 1.5f;
+  // Limits for a window to count as clean.
+  uint8_t up_misses = 1;
+  float up_arc = 0.25f;
+  // Share of RPD uplinks needed to lower the PA level.
+  float up_rpd = 0.75f;
+  uint8_t fallback_misses = 4;
+  uint8_t base_rung = 1;
+  uint8_t min_rung = 0;
+  uint8_t max_rung = 4;
+};
+
+class LinkAdapter {
+public:
+  static constexpr size_t RUNGS = 5;
+
+  explicit LinkAdapter(LinkAdapterConfig config = {});
+
+  static LinkSettings rungSettings(size_t rung);
+
+  // One uplink slot of the peer. `arc` and `rpd` are ignored for a miss.
+  void record(bool received, uint8_t arc, bool rpd);
+  // Back to the base rung, e.g. after the peer rejoined.
+  void reset();
+
+  size_t rung() const { return rung_; }
+  LinkSettings settings() const { return rungSettings(rung_); }
+  const LinkAdapterConfig &config() const { return config_; }
+
+  uint32_t stepsUp() const { return steps_up_; }
+  uint32_t stepsDown() const { return steps_down_; }
+  uint32_t fallbacks() const { return fallbacks_; }
+
+private:
+  static constexpr uint8_t MAX_UP_WINDOWS = 16;
+
+  void step(size_t rung);
+  void clearWindow();
+
+  LinkAdapterConfig config_;
+  size_t rung_;
+  uint8_t slots_ = 0;
+  uint8_t misses_ = 0;
+  uint8_t received_ = 0;
+  uint16_t arc_sum_ = 0;
+  uint8_t rpd_ = 0;
+  uint8_t miss_run_ = 0;
+  uint8_t clean_windows_ = 0;
+  uint8_t up_windows_;
+  bool probing_ = false; // first window after a step up
+  bool skip_arc_ = false; // peers report ARC of their previous uplink
+  uint32_t steps_up_ = 0;
+  uint32_t steps_down_ = 0;
+  uint32_t fallbacks_ = 0;
+};
+
+// Retransmissions that fit in `budget_us` after the first attempt of a
+// `payload` byte frame, capped at `max_count`.
+uint8_t retriesWithin(uint32_t budget_us, size_t payload, RadioDataRate rate,
+                      uint8_t retry_delay, uint8_t max_count);
+
+// Wire format of LinkControlPacket::retries (the SETUP_RETR layout).
+constexpr uint8_t packRetries(uint8_t delay, uint8_t count) {
+  return static_cast<uint8_t>((delay & 0x0F) << 4 | (count & 0x0F));
+}
+
+LinkControlPacket makeLinkControl(DroneIdType target,
+                                  const LinkSettings &settings,
+                                  uint32_t timestamp);
+LinkSettings linkSettingsFrom(const LinkControlPacket &ctl);
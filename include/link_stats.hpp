@@ -0,0 +1,86 @@
+#pragma once
+
+#include "packets.hpp"
+#include <array>
+#include <cstdint>
+
+// ==================== Per-Peer Link Statistics ==================== //
+//
+// Every drone keeps one entry per peer id (the ground station is id 0) in
+// a fixed table, fed from the protocol paths:
+//
+//   recordTx    our write to the peer, ACKed or not, with its ARC (an
+//               unknown ARC only counts towards delivery)
+//   recordSlot  a frame we expected from the peer (its TDMA slot) arrived
+//               or not, and whether it latched RPD
+//   recordRx    any frame from the peer, for inter-arrival gaps
+//
+// Each metric is kept twice: an EWMA updated per event (weight 1/8, so a
+// link reporting ten times a second moves within a second) and counters
+// over fixed windows of `window_us`, of which the last complete one is
+// reported. Lifetime ratios are not kept; they stop moving on long flights.
+
+struct LinkStatsConfig {
+  uint32_t window_us = 1000000;
+  float alpha = 0.125f; // EWMA weight of a new event
+};
+
+// Counters of one window.
+struct LinkWindow {
+  uint16_t attempts = 0;  // writes and expected frames
+  uint16_t delivered = 0; // ACKed writes and expected frames that arrived
+  uint16_t retries = 0;   // ARC sum of the writes
+  uint16_t received = 0;  // frames from the peer
+  uint16_t rpd_hits = 0;  // expected frames that latched RPD
+  uint32_t max_gap_us = 0;
+};
+
+struct LinkQuality {
+  // EWMAs; delivery and rpd are 0..1, retries is the mean ARC.
+  float delivery = 0.0f;
+  float retries = 0.0f;
+  float rpd = 0.0f;
+  float gap_us = 0.0f;
+  LinkWindow window;        // last complete window
+  uint64_t silent_us = 0;   // since the last frame from the peer
+  bool seen = false;        // any event recorded
+};
+
+class LinkStatsTable {
+public:
+  explicit LinkStatsTable(LinkStatsConfig config = {});
+
+  void recordTx(DroneIdType peer, bool acked, uint8_t arc, uint64_t now_us);
+  void recordSlot(DroneIdType peer, bool heard, bool rpd, uint64_t now_us);
+  void recordRx(DroneIdType peer, uint64_t now_us);
+
+  LinkQuality quality(DroneIdType peer, uint64_t now_us) const;
+  // Delivery EWMA in percent, 100 for a peer without history.
+  float deliveryPercent(DroneIdType peer) const;
+
+  void reset(DroneIdType peer);
+  void clear();
+  const LinkStatsConfig &config() const { return config_; }
+
+private:
+  // EWMA bits in `primed`: the first sample sets the average.
+  static constexpr uint8_t DELIVERY = 1, RETRIES = 2, RPD = 4, GAP = 8;
+
+  struct Entry {
+    float delivery;
+    float retries;
+    float rpd;
+    float gap_us;
+    uint64_t last_rx_us;
+    uint32_t window_index;
+    LinkWindow current;
+    LinkWindow last;
+    uint8_t primed;
+  };
+
+  Entry &roll(DroneIdType peer, uint64_t now_us);
+  void update(Entry &e, uint8_t bit, float &avg, float sample);
+
+  LinkStatsConfig config_;
+  std::array<Entry, 256> entries_{};
+};
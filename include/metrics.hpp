@@ -0,0 +1,278 @@
+#pragma once
+
+#include "packets.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ==================== Runtime Metrics ==================== //
+//
+// Counters and latency histograms for the radio and protocol hot paths,
+// kept in a shared memory segment so that examples/drone_metrics can read
+// them from another process while the drone keeps flying.
+//
+// Every thread that records claims a shard of the segment on first use and
+// is its only writer, so recording is a relaxed load and store on a cache
+// line nobody else writes: no lock prefix, no contention. Readers sum the
+// shards; a value may be one event behind but never torn. Threads beyond
+// METRICS_MAX_SHARDS share a last shard through atomic adds; a shard is
+// handed on when its thread exits.
+//
+// Histograms are log-linear (HDR style): 8 sub-buckets per power of two,
+// so any recorded value is known within 12.5%. Times are in nanoseconds;
+// batch sizes use the same buckets.
+//
+// Until metricsOpen() is called (or when metrics are disabled) every
+// record call is a single predictable branch and no clock is read.
+
+enum class MetricCounter : uint8_t {
+  SEND_OK,
+  SEND_FAILED,
+  FRAMES_RX,
+  ACK_PAYLOADS_RX,
+  ACK_PAYLOADS_HELD, // left in the module while the ACK queue was full
+  POLL_CALLS,   // Drone::pollRadio calls
+  RX_THREAD_WAKEUPS,
+  RX_RING_STALLS,
+  COUNT
+};
+
+enum class MetricHistogram : uint8_t {
+  RADIO_SEND,      // ns blocked in send()/sendTo(), ACK wait included
+  RADIO_RECEIVE,   // ns to read one frame from the module
+  DISPATCH,        // ns in Drone::handleFrame (handler included)
+  HANDLE_INCOMING, // ns per Drone::handleIncoming call that found frames
+  POLL_BATCH,      // frames drained per Drone::pollRadio call
+  RX_THREAD_BATCH, // frames drained per RX thread wakeup
+  COUNT
+};
+
+constexpr size_t METRIC_COUNTERS = static_cast<size_t>(MetricCounter::COUNT);
+constexpr size_t METRIC_HISTOGRAMS =
+    static_cast<size_t>(MetricHistogram::COUNT);
+constexpr size_t METRICS_PACKET_TYPES = 32; // PacketType values tracked
+constexpr size_t METRICS_MAX_SHARDS = 64;
+constexpr size_t METRICS_SUB_BUCKET_BITS = 3;
+constexpr size_t METRICS_BUCKETS = 280; // up to ~2^36 (68 s in ns)
+constexpr uint32_t METRICS_MAGIC = 0x4D443452; // "R4DM"
+constexpr uint32_t METRICS_VERSION = 2;
+constexpr const char *METRICS_DEFAULT_NAME = "/rf24drone-metrics";
+
+// Bucket of a value and the lowest value that falls into a bucket.
+constexpr size_t metricsBucket(uint64_t v) {
+  constexpr uint64_t sub = 1u << METRICS_SUB_BUCKET_BITS;
+  if (v < sub)
+    return static_cast<size_t>(v);
+  const size_t e = 63 - static_cast<size_t>(__builtin_clzll(v));
+  const size_t idx = (e - METRICS_SUB_BUCKET_BITS + 1) * sub +
+                     ((v >> (e - METRICS_SUB_BUCKET_BITS)) & (sub - 1));
+  return idx < METRICS_BUCKETS ? idx : METRICS_BUCKETS - 1;
+}
+
+constexpr uint64_t metricsBucketFloor(size_t idx) {
+  constexpr uint64_t sub = 1u << METRICS_SUB_BUCKET_BITS;
+  if (idx < sub)
+    return idx;
+  const size_t e = idx / sub + METRICS_SUB_BUCKET_BITS - 1;
+  return (uint64_t{1} << e) | (uint64_t{idx % sub} << (e - METRICS_SUB_BUCKET_BITS));
+}
+
+struct alignas(64) MetricsHistogramData {
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+  std::array<std::atomic<uint64_t>, METRICS_BUCKETS> buckets;
+};
+
+struct alignas(64) MetricsShard {
+  std::atomic<uint32_t> claimed; // a thread records into it
+  std::array<std::atomic<uint64_t>, METRIC_COUNTERS> counters;
+  std::array<std::atomic<uint64_t>, METRICS_PACKET_TYPES> rx_packets;
+  std::array<std::atomic<uint64_t>, METRICS_PACKET_TYPES> tx_packets;
+  std::array<MetricsHistogramData, METRIC_HISTOGRAMS> histograms;
+};
+
+// Layout of the shared memory segment; both sides are built from this
+// header and check magic, version and size before use.
+struct MetricsSegment {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  int32_t pid;
+  uint64_t started_unix_us;
+  std::atomic<uint32_t> threads; // threads holding a shard
+  std::array<MetricsShard, METRICS_MAX_SHARDS> shards;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "metrics are shared between processes");
+
+// ---- writer side ----
+
+// Creates (or replaces) the segment `name` under /dev/shm and starts
+// recording into it. Returns false when no segment could be created; the
+// metrics are then kept in process memory, readable by metricsSnapshot().
+bool metricsOpen(const std::string &name = METRICS_DEFAULT_NAME);
+// Stops recording and removes the segment. Call it once the threads that
+// record have stopped; their shards are unmapped.
+void metricsClose();
+bool metricsEnabled();
+
+namespace metrics_detail {
+
+extern std::atomic<MetricsSegment *> segment;
+extern std::atomic<uint32_t> generation; // bumped by every metricsOpen()
+
+struct ThreadShard {
+  MetricsShard *shard = nullptr;
+  uint32_t generation = 0;
+  bool shared = false; // the overflow shard, written by several threads
+};
+extern constinit thread_local ThreadShard local;
+
+ThreadShard &claimShard(MetricsSegment *seg);
+
+inline ThreadShard &currentShard(MetricsSegment *seg) {
+  ThreadShard &t = local;
+  if (t.shard && t.generation == generation.load(std::memory_order_relaxed))
+    return t;
+  return claimShard(seg);
+}
+
+inline void add(const ThreadShard &t, std::atomic<uint64_t> &v, uint64_t n) {
+  if (t.shared)
+    v.fetch_add(n, std::memory_order_relaxed);
+  else
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void raise(std::atomic<uint64_t> &v, uint64_t n) {
+  uint64_t cur = v.load(std::memory_order_relaxed);
+  while (n > cur &&
+         !v.compare_exchange_weak(cur, n, std::memory_order_relaxed)) {
+  }
+}
+
+} // namespace metrics_detail
+
+inline bool metricsActive() {
+  return metrics_detail::segment.load(std::memory_order_relaxed) != nullptr;
+}
+
+inline void metricsCount(MetricCounter c, uint64_t n = 1) {
+  MetricsSegment *seg = metrics_detail::segment.load(std::memory_order_relaxed);
+  if (!seg)
+    return;
+  auto &t = metrics_detail::currentShard(seg);
+  metrics_detail::add(t, t.shard->counters[static_cast<size_t>(c)], n);
+}
+
+inline void metricsPacket(PacketType type, bool tx) {
+  MetricsSegment *seg = metrics_detail::segment.load(std::memory_order_relaxed);
+  const auto i = static_cast<size_t>(type);
+  if (!seg || i >= METRICS_PACKET_TYPES)
+    return;
+  auto &t = metrics_detail::currentShard(seg);
+  metrics_detail::add(t, tx ? t.shard->tx_packets[i] : t.shard->rx_packets[i],
+                      1);
+}
+
+inline void metricsRecord(MetricHistogram h, uint64_t value) {
+  MetricsSegment *seg = metrics_detail::segment.load(std::memory_order_relaxed);
+  if (!seg)
+    return;
+  auto &t = metrics_detail::currentShard(seg);
+  MetricsHistogramData &d = t.shard->histograms[static_cast<size_t>(h)];
+  metrics_detail::add(t, d.count, 1);
+  metrics_detail::add(t, d.sum, value);
+  metrics_detail::add(t, d.buckets[metricsBucket(value)], 1);
+  if (value > d.max.load(std::memory_order_relaxed))
+    metrics_detail::raise(d.max, value);
+}
+
+// Records the lifetime of the scope into a histogram; reads the clock
+// only while metrics are active.
+class MetricsTimer {
+public:
+  explicit MetricsTimer(MetricHistogram h)
+      : histogram_(h), active_(metricsActive()) {
+    if (active_)
+      start_ = std::chrono::steady_clock::now();
+  }
+  ~MetricsTimer() {
+    if (active_ && !cancelled_)
+      metricsRecord(histogram_,
+                    static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_)
+                            .count()));
+  }
+  MetricsTimer(const MetricsTimer &) = delete;
+  MetricsTimer &operator=(const MetricsTimer &) = delete;
+
+  // Nothing worth recording happened (e.g. an empty poll).
+  void cancel() { cancelled_ = true; }
+
+private:
+  MetricHistogram histogram_;
+  bool active_;
+  bool cancelled_ = false;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// ---- reader side ----
+
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  std::array<uint64_t, METRICS_BUCKETS> buckets{};
+
+  double mean() const { return count ? static_cast<double>(sum) / count : 0; }
+  // Single threaded use as a plain histogram, e.g. in offline tools.
+  void add(uint64_t value) {
+    count++;
+    sum += value;
+    max = value > max ? value : max;
+    buckets[metricsBucket(value)]++;
+  }
+  // Lower edge of the bucket holding quantile `q` (0..1).
+  uint64_t percentile(double q) const;
+};
+
+struct MetricsSnapshot {
+  int32_t pid = 0;
+  uint64_t started_unix_us = 0;
+  uint32_t threads = 0;
+  std::array<uint64_t, METRIC_COUNTERS> counters{};
+  std::array<uint64_t, METRICS_PACKET_TYPES> rx_packets{};
+  std::array<uint64_t, METRICS_PACKET_TYPES> tx_packets{};
+  std::array<HistogramSnapshot, METRIC_HISTOGRAMS> histograms{};
+};
+
+// Sums all shards of a segment.
+MetricsSnapshot metricsSnapshot(const MetricsSegment &segment);
+// This process' own metrics; false while metrics are not open.
+bool metricsSnapshot(MetricsSnapshot &out);
+
+// Read-only view of another process' segment.
+class MetricsReader {
+public:
+  MetricsReader() = default;
+  ~MetricsReader();
+  MetricsReader(const MetricsReader &) = delete;
+  MetricsReader &operator=(const MetricsReader &) = delete;
+
+  bool open(const std::string &name = METRICS_DEFAULT_NAME);
+  void close();
+  bool read(MetricsSnapshot &out) const;
+
+private:
+  const MetricsSegment *segment_ = nullptr;
+};
+
+const char *metricCounterName(MetricCounter c);
+const char *metricHistogramName(MetricHistogram h);
@@ -1,7 +1,22 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
+// One coherent MPU6050 sample: ACCEL_XOUT_H .. GYRO_ZOUT_L (0x3B..0x48)
+// taken at the same sample instant, raw register values.
+struct ImuSample {
+  int16_t accel[3];
+  int16_t temperature;
+  int16_t gyro[3];
+};
+
+// Bytes per sample, in the register and in the FIFO.
+constexpr size_t MPU6050_SAMPLE_BYTES = 14;
+// Hardware FIFO size; at 1 kHz it holds ~73 ms of samples.
+constexpr size_t MPU6050_FIFO_BYTES = 1024;
+constexpr uint16_t MPU6050_MAX_RATE_HZ = 1000;
+
 class Mpu6050 {
 public:
   Mpu6050() = default;
@@ -10,8 +25,30 @@ public:
   bool init(const std::string &device = "/dev/i2c-1", uint8_t addr = 0x68);
   bool readAcceleration(int16_t &ax, int16_t &ay, int16_t &az);
   bool readGyro(int16_t &gx, int16_t &gy, int16_t &gz);
+  // Accel, temperature and gyro in a single I2C transaction.
+  bool readSample(ImuSample &sample);
+
+  // FIFO mode: the sensor samples at `rate_hz` (clamped to 4..1000 Hz,
+  // rounded to 1 kHz / n) into its 1 KiB FIFO and readFifo() drains it.
+  bool enableFifo(uint16_t rate_hz);
+  void disableFifo();
+  bool fifoEnabled() const { return fifo_enabled; }
+  uint16_t sampleRateHz() const { return sample_rate_hz; }
+  // Copies up to `max` buffered samples, oldest first. Returns the number
+  // read, or -1 on an I2C error. An overflowed FIFO is reset and its
+  // contents dropped; see fifoOverflows().
+  int readFifo(ImuSample *out, size_t max);
+  uint32_t fifoOverflows() const { return fifo_overflows; }
 
 private:
+  bool readRegisters(uint8_t reg, uint8_t *data, size_t len);
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool resetFifo();
+
   int fd = -1;
   uint8_t address = 0x68;
+  bool combined_rw = true; // adapter supports I2C_RDWR repeated start
+  bool fifo_enabled = false;
+  uint16_t sample_rate_hz = 0;
+  uint32_t fifo_overflows = 0;
 };
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "packets.hpp"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// ==================== Packet Registry ==================== //
+//
+// Every packet struct carries its PacketType as the first member's default
+// value, so the traits below are derived from the structs themselves. Adding
+// a packet means adding it to AllPackets; the size table, validation and the
+// dispatch jump table are generated from that list at compile time.
+
+template <typename T> struct PacketTraits {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "packets are sent as raw bytes");
+  static_assert(alignof(T) == 1, "packets must be #pragma pack(1)");
+  static_assert(sizeof(T) <= 32, "packet does not fit in one nRF24 frame");
+
+  static constexpr PacketType type = T{}.type;
+  static constexpr size_t size = sizeof(T);
+};
+
+template <typename... Ts> struct PacketList {};
+
+using AllPackets =
+    PacketList<CommandPacket, TelemetryPacket, JoinRequestPacket,
+               JoinResponsePacket, HeartbeatPacket, LeaderAnnouncementPacket,
+               PermissionToSendPacket, LeaderRequestPacket, BeaconPacket,
+               AggregateTelemetryPacket, CompressedTelemetryPacket,
+               TimeSyncRequestPacket, TimeSyncResponsePacket,
+               LinkControlPacket, FragmentPacket, FragmentAckPacket>;
+
+namespace packet_detail {
+
+template <typename... Ts>
+constexpr std::array<uint8_t, 256> makeSizeTable(PacketList<Ts...>) {
+  std::array<uint8_t, 256> table{};
+  ((table[static_cast<uint8_t>(PacketTraits<Ts>::type)] =
+        static_cast<uint8_t>(PacketTraits<Ts>::size)),
+   ...);
+  return table;
+}
+
+template <typename... Ts> constexpr bool uniqueTypes(PacketList<Ts...>) {
+  const PacketType types[] = {PacketTraits<Ts>::type...};
+  for (size_t i = 0; i < sizeof...(Ts); ++i) {
+    if (types[i] == PacketType::UNDEFINED)
+      return false;
+    for (size_t j = i + 1; j < sizeof...(Ts); ++j)
+      if (types[i] == types[j])
+        return false;
+  }
+  return true;
+}
+
+} // namespace packet_detail
+
+static_assert(packet_detail::uniqueTypes(AllPackets{}),
+              "each packet struct needs its own, defined PacketType");
+
+// Payload length of each PacketType, 0 for unknown types.
+inline constexpr std::array<uint8_t, 256> PACKET_SIZE_TABLE =
+    packet_detail::makeSizeTable(AllPackets{});
+
+// Expected length of a packet; unknown types only carry their type byte.
+constexpr size_t packetSize(PacketType type) {
+  const uint8_t size = PACKET_SIZE_TABLE[static_cast<uint8_t>(type)];
+  return size ? size : sizeof(PacketType);
+}
+
+// Short lower case name of a type for logs and tools.
+constexpr const char *packetTypeName(PacketType type) {
+  switch (type) {
+  case PacketType::UNDEFINED:
+    return "undefined";
+  case PacketType::JOIN_REQUEST:
+    return "join_request";
+  case PacketType::JOIN_RESPONSE:
+    return "join_response";
+  case PacketType::COMMAND:
+    return "command";
+  case PacketType::TELEMETRY:
+    return "telemetry";
+  case PacketType::HEARTBEAT:
+    return "heartbeat";
+  case PacketType::LEADER_ANNOUNCEMENT:
+    return "leader_announcement";
+  case PacketType::PERMISSION_TO_SEND:
+    return "permission_to_send";
+  case PacketType::LEADER_REQUEST:
+    return "leader_request";
+  case PacketType::BEACON:
+    return "beacon";
+  case PacketType::AGGREGATE_TELEMETRY:
+    return "aggregate_telemetry";
+  case PacketType::COMPRESSED_TELEMETRY:
+    return "compressed_telemetry";
+  case PacketType::TIME_SYNC_REQUEST:
+    return "time_sync_request";
+  case PacketType::TIME_SYNC_RESPONSE:
+    return "time_sync_response";
+  case PacketType::LINK_CONTROL:
+    return "link_control";
+  case PacketType::FRAGMENT:
+    return "fragment";
+  case PacketType::FRAGMENT_ACK:
+    return "fragment_ack";
+  }
+  return "unknown";
+}
+
+// True if `data` holds a known packet type with exactly its length.
+constexpr bool isValidPacket(const uint8_t *data, size_t size) {
+  return size > 0 && PACKET_SIZE_TABLE[data[0]] == size;
+}
+
+// ==================== Dispatch ==================== //
+//
+// Jump table from the type byte straight to `handler(const T &)`. Packet
+// types the handler has no overload for get an empty entry. The payload is
+// viewed in place, relying on the packed structs having alignment 1.
+
+template <typename Handler> class PacketDispatcher {
+  using Entry = void (*)(Handler &, const uint8_t *);
+
+  template <typename T> static void call(Handler &handler, const uint8_t *p) {
+    handler(*reinterpret_cast<const T *>(p));
+  }
+
+  template <typename... Ts>
+  static constexpr std::array<Entry, 256> makeTable(PacketList<Ts...>) {
+    std::array<Entry, 256> table{};
+    (
+        [&] {
+          if constexpr (std::invocable<Handler &, const Ts &>)
+            table[static_cast<uint8_t>(PacketTraits<Ts>::type)] = &call<Ts>;
+        }(),
+        ...);
+    return table;
+  }
+
+  static constexpr std::array<Entry, 256> table_ = makeTable(AllPackets{});
+
+public:
+  // Returns false if the frame is malformed or has no handler.
+  static bool dispatch(Handler &handler, const uint8_t *data, size_t size) {
+    if (!isValidPacket(data, size))
+      return false;
+    const Entry entry = table_[data[0]];
+    if (!entry)
+      return false;
+    entry(handler, data);
+    return true;
+  }
+};
+
+template <typename Handler>
+bool dispatchPacket(Handler &handler, const uint8_t *data, size_t size) {
+  return PacketDispatcher<Handler>::dispatch(handler, data, size);
+}
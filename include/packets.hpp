@@ -16,13 +16,30 @@ enum class PacketType : uint8_t {
   LEADER_ANNOUNCEMENT = 6,
   PERMISSION_TO_SEND = 7,
   LEADER_REQUEST = 8,
+  BEACON = 9,
+  AGGREGATE_TELEMETRY = 10,
+  COMPRESSED_TELEMETRY = 11,
+  TIME_SYNC_REQUEST = 12,
+  TIME_SYNC_RESPONSE = 13,
+  LINK_CONTROL = 14,
+  FRAGMENT = 15,
+  FRAGMENT_ACK = 16,
 };
 // ==================== Constants ==================== //
 
 constexpr size_t MAX_COMMAND_LENGTH = 20;
 constexpr size_t MAX_NODE_NAME_LENGTH = 20;
+constexpr size_t MAX_TDMA_SLOTS = 18;
+constexpr size_t MAX_AGGREGATE_ENTRIES = 4;
+constexpr size_t COMPRESSED_TELEMETRY_PAYLOAD = 27;
+constexpr size_t FRAGMENT_PAYLOAD = 26;
+constexpr uint8_t FRAGMENT_ACK_REQUEST = 0x80; // FragmentPacket::length bit
+constexpr size_t FRAGMENT_ACK_BYTES = 27;
 
 // ==================== Packet Structures ==================== //
+//
+// `timestamp` fields hold the low 32 bits of swarm time in microseconds
+// (see include/swarm_clock.hpp).
 
 #pragma pack(push, 1)
 struct CommandPacket {
@@ -45,19 +62,30 @@ struct TelemetryPacket {
   float link_quality;
 };
 
+// `nonce` is drawn once per boot (never 0); temp ids and names collide
+// between drones, the nonce is what tells their requests apart.
 struct JoinRequestPacket {
   PacketType type = PacketType::JOIN_REQUEST;
   uint32_t timestamp;
   DroneIdType temp_id;
   char requested_name[MAX_NODE_NAME_LENGTH];
+  uint32_t nonce;
 };
 
+// Address bytes select the drone's unicast and group reading pipes (see
+// include/swarm_address.hpp); 0 leaves the pipe closed. Every joining
+// drone hears the response on BASE_RX: temp_id and nonce echo the request
+// it answers.
 struct JoinResponsePacket {
   PacketType type = PacketType::JOIN_RESPONSE;
   DroneIdType assigned_id;
   DroneIdType current_leader_id;
   uint8_t assigned_channel;
   uint32_t timestamp;
+  uint8_t unicast_address;
+  uint8_t group_address;
+  DroneIdType temp_id;
+  uint32_t nonce;
 };
 
 struct HeartbeatPacket {
@@ -83,6 +111,101 @@ struct LeaderRequestPacket {
   DroneIdType drone_id;
   uint32_t timestamp;
 };
+
+// Starts a TDMA superframe. Slot i begins slot_offset_us + i * slot_us after
+// the beacon is received and belongs to slots[i].
+struct BeaconPacket {
+  PacketType type = PacketType::BEACON;
+  DroneIdType leader_id;
+  uint16_t superframe;
+  uint32_t timestamp;
+  uint16_t slot_offset_us;
+  uint16_t slot_us;
+  uint8_t slot_count;
+  DroneIdType slots[MAX_TDMA_SLOTS];
+};
+
+// One follower's IMU sample at reduced precision: the raw MPU6050 readings
+// are kept with their low byte dropped (value ~= raw / 256).
+struct AggregateTelemetryEntry {
+  DroneIdType drone_id;
+  int8_t acceleration[3];
+  int8_t gyroscope[3];
+};
+
+// Leader -> GBS uplink carrying the telemetry of several followers.
+struct AggregateTelemetryPacket {
+  PacketType type = PacketType::AGGREGATE_TELEMETRY;
+  DroneIdType leader_id;
+  uint8_t sequence;
+  uint8_t count;
+  AggregateTelemetryEntry entries[MAX_AGGREGATE_ENTRIES];
+};
+
+// Several telemetry samples of one drone, delta coded against an earlier
+// sample the receiver already has (see include/telemetry_codec.hpp).
+struct CompressedTelemetryPacket {
+  PacketType type = PacketType::COMPRESSED_TELEMETRY;
+  DroneIdType drone_id;
+  uint8_t sequence;  // sequence number of the first sample
+  uint8_t reference; // sample the first one is coded against
+  uint8_t flags;     // bit 7: keyframe, bits 0-6: sample count
+  uint8_t payload[COMPRESSED_TELEMETRY_PAYLOAD];
+};
+
+// NTP-style exchange with the time reference (leader or ground station).
+// Times are full 64-bit microseconds: originate in the requester's local
+// clock, receive/transmit in the reference's swarm time.
+struct TimeSyncRequestPacket {
+  PacketType type = PacketType::TIME_SYNC_REQUEST;
+  DroneIdType drone_id;
+  uint64_t originate_us;
+};
+
+struct TimeSyncResponsePacket {
+  PacketType type = PacketType::TIME_SYNC_RESPONSE;
+  DroneIdType target_drone_id;
+  uint64_t originate_us;
+  uint64_t receive_us;
+  uint64_t transmit_us;
+};
+
+// Leader -> follower: settings for the follower's TDMA uplink (see
+// include/link_adapter.hpp). The leader listens at `data_rate` in the
+// follower's slot from the next superframe on.
+struct LinkControlPacket {
+  PacketType type = PacketType::LINK_CONTROL;
+  DroneIdType target_drone_id;
+  uint32_t timestamp;
+  uint8_t data_rate;   // RadioDataRate
+  uint8_t power_level; // RadioPowerLevel
+  uint8_t retries;     // delay << 4 | count, as in SETUP_RETR
+};
+
+// One piece of a message longer than a frame (see include/fragment.hpp).
+// Every fragment is a full frame; `length` tells how much of the payload
+// is used, its top bit asks the receiver for a FragmentAckPacket.
+struct FragmentPacket {
+  PacketType type = PacketType::FRAGMENT;
+  DroneIdType source_id;
+  uint8_t message_id;
+  uint8_t index;
+  uint8_t count;  // fragments in the message, 1-255
+  uint8_t length; // payload bytes | FRAGMENT_ACK_REQUEST
+  uint8_t payload[FRAGMENT_PAYLOAD];
+};
+
+// Selective acknowledgement: every fragment below `base` arrived, bit i of
+// `received` (LSB first) is fragment base + i. base == count completes
+// the message.
+struct FragmentAckPacket {
+  PacketType type = PacketType::FRAGMENT_ACK;
+  DroneIdType source_id; // receiver of the message
+  DroneIdType target_id; // its sender
+  uint8_t message_id;
+  uint8_t base;
+  uint8_t received[FRAGMENT_ACK_BYTES];
+};
 #pragma pack(pop)
 
 // ==================== Assertions for Packet Sizes ==================== //
@@ -91,10 +214,10 @@ static_assert(sizeof(LeaderAnnouncementPacket) == 6,
 
 static_assert(sizeof(HeartbeatPacket) == 6, "HeartbeatPacket size mismatch");
 
-static_assert(sizeof(JoinResponsePacket) == 8,
+static_assert(sizeof(JoinResponsePacket) == 15,
               "JoinResponsePacket boyutu hatalı");
 
-static_assert(sizeof(JoinRequestPacket) == 26,
+static_assert(sizeof(JoinRequestPacket) == 30,
               "JoinRequestPacket boyutu hatalı");
 
 static_assert(sizeof(TelemetryPacket) == 32, "TelemetryPacket size mismatch");
@@ -106,3 +229,26 @@ static_assert(sizeof(PermissionToSendPacket) == 6,
 
 static_assert(sizeof(LeaderRequestPacket) == 6,
               "LeaderRequestPacket size mismatch");
+
+static_assert(sizeof(BeaconPacket) == 31,
+              "BeaconPacket size mismatch");
+
+static_assert(sizeof(AggregateTelemetryPacket) == 32,
+              "AggregateTelemetryPacket size mismatch");
+
+static_assert(sizeof(CompressedTelemetryPacket) == 32,
+              "CompressedTelemetryPacket size mismatch");
+
+static_assert(sizeof(TimeSyncRequestPacket) == 10,
+              "TimeSyncRequestPacket size mismatch");
+
+static_assert(sizeof(TimeSyncResponsePacket) == 26,
+              "TimeSyncResponsePacket size mismatch");
+
+static_assert(sizeof(LinkControlPacket) == 9,
+              "LinkControlPacket size mismatch");
+
+static_assert(sizeof(FragmentPacket) == 32, "FragmentPacket size mismatch");
+
+static_assert(sizeof(FragmentAckPacket) == 32,
+              "FragmentAckPacket size mismatch");
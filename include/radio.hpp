@@ -1,22 +1,58 @@
 #pragma once
 
+#include "flight_recorder.hpp"
+#include "gpio_irq.hpp"
+#include "packet_traits.hpp"
 #include "packets.hpp"
-#include <RF24.h>
+#include "spsc_ring.hpp"
+#include "timebase.hpp"
+#include "transport.hpp"
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <memory>
+#include <string>
+#include <thread>
 
-enum class RadioDataRate {
-  LOW_RATE,
-  MEDIUM_RATE,
-  HIGH_RATE,
+// One received frame, read from the module exactly once. Packet structs are
+// packed (alignment 1) so a frame can be viewed in place as its packet type
+// without copying it out first.
+struct RadioFrame {
+  std::array<uint8_t, RADIO_MAX_PAYLOAD> data{};
+  uint8_t size = 0;
+  uint8_t pipe = 0;
+  uint64_t rx_time_us = 0; // monotonicMicros() at arrival, or when read
+
+  PacketType type() const {
+    return size ? static_cast<PacketType>(data[0]) : PacketType::UNDEFINED;
+  }
+
+  // Typed view of the payload; nullptr unless the type byte and length
+  // match T.
+  template <typename T> const T *as() const {
+    if (size != PacketTraits<T>::size || type() != PacketTraits<T>::type)
+      return nullptr;
+    return reinterpret_cast<const T *>(data.data());
+  }
 };
 
+// Outcome of a frame queued with post(), passed to its callback.
+struct TxCompletion {
+  bool success = false;
+  uint8_t arc = 0; // TX_ARC_UNKNOWN when the transport could not attribute it
+};
+using TxCallback = std::function<void(const TxCompletion &)>;
+
 class RadioInterface {
 public:
   // Single transceiver constructor
   RadioInterface(uint8_t cePin, uint8_t csnPin);
+  RadioInterface(uint8_t cePin, uint8_t csnPin, uint8_t spiPort);
 
   // Full duplex constructors (separate TX and RX modules)
   RadioInterface(uint8_t txCePin, uint8_t txCsnPin, uint8_t rxCePin,
@@ -24,25 +60,202 @@ public:
   RadioInterface(uint8_t txCePin, uint8_t txCsnPin, uint8_t txSpiPort,
                  uint8_t rxCePin, uint8_t rxCsnPin, uint8_t rxSpiPort);
 
+  // Custom backends (simulator, fakes). Passing an RX transport selects
+  // full duplex mode just like the pin based constructors.
+  explicit RadioInterface(std::unique_ptr<RadioTransport> transport);
+  RadioInterface(std::unique_ptr<RadioTransport> tx,
+                 std::unique_ptr<RadioTransport> rx);
+  ~RadioInterface();
+
+  RadioInterface(const RadioInterface &) = delete;
+  RadioInterface &operator=(const RadioInterface &) = delete;
+
   bool begin();
   void setAddress(uint64_t tx, uint64_t rx);
   void openListeningPipe(uint8_t pipe, uint64_t address);
+  void closeListeningPipe(uint8_t pipe);
   void configure(uint8_t channel = 1,
                   RadioDataRate datarate = RadioDataRate::MEDIUM_RATE);
+  RadioDataRate dataRate() const { return data_rate_; }
+  uint8_t channel() const { return channel_; }
+  // Retunes both modules, keeping the rest of the configuration.
+  void setChannel(uint8_t channel);
+  // Full duplex only: moves the transmitting module to its own channel, so
+  // both directions of a link between two duplex nodes can be on air at
+  // the same time. configure() and setChannel() undo it.
+  void setTxChannel(uint8_t channel);
+  // Switches both modules to `rate` and restarts listening, which also
+  // clears RPD and preloaded ACK payloads. Used per TDMA slot by link
+  // adaptation (see include/link_adapter.hpp).
+  void setDataRate(RadioDataRate rate);
+  // Transmit side only: PA level and auto retransmit settings of the
+  // module that sends.
+  void setPowerLevel(RadioPowerLevel level);
+  void setRetries(uint8_t delay, uint8_t count);
 
   bool send(const void *data, size_t size);
+  // Sends to an explicit address instead of the one set by setAddress().
+  // Multicast frames are not acknowledged, for addresses shared by several
+  // receivers.
+  bool sendTo(uint64_t address, const void *data, size_t size,
+              bool multicast = false);
+  // Reads the next frame with a single FIFO read sized by its dynamic
+  // payload length. Returns false if nothing is pending.
+  bool receive(RadioFrame &frame);
+  // Copying variant kept for the test programs; peeking caches the frame
+  // so that the following call returns it again. The cache is shared by
+  // all callers and guarded by its own mutex.
   bool receive(void *data, size_t size, bool peekOnly = false);
 
   bool testRPD();
   uint8_t getARC();
+  // Tunes the receiving module to `channel`, listens for `dwell` and
+  // returns its RPD (carrier above -64 dBm). The channel is left changed;
+  // see surveySpectrum() in spectrum.hpp.
+  bool probeChannel(uint8_t channel, std::chrono::microseconds dwell);
+
+  // ACK payloads: data preloaded on a listening pipe goes back with the
+  // ACK of the next frame received there, so a downlink message rides on
+  // the sender's own exchange. At most three are held by the module.
+  bool queueAckPayload(uint8_t pipe, const void *data, size_t size);
+  void flushAckPayloads();
+  // Payloads that came back with our own ACKed writes. In full duplex they
+  // land in the TX module and are kept here; receive() returns them first.
+  // While ACK_QUEUE_DEPTH are waiting, further ones are left in the module
+  // (metric ack_payloads_held) rather than pushing out the oldest.
+  // Single transceiver mode reads them as ordinary frames on pipe 0.
+  bool takeAckPayload(RadioFrame &frame);
+
+  // Optional dedicated receive thread. It sleeps on the nRF24 IRQ line
+  // (falling edge on `irqLine` of `gpiochip`, or the transport's own
+  // interrupt descriptor when `gpiochip` is empty), drains the RX FIFO as
+  // soon as it fires and hands frames over through a lock-free SPSC ring.
+  // While it runs, receive() and frontFrame() consume from that ring.
+  bool startRxThread(const std::string &gpiochip = "", unsigned irqLine = 0);
+  void stopRxThread();
+  bool rxThreadRunning() const;
+  // Asynchronous transmit. post() copies a frame into a lock-free SPSC
+  // ring and returns at once; queued frames go out as bursts: one RX->TX
+  // switch per burst, frames to the same address written back to back
+  // through the module's TX FIFO (RadioTransport::writeBurst). `done`
+  // gets the frame's success and ARC, on the thread that wrote the burst
+  // (the TX thread, or whoever called flushTx()), after its slot was freed.
+  // post() has one producer, as the RX ring has one consumer, so `done`
+  // must not post() itself: on the TX thread that would be a second
+  // producer. send() may still be called from anywhere and is serialised
+  // with the bursts. False if the ring is full.
+  bool post(const void *data, size_t size, TxCallback done = {});
+  bool postTo(uint64_t address, const void *data, size_t size,
+              bool multicast = false, TxCallback done = {});
+  // Writes everything posted so far, or waits for the TX thread to; the
+  // callbacks of those frames have run when it returns. Producer side.
+  void flushTx();
+
+  // Optional dedicated transmit thread, the counterpart of the RX thread:
+  // it writes posted frames as they arrive (sleeping on an eventfd that
+  // post() signals only when it went idle). In full duplex the two threads
+  // own one module each and never take the same lock; with a single
+  // transceiver they share it. Without it, frames wait for flushTx().
+  bool startTxThread();
+  // Writes what is still queued, then stops.
+  void stopTxThread();
+  bool txThreadRunning() const;
+  // Frames posted and not yet written.
+  size_t txPending() const;
+  // Results of posted frames.
+  uint64_t txSent() const;
+  uint64_t txFailed() const;
+
+  // Eventfd that becomes readable when the RX thread queued frames, -1
+  // without the thread. Lets RadioBank wait on several radios at once.
+  int rxNotifyFd() const { return notify_fd_; }
+
+  // Waits until a frame is pending or `timeout` expires. Without the RX
+  // thread this is a plain sleep.
+  bool waitForFrame(std::chrono::microseconds timeout);
+
+  // In-place access to frames queued by the RX thread (single consumer).
+  const RadioFrame *frontFrame();
+  void popFrame();
+
+  // Times the RX thread found the ring full and left frames in the module
+  // FIFO (the module then NAKs, so senders retransmit instead of losing).
+  uint64_t rxRingStalls() const;
+
+  // Appends every frame sent and received from now on to `recorder`
+  // (nullptr stops). The recorder has to outlive its use here. Recording
+  // adds an ARC read per write and an RPD read per received frame.
+  void setFlightRecorder(FlightRecorder *recorder);
 
 private:
-  std::unique_ptr<RF24> tx_radio;
-  std::unique_ptr<RF24> rx_radio; // if null, single transceiver mode
+  static constexpr size_t RX_RING_DEPTH = 64;
+  static constexpr size_t ACK_QUEUE_DEPTH = 3;
+  static constexpr size_t TX_RING_DEPTH = 64;
+  static constexpr size_t TX_BURST_MAX = 16;
+
+  // A posted frame; address 0 means tx_address.
+  struct TxFrame {
+    std::array<uint8_t, RADIO_MAX_PAYLOAD> data{};
+    uint8_t size = 0;
+    bool multicast = false;
+    uint64_t address = 0;
+    TxCallback done;
+  };
+
+  RadioTransport *rxTransport();
+  // In single transceiver mode both return the same mutex.
+  std::mutex &txMutex();
+  std::mutex &rxMutex();
+  bool readFrame(RadioFrame &frame);
+  bool readAckFrame(RadioFrame &frame); // full duplex, TX mutex held
+  bool readFrom(RadioTransport *rx, RadioFrame &frame);
+  void recordRx(RadioTransport *rx, FlightDirection direction,
+                const RadioFrame &frame);
+  bool writeLocked(uint64_t address, const void *data, size_t size,
+                   bool multicast);
+  void recordTx(uint64_t address, const void *data, size_t size,
+                uint64_t start_us, uint8_t arc, bool success, bool multicast);
+  void collectAckPayloads(); // full duplex, TX mutex held
+  void writeQueued(size_t count); // consumer side of tx_ring_
+  void rxThreadLoop();
+  void txThreadLoop();
+
+  std::unique_ptr<RadioTransport> tx_radio;
+  std::unique_ptr<RadioTransport> rx_radio; // if null, single transceiver mode
   bool full_duplex = false;
   uint64_t tx_address = 0;
   uint64_t rx_address = 0;
+  uint64_t open_tx_address_ = 0; // address currently in the TX pipe
+  std::atomic<RadioDataRate> data_rate_{RadioDataRate::MEDIUM_RATE};
+  std::atomic<uint8_t> channel_{1};
+  std::atomic<uint8_t> tx_channel_{1};
   // Holds the latest packet when it was peeked so that it can be
   // retrieved again on the next receive call.
-  std::optional<std::array<uint8_t, 32>> cached_packet;
+  std::mutex cache_mutex_;
+  std::optional<RadioFrame> cached_packet;
+  std::atomic<bool> cache_pending_{false}; // skips the mutex when empty
+
+  std::mutex tx_mutex_;
+  std::mutex rx_mutex_;
+  std::thread rx_thread_;
+  std::atomic<bool> rx_running_{false};
+  SpscRing<RadioFrame, RX_RING_DEPTH> rx_ring_;
+  GpioIrqLine irq_line_;
+  int notify_fd_ = -1; // eventfd signalled by the RX thread
+  std::atomic<uint64_t> rx_ring_stalls_{0};
+  std::thread tx_thread_;
+  std::atomic<bool> tx_running_{false};
+  std::atomic<bool> tx_idle_{false}; // thread is about to sleep
+  SpscRing<TxFrame, TX_RING_DEPTH> tx_ring_;
+  int tx_notify_fd_ = -1; // eventfd signalled by post()
+  uint64_t tx_posted_ = 0; // producer side
+  std::atomic<uint64_t> tx_completed_{0}; // callbacks run
+  std::atomic<bool> tx_flushing_{false};  // flushTx() is about to sleep
+  int tx_flush_fd_ = -1; // eventfd signalled by the TX thread for flushTx()
+  std::atomic<uint64_t> tx_sent_{0};
+  std::atomic<uint64_t> tx_failed_{0};
+  std::mutex ack_mutex_;
+  std::deque<RadioFrame> ack_frames_;
+  std::atomic<size_t> ack_pending_{0};
+  std::atomic<FlightRecorder *> recorder_{nullptr};
 };
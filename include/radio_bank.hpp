@@ -0,0 +1,99 @@
+#pragma once
+
+#include "radio.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================== Radio Bank ==================== //
+//
+// Several radio modules read as one frame stream, e.g. a ground station
+// with one module per swarm channel, each on its own SPI bus. Every module
+// runs its own RX thread (RadioInterface::startRxThread), which drains its
+// FIFO on the IRQ into the module's ring. A single consumer merges the
+// rings:
+//
+//  - frames are held for `reorder_us` after their arrival time, then
+//    released oldest first, so a module whose thread ran late does not put
+//    its frames behind newer ones of another module,
+//  - a payload seen again within `dedup_us` is dropped: the same frame
+//    heard by two modules on one channel, or a retransmission whose first
+//    copy arrived but whose ACK was lost.
+//
+// Duplicates are found in a direct-mapped table of payload hashes, so a
+// busy bank may occasionally let one through but never drops a frame it
+// has not seen.
+
+constexpr size_t RADIO_BANK_MAX = 8;
+
+struct RadioBankConfig {
+  uint32_t reorder_us = 500;
+  uint32_t dedup_us = 20000;
+};
+
+struct RadioBankStats {
+  std::array<uint64_t, RADIO_BANK_MAX> frames{}; // per module, duplicates too
+  uint64_t delivered = 0;
+  uint64_t duplicates = 0;
+  uint64_t late = 0; // released after a newer frame, beyond the window
+};
+
+// A frame of the merged stream and the module it came from.
+struct BankFrame {
+  RadioFrame frame;
+  uint8_t radio = 0;
+};
+
+class RadioBank {
+public:
+  explicit RadioBank(RadioBankConfig config = {});
+  ~RadioBank();
+
+  RadioBank(const RadioBank &) = delete;
+  RadioBank &operator=(const RadioBank &) = delete;
+
+  // Adds a configured and listening module, its IRQ line as for
+  // startRxThread(). Returns the module index, -1 if the bank is full.
+  int add(RadioInterface &radio, const std::string &gpiochip = "",
+          unsigned irq_line = 0);
+  // Starts the RX thread of every module.
+  bool start();
+  void stop();
+
+  size_t size() const { return radios_.size(); }
+  RadioInterface &radio(size_t index) { return *radios_[index].radio; }
+
+  // Next frame of the merged stream; false if none is due yet.
+  bool next(BankFrame &out);
+  bool next(BankFrame &out, uint64_t now_us);
+  // Sleeps until a module queued frames or `timeout` expired.
+  void wait(std::chrono::microseconds timeout);
+
+  const RadioBankStats &stats() const { return stats_; }
+  const RadioBankConfig &config() const { return config_; }
+
+private:
+  struct Module {
+    RadioInterface *radio;
+    std::string gpiochip;
+    unsigned irq_line;
+  };
+  struct Seen {
+    uint64_t hash;
+    uint64_t time_us;
+  };
+  static constexpr size_t SEEN_SLOTS = 1024;
+
+  void pull(uint64_t now_us); // module rings -> pending_
+  bool duplicate(const RadioFrame &frame);
+
+  RadioBankConfig config_;
+  std::vector<Module> radios_;
+  std::vector<BankFrame> pending_; // min-heap on rx_time_us
+  std::array<Seen, SEEN_SLOTS> seen_{};
+  uint64_t last_released_us_ = 0;
+  RadioBankStats stats_;
+};
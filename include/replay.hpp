@@ -0,0 +1,169 @@
+#pragma once
+
+#include "flight_recorder.hpp"
+#include "metrics.hpp"
+#include "packets.hpp"
+#include "transport.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ==================== Protocol Replay ==================== //
+//
+// Feeds a stream of frames into one Drone through ReplayTransport, a fake
+// module whose RX FIFO is filled by the harness, and reports throughput,
+// per packet type handling latency and the state changes the stream caused.
+// Frames come from a flight recorder file or from syntheticTraffic(), which
+// is seeded and therefore gives the same stream on every run.
+//
+// Frames are stamped with their recorded times shifted to the start of the
+// replay, so beacons, time sync and link statistics see the original
+// spacing. As fast as possible mode feeds the next frame as soon as the
+// previous one was handled; paths that read the clock themselves (TDMA slot
+// start, heartbeat age) then see compressed time.
+
+struct ReplayFrame {
+  uint64_t time_us = 0; // any monotonic base, only differences matter
+  uint8_t pipe = 1;
+  bool rpd = false;
+  uint8_t size = 0;
+  std::array<uint8_t, RADIO_MAX_PAYLOAD> data{};
+};
+
+// Module stand-in: frames pushed by the harness are read by the radio,
+// writes are counted and ACKed (or not) as configured.
+class ReplayTransport : public RadioTransport {
+public:
+  void push(const ReplayFrame &frame, uint64_t arrival_us);
+  size_t pending() const { return rx_.size(); }
+  void setWriteAcked(bool acked) { write_acked_ = acked; }
+  uint64_t writes() const { return writes_; }
+  uint64_t writes(PacketType type) const;
+  // The last TimeSyncRequest written, once.
+  bool takeTimeSyncRequest(TimeSyncRequestPacket &req);
+
+  bool begin() override { return true; }
+  void setChannel(uint8_t) override {}
+  void setDataRate(RadioDataRate) override {}
+  void setPowerLevel(RadioPowerLevel) override {}
+  void setRetries(uint8_t, uint8_t) override {}
+  void setAutoAck(bool) override {}
+  void enableDynamicPayloads() override {}
+  void enableAckPayload() override {}
+  void enableDynamicAck() override {}
+  void openWritingPipe(uint64_t) override {}
+  void openReadingPipe(uint8_t, uint64_t) override {}
+  void closeReadingPipe(uint8_t) override {}
+  void startListening() override {}
+  void stopListening() override {}
+  bool write(const void *data, uint8_t size, bool multicast) override;
+  bool writeAckPayload(uint8_t, const void *, uint8_t) override {
+    return true;
+  }
+  void flushAckPayloads() override {}
+  bool available(uint8_t *pipe = nullptr) override;
+  uint8_t getDynamicPayloadSize() override;
+  void read(void *data, uint8_t size) override;
+  bool testRPD() override { return rpd_; }
+  uint8_t getARC() override { return write_acked_ ? 0 : 15; }
+  uint64_t rxArrivalUs() override;
+
+private:
+  struct Pending {
+    ReplayFrame frame;
+    uint64_t arrival_us;
+  };
+  std::deque<Pending> rx_;
+  bool rpd_ = false;
+  bool write_acked_ = true;
+  uint64_t writes_ = 0;
+  std::array<uint64_t, 256> writes_by_type_{};
+  std::optional<TimeSyncRequestPacket> sync_request_;
+};
+
+struct ReplayOptions {
+  bool realtime = false; // keep the recorded spacing instead of max speed
+  double speed = 1.0;    // realtime: >1 plays faster
+  size_t batch = 1;      // frames queued per handleIncoming() call
+  // Identity of the drone under test.
+  DroneIdType drone_id = 2;
+  DroneIdType leader_id = 1;
+  bool leader = false;
+  bool unicast = true;
+  // Answer a PermissionToSend with telemetry like followerLoop does.
+  bool respond = true;
+  // Recorded time between the leader periods (forwardTelemetry and
+  // answerTimeSync) or follower time sync requests the harness runs.
+  uint32_t service_us = 100000;
+  // Follower: answer the drone's own TimeSyncRequests as a leader whose
+  // swarm time is the recorded timeline. Responses in the stream never
+  // match a replayed request.
+  bool answer_time_sync = true;
+  size_t passes = 1; // the stream is replayed this many times
+};
+
+enum class ReplayEvent : uint8_t {
+  LEADER_CHANGED, // current leader id moved to `value`
+  ROLE_CHANGED,   // became leader (value 1) or follower (0)
+  PERMISSION,     // PermissionToSend granted
+  TDMA_SLOT,      // a beacon assigned a slot
+  CLOCK_SYNCED,   // swarm clock became synced
+};
+
+struct ReplayTransition {
+  uint64_t frame = 0; // index of the frame that caused it
+  uint64_t time_us = 0; // since the first frame, recorded timeline
+  ReplayEvent event;
+  uint32_t value = 0;
+};
+
+struct ReplayReport {
+  uint64_t frames = 0;
+  uint64_t handled = 0; // frames handleIncoming() reported, time sync
+                        // answers of the harness included
+  double seconds = 0;   // wall time spent in the replay loop
+  double framesPerSecond() const { return seconds > 0 ? handled / seconds : 0; }
+  // Per type byte: frames and the time of the handleIncoming() calls that
+  // handled them (ns; batches are attributed to their first frame's type).
+  std::array<uint64_t, METRICS_PACKET_TYPES> frames_by_type{};
+  std::array<HistogramSnapshot, METRICS_PACKET_TYPES> latency{};
+  HistogramSnapshot all;
+  uint64_t writes = 0;
+  std::array<uint64_t, METRICS_PACKET_TYPES> writes_by_type{};
+  std::array<uint64_t, 5> events{}; // per ReplayEvent
+  std::vector<ReplayTransition> transitions;
+};
+
+const char *replayEventName(ReplayEvent event);
+
+// Frames the drone received (RX and ACK payloads) in a recording.
+std::vector<ReplayFrame> framesFromFlightLog(const FlightLog &log);
+
+struct SyntheticTrafficConfig {
+  uint32_t seed = 1;
+  double seconds = 10.0;
+  size_t followers = 8; // including the drone under test
+  DroneIdType leader_id = 1;
+  DroneIdType drone_id = 2; // the drone under test
+  // Every `leader_change_s` seconds another follower is announced as
+  // leader, and back; 0 disables.
+  double leader_change_s = 5.0;
+  uint32_t superframe_us = 100000;
+  // The stream the leader (`leader_id`) hears instead: slot telemetry and
+  // time sync requests of the followers, ground station commands on ACKs.
+  bool leader_view = false;
+  double loss = 0.05; // share of follower uplinks that never arrive
+};
+
+// A leader's superframes as follower `drone_id` hears them with unicast
+// pipes: beacons and leader announcements on the group pipe, LinkControl
+// and commands on ACKs, commands and permissions on its own pipe. Time
+// sync answers come from the harness (ReplayOptions::answer_time_sync).
+std::vector<ReplayFrame> syntheticTraffic(const SyntheticTrafficConfig &config);
+
+ReplayReport replayFrames(const std::vector<ReplayFrame> &frames,
+                          const ReplayOptions &options);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "transport.hpp"
+#include <RF24.h>
+
+// RadioTransport backed by a physical nRF24L01+ module.
+class Rf24Transport : public RadioTransport {
+public:
+  Rf24Transport(uint8_t cePin, uint8_t csnPin);
+  Rf24Transport(uint8_t cePin, uint8_t csnPin, uint8_t spiPort);
+
+  bool begin() override;
+
+  void setChannel(uint8_t channel) override;
+  void setDataRate(RadioDataRate rate) override;
+  void setPowerLevel(RadioPowerLevel level) override;
+  void setRetries(uint8_t delay, uint8_t count) override;
+  void setAutoAck(bool enable) override;
+  void enableDynamicPayloads() override;
+  void enableAckPayload() override;
+  void enableDynamicAck() override;
+
+  void openWritingPipe(uint64_t address) override;
+  void openReadingPipe(uint8_t pipe, uint64_t address) override;
+  void closeReadingPipe(uint8_t pipe) override;
+  void startListening() override;
+  void stopListening() override;
+
+  bool write(const void *data, uint8_t size, bool multicast) override;
+  // writeFast() into the three-deep TX FIFO, TX_DS/MAX_RT polled per frame.
+  void writeBurst(TxBurstFrame *frames, size_t count) override;
+
+  bool writeAckPayload(uint8_t pipe, const void *data, uint8_t size) override;
+  void flushAckPayloads() override;
+
+  bool available(uint8_t *pipe = nullptr) override;
+  uint8_t getDynamicPayloadSize() override;
+  void read(void *data, uint8_t size) override;
+
+  bool testRPD() override;
+  uint8_t getARC() override;
+
+private:
+  RF24 radio;
+};
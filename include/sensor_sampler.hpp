@@ -0,0 +1,73 @@
+#pragma once
+
+#include "imu_filter.hpp"
+#include "mpu6050.hpp"
+#include "seqlock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Latest IMU reading published by the SensorSampler.
+struct SensorReading {
+  ImuSample imu;         // bias corrected and low-pass filtered, LSB
+  float roll, pitch;     // complementary filter attitude, rad
+  uint64_t timestamp_us; // monotonicMicros() of the sample
+  uint32_t sequence;     // increments with every published reading
+};
+
+struct SensorSamplerConfig {
+  uint16_t rate_hz = 1000;  // sensor sample rate
+  uint16_t decimation = 10; // filtered samples per published reading
+  ImuCalibration calibration{};
+};
+
+// Samples the MPU6050 on its own thread so sensor I/O and radio handling
+// never wait for each other. The sensor FIFO is drained every
+// DRAIN_PERIOD_MS when it can be enabled, otherwise the sample registers
+// are polled at the configured rate. Samples run through ImuFilter, whose
+// low-pass sits below the Nyquist rate of the decimated output, and every
+// `decimation`-th one is published through a SeqLock, which latest() reads
+// without blocking the sampler.
+class SensorSampler {
+public:
+  static constexpr int DRAIN_PERIOD_MS = 10;
+
+  explicit SensorSampler(Mpu6050 &sensor, SensorSamplerConfig config = {});
+  ~SensorSampler();
+
+  SensorSampler(const SensorSampler &) = delete;
+  SensorSampler &operator=(const SensorSampler &) = delete;
+
+  bool start();
+  void stop();
+  bool running() const;
+
+  // Latest reading; false until the first window has been published.
+  bool latest(SensorReading &out) const { return latest_.load(out); }
+  uint32_t published() const { return latest_.version(); }
+  uint32_t readErrors() const {
+    return read_errors_.load(std::memory_order_relaxed);
+  }
+
+private:
+  void run();
+  void runFifo(ImuFilter &filter);
+  void runPolled(ImuFilter &filter);
+  void push(ImuFilter &filter, const ImuSample &sample, uint64_t timestamp_us);
+  void flush(ImuFilter &filter);
+
+  Mpu6050 &sensor_;
+  SensorSamplerConfig config_;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint32_t> read_errors_{0};
+
+  // Sampler thread only.
+  ImuBlock block_;
+  uint64_t stamps_[IMU_BLOCK] = {};
+  int16_t temperature_ = 0;
+  uint16_t since_publish_ = 0;
+  uint32_t sequence_ = 0;
+
+  SeqLock<SensorReading> latest_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock for publishing a small trivially copyable
+// value (latest sensor reading, statistics) to any number of readers.
+//
+// The writer never waits. A reader copies the value and retries only if
+// the writer published during the copy, which at sensor rates is rare.
+// The payload is kept in relaxed atomic words, so a torn copy is a
+// detected retry and not a data race.
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqLock needs a trivially copyable type");
+
+public:
+  // Writer side; only one thread may call store().
+  void store(const T &value) {
+    uint64_t buf[WORDS] = {};
+    std::memcpy(buf, &value, sizeof(T));
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed); // odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i)
+      words_[i].store(buf[i], std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // One read attempt; false if nothing was published yet or a write
+  // overlapped the copy.
+  bool tryLoad(T &out) const {
+    const uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1))
+      return false;
+    uint64_t buf[WORDS];
+    for (size_t i = 0; i < WORDS; ++i)
+      buf[i] = words_[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before)
+      return false;
+    std::memcpy(&out, buf, sizeof(T));
+    return true;
+  }
+
+  // Retries until a consistent copy is read; false only before the first
+  // store().
+  bool load(T &out) const {
+    while (!tryLoad(out)) {
+      if (seq_.load(std::memory_order_relaxed) == 0)
+        return false;
+    }
+    return true;
+  }
+
+  // Number of store() calls so far.
+  uint32_t version() const {
+    return seq_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+
+  alignas(64) std::atomic<uint32_t> seq_{0};
+  std::array<std::atomic<uint64_t>, WORDS> words_{};
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "transport.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <vector>
+
+// ==================== Simulated 2.4 GHz medium ==================== //
+//
+// SimMedium models the air shared by every SimTransport attached to it.
+// Frames travel in real (steady_clock) time so the protocol loops in
+// src/swarm.cpp can run unmodified, one thread per virtual node:
+//
+//  - delivery is per channel and data rate, to every listening node whose
+//    reading pipe matches the destination address,
+//  - two transmissions that overlap on the same channel destroy each other,
+//  - link budget follows free space path loss between node positions; weak
+//    links lose frames, carriers above -64 dBm set RPD on the receiver
+//    whatever their data rate or address and, as on the chip, every valid
+//    packet latches RPD to its own strength,
+//  - optional interferers (Wi-Fi, other systems) occupy a channel range
+//    for a fraction of the time; they destroy frames started while busy
+//    and show up in RPD,
+//  - auto-ack and auto-retransmit (ARC) behave like the nRF24L01+ and the
+//    RX FIFO is three frames deep,
+//  - ACK payloads preloaded on a receiver pipe ride back on the next ACK
+//    sent from that pipe and land in the sender's RX FIFO on pipe 0; like
+//    the RF24 driver, stopListening() flushes them.
+
+// Foreign transmitter busy for `duty` of the time on every channel of
+// [first_channel, last_channel], e.g. a 22 MHz Wi-Fi channel.
+struct SimInterferer {
+  uint8_t first_channel;
+  uint8_t last_channel;
+  double duty;
+};
+
+// nRF24 channels covered by 2.4 GHz Wi-Fi channel `wifi_channel` (1-13).
+SimInterferer wifiInterferer(int wifi_channel, double duty);
+
+struct SimMediumConfig {
+  // Probability of losing a frame regardless of signal strength.
+  double loss_probability = 0.0;
+  // Delay between the end of a frame on air and it becoming readable from
+  // the receiver's FIFO (SPI, IRQ and scheduling latency).
+  std::chrono::microseconds latency{0};
+  // Time stopListening() blocks the caller, as RF24 waits txDelay (a few
+  // hundred microseconds) before a module that listened may transmit.
+  // 0 keeps mode changes free.
+  std::chrono::microseconds turnaround{0};
+  uint32_t seed = 1;
+  std::vector<SimInterferer> interferers;
+};
+
+struct SimMediumStats {
+  uint64_t transmissions = 0; // frames put on air, retransmissions included
+  uint64_t delivered = 0;     // frames placed into a receiver FIFO
+  uint64_t collisions = 0;    // frames destroyed by overlapping transmissions
+  uint64_t lost = 0;          // frames dropped by loss or weak signal
+  uint64_t rx_overflows = 0;  // frames dropped because the RX FIFO was full
+  uint64_t acked = 0;         // writes that received an ACK
+  uint64_t failed = 0;        // writes that exhausted every retransmission
+  uint64_t ack_payloads = 0;  // ACK payloads delivered to a sender
+  uint64_t interfered = 0;    // frames destroyed by an interferer
+};
+
+class SimTransport;
+
+class SimMedium {
+public:
+  explicit SimMedium(SimMediumConfig config = {});
+
+  SimMediumStats stats() const;
+  void resetStats();
+  const SimMediumConfig &config() const { return config_; }
+
+private:
+  friend class SimTransport;
+  using Clock = std::chrono::steady_clock;
+
+  struct Transmission {
+    uint64_t id;
+    uint8_t channel;
+    bool collided;
+    const SimTransport *sender;
+  };
+
+  void attach(SimTransport *node);
+  void detach(SimTransport *node);
+
+  uint64_t beginTransmission(const SimTransport &sender, uint8_t channel);
+  // Ends an on-air frame and delivers it. Returns true if at least one
+  // receiver acknowledged it; `ack_size` is the ACK payload length.
+  bool endTransmission(uint64_t id, SimTransport &sender, const uint8_t *data,
+                       uint8_t size, bool wants_ack, uint8_t &ack_size);
+
+  double receivedPower(const SimTransport &from, const SimTransport &to) const;
+  bool roll(double probability);
+  // Rolls whether an interferer is on air on `channel` right now.
+  bool interfered(uint8_t channel);
+  // RPD of `node` at this instant: a strong frame or an interferer on air.
+  bool carrierOn(const SimTransport &node);
+
+  mutable std::mutex mutex_;
+  SimMediumConfig config_;
+  std::mt19937 rng_;
+  std::vector<SimTransport *> nodes_;
+  std::vector<Transmission> active_;
+  uint64_t next_id_ = 1;
+  SimMediumStats stats_;
+};
+
+// RadioTransport attached to a SimMedium. Positions are in metres.
+class SimTransport : public RadioTransport {
+public:
+  explicit SimTransport(SimMedium &medium, double x = 0.0, double y = 0.0);
+  ~SimTransport() override;
+
+  SimTransport(const SimTransport &) = delete;
+  SimTransport &operator=(const SimTransport &) = delete;
+
+  void setPosition(double x, double y);
+
+  bool begin() override;
+
+  void setChannel(uint8_t channel) override;
+  void setDataRate(RadioDataRate rate) override;
+  void setPowerLevel(RadioPowerLevel level) override;
+  void setRetries(uint8_t delay, uint8_t count) override;
+  void setAutoAck(bool enable) override;
+  void enableDynamicPayloads() override;
+  void enableAckPayload() override;
+  void enableDynamicAck() override;
+
+  void openWritingPipe(uint64_t address) override;
+  void openReadingPipe(uint8_t pipe, uint64_t address) override;
+  void closeReadingPipe(uint8_t pipe) override;
+  void startListening() override;
+  void stopListening() override;
+
+  bool write(const void *data, uint8_t size, bool multicast) override;
+  bool writeAckPayload(uint8_t pipe, const void *data, uint8_t size) override;
+  void flushAckPayloads() override;
+
+  bool available(uint8_t *pipe = nullptr) override;
+  uint8_t getDynamicPayloadSize() override;
+  void read(void *data, uint8_t size) override;
+
+  bool testRPD() override;
+  uint8_t getARC() override;
+  int interruptFd() override;
+  uint64_t rxArrivalUs() override;
+
+private:
+  friend class SimMedium;
+  using Clock = std::chrono::steady_clock;
+
+  struct Frame {
+    std::array<uint8_t, RADIO_MAX_PAYLOAD> data{};
+    uint8_t size = 0;
+    uint8_t pipe = 0;
+    Clock::time_point ready;
+  };
+
+  static constexpr size_t RX_FIFO_DEPTH = 3;
+  static constexpr size_t TX_FIFO_DEPTH = 3;
+
+  // State below is guarded by medium_.mutex_.
+  SimMedium &medium_;
+  double x_;
+  double y_;
+  uint8_t channel_ = 76;
+  RadioDataRate rate_ = RadioDataRate::MEDIUM_RATE;
+  RadioPowerLevel power_ = RadioPowerLevel::MAX_POWER;
+  bool auto_ack_ = true;
+  bool listening_ = false;
+  uint8_t retry_delay_ = 5; // RF24::begin() defaults
+  uint8_t retry_count_ = 15;
+  uint64_t tx_address_ = 0;
+  std::array<std::optional<uint64_t>, 6> rx_pipes_{};
+  std::deque<Frame> rx_fifo_;
+  std::deque<Frame> ack_payloads_; // `pipe` is the pipe they answer on
+  bool rpd_ = false;
+  uint8_t arc_ = 0;
+  int irq_fd_ = -1; // eventfd raised on every delivered frame
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "radio.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// ==================== Channel Plan ==================== //
+//
+// Drones join on JOIN_CHANNEL. The ground station surveys the band with
+// RPD sweeps, picks a quiet operational channel and hands it out in
+// JoinResponsePacket::assigned_channel, so neighbouring swarms and Wi-Fi
+// networks end up on different frequencies.
+
+constexpr uint8_t JOIN_CHANNEL = 1;
+constexpr size_t RADIO_CHANNELS = 126; // 2400-2525 MHz, 1 MHz steps
+
+// Per-channel carrier hits over a number of sweeps.
+struct SpectrumSurvey {
+  std::array<uint16_t, RADIO_CHANNELS> hits{};
+  uint16_t sweeps = 0;
+
+  // Fraction of sweeps that saw a carrier on `channel`.
+  float occupancy(uint8_t channel) const {
+    return sweeps && channel < RADIO_CHANNELS
+               ? static_cast<float>(hits[channel]) / sweeps
+               : 0.0f;
+  }
+};
+
+// Sweeps every channel `sweeps` times with `dwell` of listening each
+// (about 126 * dwell per sweep) and restores the radio's channel.
+// Interleaving sweeps rather than dwelling long on one channel samples
+// bursty traffic at many points in time.
+SpectrumSurvey surveySpectrum(RadioInterface &radio, uint16_t sweeps = 20,
+                              std::chrono::microseconds dwell =
+                                  std::chrono::microseconds(200));
+
+struct ChannelSelectConfig {
+  // Candidates; channels above 83 lie outside the 2.4 GHz ISM band.
+  uint8_t first = 2;
+  uint8_t last = 83;
+  // Neighbours on each side that count against a candidate. At 2 Mbps a
+  // frame is 2 MHz wide.
+  uint8_t guard = 1;
+  // Channels this close to JOIN_CHANNEL are skipped.
+  uint8_t join_spacing = 3;
+};
+
+// Quietest candidate, scored by the busiest channel within its guard band.
+// Ties are broken by `salt` (e.g. the ground station id) so swarms that
+// survey an empty band do not all pick the same channel.
+uint8_t selectChannel(const SpectrumSurvey &survey,
+                      const ChannelSelectConfig &config = {},
+                      uint32_t salt = 0);
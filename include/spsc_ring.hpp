@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free single-producer/single-consumer ring.
+//
+// The producer can fill a slot in place (acquire() + publish()) and the
+// consumer can process it in place (front() + pop()), so an element is
+// written once and never copied through the ring. N must be a power of two.
+template <typename T, size_t N> class SpscRing {
+  static_assert(N > 1 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  // ---- producer side ----
+
+  // Free slot to fill, or nullptr when the ring is full.
+  T *acquire() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == N) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ == N)
+        return nullptr;
+    }
+    return &slots_[tail & (N - 1)];
+  }
+
+  // Makes the slot returned by acquire() visible to the consumer.
+  void publish() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  bool push(const T &item) {
+    T *slot = acquire();
+    if (!slot)
+      return false;
+    *slot = item;
+    publish();
+    return true;
+  }
+
+  // ---- consumer side ----
+
+  // Oldest element, or nullptr when the ring is empty.
+  const T *front() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_)
+        return nullptr;
+    }
+    return &slots_[head & (N - 1)];
+  }
+
+  // i-th oldest element (0 is front()), or nullptr if fewer are queued.
+  // The consumer may modify it in place until it is popped.
+  T *peek(size_t i) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (tail_cache_ - head <= i) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (tail_cache_ - head <= i)
+        return nullptr;
+    }
+    return &slots_[(head + i) & (N - 1)];
+  }
+
+  void pop() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  bool pop(T &out) {
+    const T *item = front();
+    if (!item)
+      return false;
+    out = *item;
+    pop();
+    return true;
+  }
+
+  // ---- either side (approximate while the other side runs) ----
+
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  // Indices grow monotonically; each side caches the other's index so the
+  // shared cache line is only touched when the ring looks full/empty.
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_ = 0; // consumer's view of tail_
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_ = 0; // producer's view of head_
+  alignas(64) std::array<T, N> slots_{};
+};
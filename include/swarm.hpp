@@ -0,0 +1,27 @@
+#pragma once
+
+#include "drone.hpp"
+#include "radio.hpp"
+#include "sensor_sampler.hpp"
+#include "spectrum.hpp"
+#include "swarm_address.hpp"
+#include <atomic>
+#include <vector>
+
+// Beacons as the leader sent them, for measurements that must not depend
+// on which of them a listener happened to hear.
+struct LeaderLoopStats {
+  std::atomic<uint64_t> superframes{0};
+  std::atomic<uint64_t> slots{0};
+};
+
+// Role loops shared by the flight binary and the swarm simulator. Both
+// return when the drone's role changes or, if given, `stop` becomes true.
+// Without a sampler the follower sends synthetic IMU values.
+void leaderLoop(RadioInterface &radio, Drone &drone,
+                const std::vector<DroneIdType> &swarm,
+                const std::atomic<bool> *stop = nullptr,
+                LeaderLoopStats *stats = nullptr);
+void followerLoop(RadioInterface &radio, Drone &drone,
+                  const SensorSampler *sensors,
+                  const std::atomic<bool> *stop = nullptr);
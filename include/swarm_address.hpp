@@ -0,0 +1,46 @@
+#pragma once
+
+#include "packets.hpp"
+#include <cstdint>
+
+// ==================== Swarm Addressing ==================== //
+//
+// Reading pipes 2-5 of the nRF24 only hold the low address byte and share
+// the upper four bytes with pipe 1, so every swarm address lives under one
+// prefix and the low byte selects the receiver:
+//
+//   pipe 1  BASE_RX          every drone (beacons, announcements)
+//   pipe 2  LEADER_TX        leader only, follower telemetry
+//   pipe 3  unicast          one drone, byte = network id (0x01-0xBF)
+//   pipe 4  group            drones of one group, byte 0xF0 + group
+//
+// Frames to another drone's unicast or group address are dropped by the
+// radio (no IRQ, no SPI read, no ACK). Pipe 5 is left free.
+
+constexpr uint64_t SWARM_ADDRESS_PREFIX = 0xF0F0F0F000ULL;
+
+// Drones transmit towards BASE_TX (ground station) and listen on BASE_RX.
+constexpr uint64_t BASE_TX = SWARM_ADDRESS_PREFIX | 0xD2;
+constexpr uint64_t BASE_RX = SWARM_ADDRESS_PREFIX | 0xE1;
+// Followers send telemetry to the leader, which listens on pipe 2.
+constexpr uint64_t LEADER_TX = SWARM_ADDRESS_PREFIX | 0xC3;
+constexpr uint8_t LEADER_PIPE = 2;
+
+constexpr uint8_t UNICAST_PIPE = 3;
+constexpr uint8_t GROUP_PIPE = 4;
+constexpr uint8_t UNICAST_MAX_ID = 0xBF;
+constexpr uint8_t GROUP_BASE = 0xF0;
+constexpr uint8_t GROUP_COUNT = 15; // 0xF0-0xFE
+
+constexpr uint64_t swarmAddress(uint8_t low_byte) {
+  return SWARM_ADDRESS_PREFIX | low_byte;
+}
+
+// Address byte of a drone's unicast pipe, 0 if the id has none.
+constexpr uint8_t unicastAddressByte(DroneIdType id) {
+  return id >= 1 && id <= UNICAST_MAX_ID ? id : 0;
+}
+
+constexpr uint8_t groupAddressByte(uint8_t group) {
+  return group < GROUP_COUNT ? static_cast<uint8_t>(GROUP_BASE + group) : 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "timebase.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// ==================== Swarm Time Base ==================== //
+//
+// Swarm time is a microsecond clock shared by the swarm. The leader is the
+// reference for its followers and syncs itself to the ground station when
+// one answers. Packet `timestamp` fields carry the low 32 bits of swarm
+// time; compare them with swarmAge(), which handles the wrap (~71 min).
+//
+// Followers run an NTP-style exchange with the reference:
+//
+//   t1 request sent (local)     t2 request received (reference)
+//   t4 response received (local)  t3 response sent (reference)
+//
+//   offset = ((t2 - t1) + (t3 - t4)) / 2,  delay = (t4 - t1) - (t3 - t2)
+//
+// The last SWARM_CLOCK_WINDOW samples are kept and offset and drift come
+// from a least-squares fit weighted towards the samples with the smallest
+// delay. A sample further than SWARM_CLOCK_STEP_US from the estimate means
+// the reference stepped and restarts the window.
+
+constexpr size_t SWARM_CLOCK_WINDOW = 8;
+constexpr int32_t SWARM_CLOCK_MAX_DRIFT_PPM = 500;
+constexpr double SWARM_CLOCK_STEP_US = 5000.0;
+
+// Signed age of a 32-bit swarm timestamp relative to `now`.
+inline int32_t swarmAge(uint32_t now, uint32_t timestamp) {
+  return static_cast<int32_t>(now - timestamp);
+}
+
+class SwarmClock {
+public:
+  // Local time in microseconds, monotonicMicros() plus the simulated
+  // oscillator error set with setLocalModel().
+  uint64_t localMicros() const { return fromMonotonic(monotonicMicros()); }
+  uint64_t fromMonotonic(uint64_t mono_us) const;
+
+  uint64_t toSwarm(uint64_t local_us) const;
+  uint64_t now() const { return toSwarm(localMicros()); }
+  uint32_t now32() const { return static_cast<uint32_t>(now()); }
+
+  // Adds one exchange; t1/t4 are local, t2/t3 reference swarm time.
+  // Returns false if the sample is inconsistent and was dropped.
+  bool addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+  bool synced() const;
+  size_t samples() const;
+
+  int64_t offsetUs() const;
+  double driftPpm() const;
+  int64_t delayUs() const; // round trip of the best sample
+
+  // Simulated oscillator error for tests on one host: local time becomes
+  // mono * (1 + drift_ppm / 1e6) + offset_us.
+  void setLocalModel(int64_t offset_us, double drift_ppm);
+  void reset();
+
+private:
+  struct Sample {
+    uint64_t local_us; // midpoint of t1 and t4
+    int64_t offset_us;
+    int64_t delay_us;
+  };
+
+  void updateEstimate();
+
+  mutable std::mutex mutex_;
+  std::array<Sample, SWARM_CLOCK_WINDOW> window_{};
+  size_t count_ = 0;
+  size_t next_ = 0;
+  // swarm = local + offset_ + drift_ * (local - anchor_)
+  uint64_t anchor_ = 0;
+  int64_t offset_ = 0;
+  double drift_ = 0.0;
+  int64_t delay_ = 0;
+
+  int64_t model_offset_ = 0;
+  double model_drift_ = 0.0;
+};
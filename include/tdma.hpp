@@ -0,0 +1,72 @@
+#pragma once
+
+#include "packets.hpp"
+#include "transport.hpp"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// ==================== TDMA Superframes ==================== //
+//
+// The leader opens every superframe with a multicast BeaconPacket:
+//
+//   | beacon | offset | slot 0 | slot 1 | ... | slot n-1 | leader period |
+//
+// Each follower listed in the beacon transmits its telemetry in its own
+// slot without waiting for a PermissionToSend. The leader period is used
+// for the ground station exchange. Slots share the target superframe
+// length and shrink as the swarm grows, down to the time one telemetry
+// exchange (with a retransmission) needs; beyond that the superframe
+// grows instead. Swarms larger than MAX_TDMA_SLOTS are served round-robin
+// over consecutive superframes.
+
+struct TdmaConfig {
+  uint32_t superframe_us = 100000;
+  // Margin for beacon delivery latency and scheduling jitter.
+  uint32_t guard_us = 1000;
+  // Ground station exchange at the end of each superframe.
+  uint32_t leader_us = 10000;
+  uint32_t max_slot_us = 20000;
+  RadioDataRate rate = RadioDataRate::MEDIUM_RATE;
+};
+
+struct TdmaSlot {
+  uint64_t start_us; // monotonicMicros() time
+  uint32_t length_us;
+};
+
+class TdmaScheduler {
+public:
+  explicit TdmaScheduler(TdmaConfig config = {});
+
+  void setMembers(std::vector<DroneIdType> members);
+  const std::vector<DroneIdType> &members() const { return members_; }
+  const TdmaConfig &config() const { return config_; }
+
+  BeaconPacket nextBeacon(DroneIdType leader_id, uint32_t timestamp);
+
+  // One 32 byte telemetry frame and its ACK, twice, plus the guard. The
+  // first ACK may carry a downlink command.
+  uint32_t minSlotUs() const;
+  uint32_t slotLength(size_t slot_count) const;
+
+  // Offsets from the end of the beacon.
+  static uint32_t slotsEndUs(const BeaconPacket &beacon);
+  uint32_t superframeUs(const BeaconPacket &beacon) const;
+
+private:
+  TdmaConfig config_;
+  std::vector<DroneIdType> members_;
+  size_t next_member_ = 0;
+  uint16_t superframe_ = 0;
+};
+
+// Exchange time of one frame of `payload` bytes with its ACK, including
+// the RX/TX turnarounds. `ack_payload` bytes may ride on the ACK.
+uint32_t tdmaExchangeUs(size_t payload, RadioDataRate rate,
+                        size_t ack_payload = 0);
+
+// Follower side: the slot `self` owns in a beacon received at
+// `beacon_rx_us`, if it was scheduled.
+std::optional<TdmaSlot> tdmaSlotFor(const BeaconPacket &beacon,
+                                    DroneIdType self, uint64_t beacon_rx_us);
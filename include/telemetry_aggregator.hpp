@@ -0,0 +1,32 @@
+#pragma once
+
+#include "packets.hpp"
+#include <cstddef>
+#include <vector>
+
+// ==================== Telemetry Aggregation ==================== //
+//
+// Followers send their telemetry to the leader during their TDMA slots. The
+// leader keeps the latest sample of each follower and forwards them to the
+// ground station MAX_AGGREGATE_ENTRIES at a time in the leader period, so
+// relaying N followers costs ceil(N / 4) uplink frames instead of N.
+
+class TelemetryAggregator {
+public:
+  // Queues a follower sample; a newer sample replaces a pending one.
+  void add(const TelemetryPacket &tlm);
+  size_t pending() const { return pending_.size(); }
+  void clear() { pending_.clear(); }
+
+  // Moves up to MAX_AGGREGATE_ENTRIES pending samples into `out`. Returns
+  // false if nothing was pending.
+  bool nextFrame(DroneIdType leader_id, AggregateTelemetryPacket &out);
+
+private:
+  std::vector<AggregateTelemetryEntry> pending_;
+  uint8_t sequence_ = 0;
+};
+
+AggregateTelemetryEntry packTelemetry(const TelemetryPacket &tlm);
+// Only the IMU fields and drone_id are restored.
+TelemetryPacket unpackTelemetry(const AggregateTelemetryEntry &entry);
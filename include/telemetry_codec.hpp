@@ -0,0 +1,96 @@
+#pragma once
+
+#include "packets.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// ==================== Telemetry Codec ==================== //
+//
+// Packs consecutive TelemetryPackets of one drone into
+// CompressedTelemetryPacket frames:
+//
+//  - floats are quantised to fixed point (battery 10 mV, altitude 1 cm,
+//    link quality 0.5 %),
+//  - every field is sent as a zig-zag varint delta; the first sample of a
+//    frame is coded against the last acknowledged sample, the following
+//    ones against their predecessor in the same frame,
+//  - slow fields (timestamp, battery, altitude, link quality, rpd/retries)
+//    are only sent when they changed, flagged by one mask byte per sample,
+//  - a keyframe carries its first sample in fixed-width form; it is sent
+//    when nothing was acknowledged yet, the reference fell out of the
+//    decoder history, a delta does not fit, or every `keyframe_interval`
+//    samples.
+//
+// The encoder is told about delivered frames through acknowledge(), e.g.
+// after an auto-ACKed write. The decoder keeps the last
+// TELEMETRY_CODEC_HISTORY samples so frames coded against an older
+// reference still decode after a lost acknowledgement.
+
+constexpr size_t TELEMETRY_CODEC_HISTORY = 16;
+
+// Fixed-point form of a TelemetryPacket; deltas are taken on these values.
+struct QuantisedTelemetry {
+  uint32_t timestamp = 0;
+  int32_t imu[6] = {}; // ax, ay, az, gx, gy, gz
+  int32_t battery_10mv = 0;
+  int32_t altitude_cm = 0;
+  int32_t link_quality_half = 0; // 0-200
+  int32_t status = 0;            // rpd | retries << 1
+};
+
+QuantisedTelemetry quantiseTelemetry(const TelemetryPacket &tlm);
+TelemetryPacket dequantiseTelemetry(const QuantisedTelemetry &q,
+                                    DroneIdType drone_id);
+
+class TelemetryEncoder {
+public:
+  explicit TelemetryEncoder(DroneIdType drone_id,
+                            uint8_t keyframe_interval = 64);
+
+  // Adds a sample to the current frame. Returns false if it does not fit;
+  // take the frame and push the sample again.
+  bool push(const TelemetryPacket &tlm);
+  bool empty() const { return count_ == 0; }
+
+  // Finishes the current frame and starts a new one.
+  CompressedTelemetryPacket takeFrame();
+
+  // The receiver has `frame`: its last sample becomes the new reference.
+  void acknowledge(const CompressedTelemetryPacket &frame);
+
+  void reset();
+
+private:
+  bool needKeyframe() const;
+
+  DroneIdType drone_id_;
+  uint8_t keyframe_interval_;
+  uint8_t next_sequence_ = 0;
+  CompressedTelemetryPacket frame_{};
+  uint8_t count_ = 0;
+  uint8_t used_ = 0; // payload bytes in frame_
+  QuantisedTelemetry previous_; // last sample pushed into frame_
+  uint8_t since_keyframe_ = 0;
+  // Last sample of each frame still waiting for its ACK, by sequence.
+  std::array<QuantisedTelemetry, TELEMETRY_CODEC_HISTORY> sent_{};
+  std::array<std::optional<uint8_t>, TELEMETRY_CODEC_HISTORY> sent_seq_{};
+  std::optional<uint8_t> reference_;
+  QuantisedTelemetry reference_sample_;
+};
+
+class TelemetryDecoder {
+public:
+  // Decodes up to `max` samples of `frame` into `out`. Returns the number of
+  // samples decoded; 0 if the frame is malformed or its reference is not in
+  // the history.
+  size_t decode(const CompressedTelemetryPacket &frame, TelemetryPacket *out,
+                size_t max);
+
+  void reset();
+
+private:
+  std::array<QuantisedTelemetry, TELEMETRY_CODEC_HISTORY> history_{};
+  std::array<std::optional<uint8_t>, TELEMETRY_CODEC_HISTORY> history_seq_{};
+};
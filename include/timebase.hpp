@@ -0,0 +1,12 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Local monotonic time in microseconds (steady_clock epoch).
+inline uint64_t monotonicMicros() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
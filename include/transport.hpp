@@ -0,0 +1,133 @@
+#pragma once
+
+#include "timebase.hpp"
+#include <cstddef>
+#include <cstdint>
+
+enum class RadioDataRate {
+  LOW_RATE,
+  MEDIUM_RATE,
+  HIGH_RATE,
+};
+
+enum class RadioPowerLevel {
+  MIN_POWER,
+  LOW_POWER,
+  HIGH_POWER,
+  MAX_POWER,
+};
+
+// One frame of a pipelined burst (RadioTransport::writeBurst). The result
+// fields are filled in by the transport.
+struct TxBurstFrame {
+  const void *data = nullptr;
+  uint8_t size = 0;
+  bool multicast = false;
+  bool success = false;
+  uint8_t arc = 0; // retransmissions this frame needed, or TX_ARC_UNKNOWN
+  uint64_t start_us = 0; // monotonic time the frame was put on the air
+};
+
+// ARC value of a burst frame whose retransmission count could not be read
+// back, e.g. because the next frame had already started when it completed.
+constexpr uint8_t TX_ARC_UNKNOWN = 0xFF;
+
+// Low level nRF24L01+ style transceiver used by RadioInterface.
+//
+// The method set mirrors the subset of the RF24 driver that the project
+// relies on so that the hardware backend is a thin forwarding layer and
+// other backends (the in-process simulator, replay fakes) can stand in for
+// a real module without touching the protocol code.
+class RadioTransport {
+public:
+  virtual ~RadioTransport() = default;
+
+  virtual bool begin() = 0;
+
+  virtual void setChannel(uint8_t channel) = 0;
+  virtual void setDataRate(RadioDataRate rate) = 0;
+  virtual void setPowerLevel(RadioPowerLevel level) = 0;
+  // Auto retransmit delay ((delay + 1) * 250 us) and count (0-15).
+  virtual void setRetries(uint8_t delay, uint8_t count) = 0;
+  virtual void setAutoAck(bool enable) = 0;
+  virtual void enableDynamicPayloads() = 0;
+  virtual void enableAckPayload() = 0;
+  // Allows per-frame no-ack writes (multicast).
+  virtual void enableDynamicAck() = 0;
+
+  virtual void openWritingPipe(uint64_t address) = 0;
+  virtual void openReadingPipe(uint8_t pipe, uint64_t address) = 0;
+  virtual void closeReadingPipe(uint8_t pipe) = 0;
+  virtual void startListening() = 0;
+  virtual void stopListening() = 0;
+
+  // Blocking transmit; returns true once the frame was acknowledged (or
+  // sent, when auto-ack is disabled or `multicast` requests no ACK).
+  virtual bool write(const void *data, uint8_t size, bool multicast) = 0;
+
+  // Writes `count` frames to the open writing pipe back to back and
+  // reports success and ARC per frame. The caller has already left RX
+  // mode. A module with a TX FIFO keeps it filled, so the next frame is
+  // uploaded while the previous one is on air; the default writes them
+  // one by one.
+  virtual void writeBurst(TxBurstFrame *frames, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      frames[i].start_us = monotonicMicros();
+      frames[i].success =
+          write(frames[i].data, frames[i].size, frames[i].multicast);
+      frames[i].arc = getARC();
+    }
+  }
+
+  // Preloads a payload sent back with the ACK of the next frame received on
+  // `pipe` (at most three are held, shared with the TX FIFO). On the
+  // sender it arrives as an ordinary frame on pipe 0 once write() returns.
+  virtual bool writeAckPayload(uint8_t pipe, const void *data,
+                               uint8_t size) = 0;
+  // Drops preloaded ACK payloads (flushes the TX FIFO).
+  virtual void flushAckPayloads() = 0;
+
+  virtual bool available(uint8_t *pipe = nullptr) = 0;
+  virtual uint8_t getDynamicPayloadSize() = 0;
+  virtual void read(void *data, uint8_t size) = 0;
+
+  // Received Power Detector: true if a carrier above -64 dBm was seen
+  // during the last reception.
+  virtual bool testRPD() = 0;
+  // Auto retransmit count of the last transmission.
+  virtual uint8_t getARC() = 0;
+
+  // Descriptor that becomes readable when the module raises its RX
+  // interrupt, or -1 if the IRQ pin has to be watched through GPIO.
+  virtual int interruptFd() { return -1; }
+
+  // Arrival time (monotonicMicros) of the frame the next read() returns, or
+  // 0 if the transport cannot tell; the frame is then stamped when read.
+  virtual uint64_t rxArrivalUs() { return 0; }
+};
+
+constexpr size_t RADIO_MAX_PAYLOAD = 32;
+
+// Time in microseconds a frame with `payload` bytes occupies the air:
+// preamble, 5 byte address, 9 bit packet control field, payload and a
+// 2 byte CRC.
+inline uint32_t frameAirtimeUs(size_t payload, RadioDataRate rate) {
+  const uint32_t bits = static_cast<uint32_t>(8 * (1 + 5 + payload + 2) + 9);
+  switch (rate) {
+  case RadioDataRate::LOW_RATE:
+    return bits * 4;
+  case RadioDataRate::HIGH_RATE:
+    return (bits + 1) / 2;
+  case RadioDataRate::MEDIUM_RATE:
+  default:
+    return bits;
+  }
+}
+
+// PLL settling time when switching between RX and TX (tpd2stby + tstby2a).
+constexpr uint32_t RADIO_TX_SETTLE_US = 130;
+
+// From a write() call to the last bit of the frame on air.
+inline uint32_t frameTxLeadUs(size_t payload, RadioDataRate rate) {
+  return RADIO_TX_SETTLE_US + frameAirtimeUs(payload, rate);
+}
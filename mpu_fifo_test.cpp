@@ -0,0 +1,73 @@
+#include "./include/mpu6050.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+// Compares the per-sample cost of the MPU6050 read paths on real hardware:
+// separate accel + gyro reads, one 14-byte burst, and FIFO draining at
+// 1 kHz.
+
+static double usSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main() {
+  Mpu6050 sensor;
+  if (!sensor.init()) {
+    std::cerr << "Failed to init MPU6050" << std::endl;
+    return 1;
+  }
+
+  constexpr int N = 500;
+  int16_t ax, ay, az, gx, gy, gz;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    if (!sensor.readAcceleration(ax, ay, az) || !sensor.readGyro(gx, gy, gz)) {
+      std::cerr << "Split read failed" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "accel + gyro reads : " << usSince(start) / N << " us/sample"
+            << std::endl;
+
+  ImuSample s;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    if (!sensor.readSample(s)) {
+      std::cerr << "Burst read failed" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "14-byte burst read : " << usSince(start) / N << " us/sample"
+            << std::endl;
+
+  if (!sensor.enableFifo(1000)) {
+    std::cerr << "Failed to enable FIFO" << std::endl;
+    return 1;
+  }
+  ImuSample batch[MPU6050_FIFO_BYTES / MPU6050_SAMPLE_BYTES];
+  int samples = 0;
+  double busy_us = 0.0;
+  const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    start = std::chrono::steady_clock::now();
+    const int n = sensor.readFifo(batch, std::size(batch));
+    busy_us += usSince(start);
+    if (n < 0) {
+      std::cerr << "FIFO read failed" << std::endl;
+      return 1;
+    }
+    samples += n;
+  }
+  std::cout << "FIFO @ " << sensor.sampleRateHz() << " Hz    : " << samples
+            << " samples in 1 s, "
+            << (samples ? busy_us / samples : 0.0) << " us/sample, "
+            << sensor.fifoOverflows() << " overflows" << std::endl;
+  sensor.disableFifo();
+  return 0;
+}
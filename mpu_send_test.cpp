@@ -1,9 +1,9 @@
 #include "mpu6050.hpp"
 #include "packets.hpp"
 #include "radio.hpp"
+#include "timebase.hpp"
 #include <chrono>
 #include <cstring>
-#include <ctime>
 #include <iostream>
 #include <thread>
 
@@ -32,24 +32,18 @@ int main() {
   radio.setAddress(GBS_ADDR_TX, GBS_ADDR_RX);
 
   for (int i = 0; i < 10; ++i) {
-    int16_t ax = 0, ay = 0, az = 0;
-    int16_t gx = 0, gy = 0, gz = 0;
-    bool ok =
-        sensor.readAcceleration(ax, ay, az) && sensor.readGyro(gx, gy, gz);
-    if (!ok) {
-      ax = ay = az = 0;
-      gx = gy = gz = 0;
-    }
+    ImuSample s{}; // stays zero if the read fails
+    sensor.readSample(s);
 
     TelemetryPacket pkt{};
     pkt.drone_id = 1;
-    pkt.timestamp = static_cast<uint32_t>(std::time(nullptr));
-    pkt.acceleration_x = ax;
-    pkt.acceleration_y = ay;
-    pkt.acceleration_z = az;
-    pkt.gyroscope_x = gx;
-    pkt.gyroscope_y = gy;
-    pkt.gyroscope_z = gz;
+    pkt.timestamp = static_cast<uint32_t>(monotonicMicros());
+    pkt.acceleration_x = s.accel[0];
+    pkt.acceleration_y = s.accel[1];
+    pkt.acceleration_z = s.accel[2];
+    pkt.gyroscope_x = s.gyro[0];
+    pkt.gyroscope_y = s.gyro[1];
+    pkt.gyroscope_z = s.gyro[2];
     pkt.battery_voltage = 3.3f;
     pkt.rpd = radio.testRPD() ? 1 : 0;
     pkt.retries = 0;
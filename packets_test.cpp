@@ -1,11 +1,11 @@
 #include "radio.hpp"
+#include "packet_traits.hpp"
 #include "packets.hpp"
 #include <chrono>
 #include <cstring>
 #include <iostream>
 #include <thread>
 #include <vector>
-#include <array>
 
 // Pin definitions for a single device that has separate TX and RX modules
 // Only the Drone_A pins are used in this test. They should match your wiring.
@@ -16,88 +16,50 @@
 
 static constexpr uint64_t ADDR_A_TX = 0xF0F0F0F0AAULL;
 
-static size_t packetSize(PacketType t) {
-  switch (t) {
-  case PacketType::COMMAND:
-    return sizeof(CommandPacket);
-  case PacketType::TELEMETRY:
-    return sizeof(TelemetryPacket);
-  case PacketType::JOIN_REQUEST:
-    return sizeof(JoinRequestPacket);
-  case PacketType::JOIN_RESPONSE:
-    return sizeof(JoinResponsePacket);
-  case PacketType::HEARTBEAT:
-    return sizeof(HeartbeatPacket);
-  case PacketType::LEADER_ANNOUNCEMENT:
-    return sizeof(LeaderAnnouncementPacket);
-  case PacketType::PERMISSION_TO_SEND:
-    return sizeof(PermissionToSendPacket);
-  case PacketType::LEADER_REQUEST:
-    return sizeof(LeaderRequestPacket);
-  default:
-    return sizeof(PacketType);
-  }
-}
-
-static void handlePacket(PacketType t, const std::array<uint8_t, 32>& buf) {
-  switch (t) {
-  case PacketType::COMMAND: {
-    CommandPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+// Prints every packet type through the same compile-time dispatcher the
+// drone uses, so a type missing from the registry shows up here.
+struct PacketPrinter {
+  void operator()(const CommandPacket& pkt) {
     std::cout << "CMD -> " << pkt.command << "\n";
-    break;
   }
-  case PacketType::TELEMETRY: {
-    TelemetryPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const TelemetryPacket& pkt) {
     std::cout << "TLM -> id " << static_cast<int>(pkt.drone_id) << " alt "
               << pkt.altitude << "\n";
-    break;
   }
-  case PacketType::JOIN_REQUEST: {
-    JoinRequestPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const JoinRequestPacket& pkt) {
     std::cout << "JOIN_REQ -> temp " << static_cast<int>(pkt.temp_id) << "\n";
-    break;
   }
-  case PacketType::JOIN_RESPONSE: {
-    JoinResponsePacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const JoinResponsePacket& pkt) {
     std::cout << "JOIN_RESP -> assigned " << static_cast<int>(pkt.assigned_id)
-              << "\n";
-    break;
+              << " unicast 0x" << std::hex
+              << static_cast<int>(pkt.unicast_address) << std::dec << "\n";
   }
-  case PacketType::HEARTBEAT: {
-    HeartbeatPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const HeartbeatPacket& pkt) {
     std::cout << "HEARTBEAT -> src " << static_cast<int>(pkt.source_drone_id)
               << "\n";
-    break;
   }
-  case PacketType::LEADER_ANNOUNCEMENT: {
-    LeaderAnnouncementPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const LeaderAnnouncementPacket& pkt) {
     std::cout << "LEADER_ANNOUNCE -> new " << static_cast<int>(pkt.new_leader_id)
               << "\n";
-    break;
   }
-  case PacketType::PERMISSION_TO_SEND: {
-    PermissionToSendPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const PermissionToSendPacket& pkt) {
     std::cout << "PERMISSION -> target " << static_cast<int>(pkt.target_drone_id)
               << "\n";
-    break;
   }
-  case PacketType::LEADER_REQUEST: {
-    LeaderRequestPacket pkt{};
-    std::memcpy(&pkt, buf.data(), sizeof(pkt));
+  void operator()(const LeaderRequestPacket& pkt) {
     std::cout << "LEADER_REQ -> id " << static_cast<int>(pkt.drone_id) << "\n";
-    break;
   }
-  case PacketType::UNDEFINED:
+};
+
+static void handlePacket(const RadioFrame& frame) {
+  PacketPrinter printer;
+  if (dispatchPacket(printer, frame.data.data(), frame.size))
+    return;
+  if (frame.type() == PacketType::UNDEFINED)
     std::cout << "UNDEFINED" << std::endl;
-    break;
-  }
+  else
+    std::cout << "MALFORMED type " << static_cast<int>(frame.type()) << " size "
+              << static_cast<int>(frame.size) << std::endl;
 }
 
 static void sender(RadioInterface& radio) {
@@ -121,6 +83,8 @@ static void sender(RadioInterface& radio) {
   jresp.current_leader_id = 1;
   jresp.assigned_channel = 90;
   jresp.timestamp = 4;
+  jresp.unicast_address = 4;
+  jresp.group_address = 0xF0;
 
   HeartbeatPacket hb{};
   hb.source_drone_id = 5;
@@ -155,14 +119,12 @@ static void sender(RadioInterface& radio) {
 static void receiver(RadioInterface& radio, size_t expected) {
   size_t count = 0;
   while (count < expected) {
-    PacketType peek;
-    if (!radio.receive(&peek, sizeof(peek), true)) {
+    RadioFrame frame;
+    if (!radio.receive(frame)) {
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
       continue;
     }
-    std::array<uint8_t, 32> buf{};
-    radio.receive(buf.data(), packetSize(peek));
-    handlePacket(peek, buf);
+    handlePacket(frame);
     ++count;
   }
 }
@@ -1,22 +1,31 @@
 #include "../include/drone.hpp"
+#include "../include/metrics.hpp"
+#include "../include/packet_traits.hpp"
 #include "../include/packets.hpp"
 #include <cstdlib>
-#include <cstring>
 #include <ctime>
-#include <queue>
-#include <array>
+#include <random>
 
 Drone::Drone(RadioInterface &radio_ref, bool is_leader_init,
              const std::string &initial_name)
     : radio(radio_ref), is_leader_(is_leader_init), name_(initial_name) {
   std::srand(static_cast<unsigned int>(std::time(nullptr)));
   temp_id_ = static_cast<DroneIdType>(std::rand() % 200 + 1); // 1–200 arası
+  // Aynı saniyede açılan drone'lar aynı temp_id'yi alır; nonce ayırır
+  std::random_device entropy;
+  while (join_nonce_ == 0)
+    join_nonce_ = entropy();
   telemetry = TelemetryPacket{}; // güvenli sıfırlama
-  rx_queue_ = {};
 }
 
 DroneIdType Drone::getTempId() const { return temp_id_; }
 
+uint32_t Drone::getJoinNonce() const { return join_nonce_; }
+
+bool Drone::isMyJoinResponse(const JoinResponsePacket &resp) const {
+  return resp.temp_id == temp_id_ && resp.nonce == join_nonce_;
+}
+
 std::optional<DroneIdType> Drone::getNetworkId() const { return network_id_; }
 
 bool Drone::isLeader() const { return is_leader_; }
@@ -39,6 +48,46 @@ void Drone::setNetworkId(DroneIdType net_id) { network_id_ = net_id; }
 
 void Drone::clearNetworkId() { network_id_ = std::nullopt; }
 
+void Drone::applyJoinResponse(const JoinResponsePacket &resp) {
+  join_offset_ = resp.timestamp - static_cast<uint32_t>(clock_.localMicros());
+  setNetworkId(resp.assigned_id);
+  setAddressing(resp.unicast_address, resp.group_address);
+  setCurrentLeaderId(resp.current_leader_id);
+  const bool was_leader = is_leader_;
+  is_leader_ = resp.current_leader_id == resp.assigned_id;
+  if (was_leader != is_leader_)
+    role_changed_ = true;
+}
+
+void Drone::setAddressing(uint8_t unicast_address, uint8_t group_address) {
+  unicast_address_ = unicast_address;
+  group_address_ = group_address;
+  if (unicast_address_)
+    radio.openListeningPipe(UNICAST_PIPE, swarmAddress(unicast_address_));
+  else
+    radio.closeListeningPipe(UNICAST_PIPE);
+  if (group_address_)
+    radio.openListeningPipe(GROUP_PIPE, swarmAddress(group_address_));
+  else
+    radio.closeListeningPipe(GROUP_PIPE);
+}
+
+uint64_t Drone::rxFrames(uint8_t pipe) const {
+  return pipe < rx_frames_.size() ? rx_frames_[pipe] : 0;
+}
+
+bool Drone::isForMe(DroneIdType target) {
+  if (target == network_id_.value_or(temp_id_))
+    return true;
+  foreign_frames_++;
+  return false;
+}
+
+uint64_t Drone::addressOf(DroneIdType target, uint64_t fallback) const {
+  const uint8_t low = unicastAddressByte(target);
+  return unicast_address_ && low ? swarmAddress(low) : fallback;
+}
+
 void Drone::setLeaderStatus(bool status) { is_leader_ = status; }
 
 void Drone::setName(const std::string &new_name) { name_ = new_name; }
@@ -48,7 +97,7 @@ void Drone::updateSensors(int16_t ax, int16_t ay, int16_t az, int16_t gx,
                           float battery_voltage) {
   telemetry.type = PacketType::TELEMETRY;
   telemetry.drone_id = network_id_.value_or(temp_id_);
-  telemetry.timestamp = static_cast<uint32_t>(std::time(nullptr));
+  telemetry.timestamp = clock_.now32();
   telemetry.acceleration_x = ax;
   telemetry.acceleration_y = ay;
   telemetry.acceleration_z = az;
@@ -59,140 +108,425 @@ void Drone::updateSensors(int16_t ax, int16_t ay, int16_t az, int16_t gx,
   telemetry.altitude = altitude;
 }
 
-size_t Drone::packetSize(PacketType type) const {
-  switch (type) {
-  case PacketType::COMMAND:
-    return sizeof(CommandPacket);
-  case PacketType::TELEMETRY:
-    return sizeof(TelemetryPacket);
-  case PacketType::JOIN_REQUEST:
-    return sizeof(JoinRequestPacket);
-  case PacketType::JOIN_RESPONSE:
-    return sizeof(JoinResponsePacket);
-  case PacketType::HEARTBEAT:
-    return sizeof(HeartbeatPacket);
-  case PacketType::LEADER_ANNOUNCEMENT:
-    return sizeof(LeaderAnnouncementPacket);
-  case PacketType::PERMISSION_TO_SEND:
-    return sizeof(PermissionToSendPacket);
-  case PacketType::LEADER_REQUEST:
-    return sizeof(LeaderRequestPacket);
-  default:
-    return sizeof(PacketType);
-  }
+void Drone::updateSensors(const SensorReading &reading, float altitude,
+                          float battery_voltage) {
+  const ImuSample &s = reading.imu;
+  updateSensors(s.accel[0], s.accel[1], s.accel[2], s.gyro[0], s.gyro[1],
+                s.gyro[2], altitude, battery_voltage);
+  telemetry.timestamp = static_cast<uint32_t>(
+      clock_.toSwarm(clock_.fromMonotonic(reading.timestamp_us)));
 }
 
 void Drone::pollRadio() {
-  PacketType peek;
-  while (radio.receive(&peek, sizeof(PacketType), true)) {
-    RawPacket pkt{};
-    pkt.type = peek;
-    pkt.size = packetSize(peek);
-    radio.receive(pkt.data.data(), pkt.size);
+  const size_t queued = rx_count_;
+  while (rx_count_ < rx_queue_.size()) {
+    RadioFrame &slot = rx_queue_[(rx_head_ + rx_count_) % rx_queue_.size()];
+    if (!radio.receive(slot))
+      break;
+    rx_count_++;
     telemetry.rpd = radio.testRPD() ? 1 : 0;
-    rx_queue_.push(pkt);
   }
+  metricsCount(MetricCounter::POLL_CALLS);
+  metricsRecord(MetricHistogram::POLL_BATCH, rx_count_ - queued);
 }
 
-void Drone::sendTelemetry() {
-  if (!has_permission_to_send_)
-    return;
+bool Drone::sendTelemetry() {
+  bool in_slot = false;
+  uint64_t slot_end = 0;
+  if (tdma_slot_) {
+    const uint64_t now = monotonicMicros();
+    // İkinci yarıda başlayan gönderim yeniden denemeyle komşu slota taşar
+    in_slot = now >= tdma_slot_->start_us &&
+              now < tdma_slot_->start_us + tdma_slot_->length_us / 2;
+    slot_end = tdma_slot_->start_us + tdma_slot_->length_us;
+    if (now >= tdma_slot_->start_us)
+      tdma_slot_.reset(); // slot bir kez kullanılır
+  }
+  if (!has_permission_to_send_ && !in_slot)
+    return false;
+
+  const bool adapted = in_slot && link_adaptation_;
+  if (adapted) {
+    // Yeniden denemeler slotun kalanına sığacak kadar
+    const uint64_t now = monotonicMicros();
+    if (radio.dataRate() != uplink_.rate)
+      radio.setDataRate(uplink_.rate);
+    radio.setPowerLevel(uplink_.power);
+    radio.setRetries(uplink_.retry_delay,
+                     retriesWithin(slot_end > now ? slot_end - now : 0,
+                                   sizeof(telemetry), uplink_.rate,
+                                   uplink_.retry_delay,
+                                   uplink_.retry_count));
+  }
 
   total_sends_++;
   bool success = radio.send(&telemetry, sizeof(telemetry));
   if (!success)
     failed_sends_++;
   telemetry.retries = radio.getARC();
-  telemetry.link_quality =
-      100.0f * (1.0f - static_cast<float>(failed_sends_) /
-                             static_cast<float>(total_sends_));
+  const DroneIdType peer = current_leader_id_.value_or(0);
+  link_stats_.recordTx(peer, success, telemetry.retries, monotonicMicros());
+  if (adapted) {
+    uplink_miss_run_ = success ? 0 : uplink_miss_run_ + 1;
+    // Lider de aynı sayıda kayıptan sonra tabana döner
+    if (uplink_miss_run_ >= link_config_.fallback_misses) {
+      uplink_ = baseLink();
+      uplink_miss_run_ = 0;
+    }
+  }
+  telemetry.link_quality = link_stats_.deliveryPercent(peer);
   has_permission_to_send_ = false; // izni kullandı
+  return true;
 }
 
-void Drone::handleIncoming() {
-  pollRadio();
+void Drone::finishUplink() {
+  if (link_adaptation_ && radio.dataRate() != baseLink().rate)
+    radio.setDataRate(baseLink().rate);
+}
 
-  while (!rx_queue_.empty()) {
-    RawPacket pkt = rx_queue_.front();
-    rx_queue_.pop();
-
-    switch (pkt.type) {
-    case PacketType::COMMAND: {
-      if (pkt.size == sizeof(CommandPacket)) {
-        CommandPacket cmd{};
-        std::memcpy(&cmd, pkt.data.data(), sizeof(cmd));
-        handleCommand(cmd);
-      }
-      break;
-    }
-    case PacketType::PERMISSION_TO_SEND: {
-      if (pkt.size == sizeof(PermissionToSendPacket)) {
-        PermissionToSendPacket perm{};
-        std::memcpy(&perm, pkt.data.data(), sizeof(perm));
-        if (perm.target_drone_id == network_id_.value_or(temp_id_))
-          has_permission_to_send_ = true;
-      }
-      break;
-    }
-    case PacketType::LEADER_ANNOUNCEMENT: {
-      if (pkt.size == sizeof(LeaderAnnouncementPacket)) {
-        LeaderAnnouncementPacket ann{};
-        std::memcpy(&ann, pkt.data.data(), sizeof(ann));
-        handleLeaderAnnouncement(ann);
-      }
-      break;
-    }
-    case PacketType::JOIN_RESPONSE: {
-      if (pkt.size == sizeof(JoinResponsePacket)) {
-        JoinResponsePacket resp{};
-        std::memcpy(&resp, pkt.data.data(), sizeof(resp));
-        handleJoinResponse(resp);
-      }
-      break;
+size_t Drone::forwardTelemetry() {
+  size_t sent = 0;
+  AggregateTelemetryPacket frame;
+  while (aggregator_.nextFrame(network_id_.value_or(temp_id_), frame)) {
+    total_sends_++;
+    queueTx(0, &frame, sizeof(frame), false,
+            [this, &sent](const TxCompletion &done) {
+              link_stats_.recordTx(0, done.success, done.arc,
+                                   monotonicMicros());
+              if (done.success)
+                sent++;
+              else
+                failed_sends_++;
+            });
+  }
+  radio.flushTx();
+  return sent;
+}
+
+void Drone::queueTx(uint64_t address, const void *data, size_t size,
+                    bool multicast, TxCallback done) {
+  if (radio.postTo(address, data, size, multicast, done))
+    return;
+  radio.flushTx();
+  radio.postTo(address, data, size, multicast, std::move(done));
+}
+
+bool Drone::requestTimeSync() { return requestTimeSync(monotonicMicros()); }
+
+bool Drone::requestTimeSync(uint64_t mono_us) {
+  const uint64_t now = clock_.fromMonotonic(mono_us);
+  if (now < next_sync_us_)
+    return false;
+  next_sync_us_ = now + (clock_.samples() < SWARM_CLOCK_WINDOW / 2
+                             ? SYNC_FAST_INTERVAL_US
+                             : SYNC_INTERVAL_US);
+
+  TimeSyncRequestPacket req{};
+  req.drone_id = network_id_.value_or(temp_id_);
+  // Zaman damgaları çerçevenin havadaki son bitini gösterir
+  req.originate_us = now + frameTxLeadUs(sizeof(req), radio.dataRate());
+  sync_originate_ = req.originate_us;
+  return radio.send(&req, sizeof(req));
+}
+
+size_t Drone::answerTimeSync(uint64_t address) {
+  size_t sent = 0;
+  for (size_t i = 0; i < sync_count_; ++i) {
+    TimeSyncResponsePacket resp{};
+    resp.target_drone_id = sync_queue_[i].drone_id;
+    resp.originate_us = sync_queue_[i].originate_us;
+    resp.receive_us = sync_queue_[i].receive_us;
+    resp.transmit_us =
+        clock_.now() + frameTxLeadUs(sizeof(resp), radio.dataRate());
+    // ACK'siz: yeniden deneme transmit_us damgasını bozar
+    if (radio.sendTo(addressOf(resp.target_drone_id, address), &resp,
+                     sizeof(resp), true))
+      sent++;
+  }
+  sync_count_ = 0;
+  return sent;
+}
+
+void Drone::setAckPayloads(bool enabled) {
+  if (!enabled)
+    settleDownlink();
+  ack_payloads_ = enabled;
+}
+
+bool Drone::queueDownlink(const CommandPacket &cmd) {
+  if (downlink_count_ == downlink_.size())
+    return false;
+  downlink_[downlink_count_++] = {cmd, 0};
+  return true;
+}
+
+void Drone::dropDownlink(size_t index) {
+  for (size_t i = index + 1; i < downlink_count_; ++i)
+    downlink_[i - 1] = downlink_[i];
+  downlink_count_--;
+}
+
+void Drone::settleDownlink() {
+  if (!armed_target_)
+    return;
+  if (!armed_delivered_) {
+    // Slot sahibi göndermedi: yük modülden atılır, komut kuyrukta kalır
+    radio.flushAckPayloads();
+    for (size_t i = 0; i < downlink_count_; ++i) {
+      if (downlink_[i].cmd.target_drone_id == *armed_target_)
+        downlink_[i].rounds++;
     }
-    case PacketType::TELEMETRY: {
-      if (pkt.size == sizeof(TelemetryPacket)) {
-        TelemetryPacket tlm{};
-        std::memcpy(&tlm, pkt.data.data(), sizeof(tlm));
-        handleTelemetry(tlm);
-      }
-      break;
+  }
+  armed_target_.reset();
+}
+
+void Drone::armDownlink(DroneIdType target, uint8_t pipe) {
+  settleDownlink();
+  if (!ack_payloads_)
+    return;
+  for (size_t i = 0; i < downlink_count_; ++i) {
+    CommandPacket &cmd = downlink_[i].cmd;
+    if (cmd.target_drone_id != target)
+      continue;
+    // Takipçi yaşı kendi alım anına göre ölçer, iletim anında damgala
+    cmd.timestamp = clock_.now32();
+    if (radio.queueAckPayload(pipe, &cmd, sizeof(cmd))) {
+      armed_target_ = target;
+      armed_delivered_ = false;
+      armed_pipe_ = pipe;
     }
-    case PacketType::HEARTBEAT: {
-      if (pkt.size == sizeof(HeartbeatPacket)) {
-        HeartbeatPacket hb{};
-        std::memcpy(&hb, pkt.data.data(), sizeof(hb));
-        handleHeartbeat(hb);
-      }
+    return;
+  }
+}
+
+void Drone::noteUplink(DroneIdType source) {
+  if (slot_owner_ && source == *slot_owner_ && frame_pipe_ == slot_pipe_ &&
+      ++slot_uplinks_ == 1 && link_armed_) {
+    // İlk ACK LinkControl'ü götürdü, komut varsa bir sonrakinde
+    auto it = links_.find(source);
+    if (it != links_.end())
+      it->second.active = *link_armed_;
+    link_armed_.reset();
+    link_controls_++;
+    return;
+  }
+  if (!armed_target_ || armed_delivered_ || source != *armed_target_ ||
+      frame_pipe_ != armed_pipe_)
+    return;
+  for (size_t i = 0; i < downlink_count_; ++i) {
+    if (downlink_[i].cmd.target_drone_id == source) {
+      dropDownlink(i);
+      downlink_via_ack_++;
       break;
     }
-    case PacketType::LEADER_REQUEST: {
-      if (pkt.size == sizeof(LeaderRequestPacket)) {
-        LeaderRequestPacket req{};
-        std::memcpy(&req, pkt.data.data(), sizeof(req));
-        handleLeaderRequest(req);
-      }
-      break;
+  }
+  armed_delivered_ = true;
+}
+
+void Drone::setLinkAdaptation(bool enabled, const LinkAdapterConfig &config) {
+  link_adaptation_ = enabled;
+  link_config_ = LinkAdapter(config).config();
+  links_.clear();
+  uplink_ = baseLink();
+  uplink_miss_run_ = 0;
+  if (!enabled) {
+    radio.setPowerLevel(RadioPowerLevel::MAX_POWER);
+    radio.setRetries(5, 15);
+  }
+}
+
+LinkSettings Drone::baseLink() const {
+  return LinkAdapter::rungSettings(link_config_.base_rung);
+}
+
+const LinkAdapter *Drone::linkTo(DroneIdType peer) const {
+  auto it = links_.find(peer);
+  return it != links_.end() ? &it->second.adapter : nullptr;
+}
+
+void Drone::openSlot(DroneIdType owner, uint8_t pipe) {
+  settleSlot();
+  settleDownlink();
+  slot_owner_ = owner;
+  slot_pipe_ = pipe;
+  slot_uplinks_ = 0;
+  slot_arc_ = 0;
+  if (!link_adaptation_)
+    return;
+
+  PeerLink &link =
+      links_.try_emplace(owner, PeerLink{LinkAdapter(link_config_), baseLink()})
+          .first->second;
+  // Dinleme yeniden başlar: RPD bu slotun çerçevesini gösterir
+  radio.setDataRate(link.active.rate);
+  const LinkSettings next = link.adapter.settings();
+  if (next != link.active) {
+    const LinkControlPacket ctl = makeLinkControl(owner, next, clock_.now32());
+    if (radio.queueAckPayload(pipe, &ctl, sizeof(ctl)))
+      link_armed_ = next;
+  }
+}
+
+void Drone::closeSlots() {
+  settleSlot();
+  if (link_adaptation_ && radio.dataRate() != baseLink().rate)
+    radio.setDataRate(baseLink().rate);
+}
+
+void Drone::settleSlot() {
+  if (!slot_owner_)
+    return;
+  const DroneIdType owner = *slot_owner_;
+  slot_owner_.reset();
+  link_armed_.reset();
+  const bool heard = slot_uplinks_ > 0;
+  const bool rpd = heard && radio.testRPD();
+  link_stats_.recordSlot(owner, heard, rpd, monotonicMicros());
+  auto it = links_.find(owner);
+  if (!link_adaptation_ || it == links_.end())
+    return;
+  PeerLink &link = it->second;
+  const uint32_t fallbacks = link.adapter.fallbacks();
+  link.adapter.record(heard, slot_arc_, rpd);
+  // Takipçi de aynı sayıda kayıptan sonra tabana döner, onay beklenmez
+  if (link.adapter.fallbacks() != fallbacks)
+    link.active = link.adapter.settings();
+}
+
+size_t Drone::flushDownlink(uint64_t address) {
+  settleDownlink();
+  size_t sent = 0;
+  for (size_t i = 0; i < downlink_count_;) {
+    PendingDownlink &entry = downlink_[i];
+    if (ack_payloads_ && entry.rounds < DOWNLINK_MAX_ROUNDS) {
+      ++i;
+      continue;
     }
-    case PacketType::UNDEFINED: {
-      handleUndefined();
-      break;
+    entry.cmd.timestamp = clock_.now32();
+    const uint64_t to = addressOf(entry.cmd.target_drone_id, address);
+    queueTx(to, &entry.cmd, sizeof(entry.cmd), to == address,
+            [&sent](const TxCompletion &done) { sent += done.success; });
+    downlink_separate_++;
+    dropDownlink(i);
+  }
+  radio.flushTx();
+  return sent;
+}
+
+size_t Drone::handleIncoming() {
+  MetricsTimer timer(MetricHistogram::HANDLE_INCOMING);
+  size_t handled = 0;
+  if (radio.rxThreadRunning()) {
+    // Full duplex ACK payloads bypass the RX thread.
+    RadioFrame ack;
+    while (radio.takeAckPayload(ack)) {
+      handleFrame(ack);
+      handled++;
     }
-    default:
-      break;
+    // Frames queued by the RX thread are dispatched straight from its ring.
+    while (const RadioFrame *frame = radio.frontFrame()) {
+      handleFrame(*frame);
+      radio.popFrame();
+      handled++;
     }
+    if (handled > 0)
+      telemetry.rpd = radio.testRPD() ? 1 : 0;
+    else
+      timer.cancel();
+    return handled;
+  }
+
+  pollRadio();
+  while (rx_count_ > 0) {
+    handleFrame(rx_queue_[rx_head_]);
+    rx_head_ = (rx_head_ + 1) % rx_queue_.size();
+    rx_count_--;
+    handled++;
   }
+  if (handled == 0)
+    timer.cancel();
+  return handled;
 }
 
-void Drone::handleCommand(const CommandPacket &cmd) {
-  DroneIdType self_id = network_id_.value_or(temp_id_);
-  uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+struct Drone::PacketHandler {
+  Drone &drone;
 
-  if (cmd.target_drone_id != self_id)
+  void operator()(const CommandPacket &cmd) { drone.handleCommand(cmd); }
+  void operator()(const PermissionToSendPacket &perm) {
+    if (drone.isForMe(perm.target_drone_id))
+      drone.has_permission_to_send_ = true;
+  }
+  void operator()(const LeaderAnnouncementPacket &ann) {
+    drone.handleLeaderAnnouncement(ann);
+  }
+  void operator()(const JoinResponsePacket &resp) {
+    drone.handleJoinResponse(resp);
+  }
+  void operator()(const TelemetryPacket &tlm) { drone.handleTelemetry(tlm); }
+  void operator()(const HeartbeatPacket &hb) { drone.handleHeartbeat(hb); }
+  void operator()(const LeaderRequestPacket &req) {
+    drone.handleLeaderRequest(req);
+  }
+  void operator()(const BeaconPacket &beacon) { drone.handleBeacon(beacon); }
+  void operator()(const TimeSyncRequestPacket &req) {
+    drone.handleTimeSyncRequest(req);
+  }
+  void operator()(const TimeSyncResponsePacket &resp) {
+    drone.handleTimeSyncResponse(resp);
+  }
+  void operator()(const LinkControlPacket &ctl) {
+    drone.handleLinkControl(ctl);
+  }
+};
+
+void Drone::handleFrame(const RadioFrame &frame) {
+  MetricsTimer timer(MetricHistogram::DISPATCH);
+  frame_rx_us_ = frame.rx_time_us ? frame.rx_time_us : monotonicMicros();
+  frame_pipe_ = frame.pipe;
+  if (frame.pipe < rx_frames_.size())
+    rx_frames_[frame.pipe]++;
+  PacketHandler handler{*this};
+  if (!dispatchPacket(handler, frame.data.data(), frame.size) &&
+      frame.type() == PacketType::UNDEFINED)
+    handleUndefined();
+}
+
+std::chrono::steady_clock::time_point Drone::lastHeartbeat() const {
+  return last_heartbeat_;
+}
+
+std::optional<TdmaSlot> Drone::tdmaSlot() const { return tdma_slot_; }
+
+void Drone::handleCommand(const CommandPacket &cmd) {
+  if (is_leader_ && cmd.target_drone_id == 0)
+    return; // GBS'nin izne yanıtı, lider döngüsünde işlenir
+  if (is_leader_ && ack_payloads_ &&
+      cmd.target_drone_id != network_id_.value_or(temp_id_)) {
+    // GBS'nin ACK yüküyle gelen takipçi komutları slotlarda iletilir
+    queueDownlink(cmd);
+    return;
+  }
+  if (!isForMe(cmd.target_drone_id))
     return;
 
-  if (now - cmd.timestamp > 3)
-    return; // gecikmesi 3 saniyeden büyükse yoksay
+  // Senkron öncesi JoinResponse zamanıyla kaba sınır; o da yoksa yaş
+  // ölçülemez ve komut yoksayılır
+  const uint64_t local_us = clock_.fromMonotonic(frame_rx_us_);
+  int32_t age;
+  int32_t max_age;
+  if (clock_.synced()) {
+    age = swarmAge(static_cast<uint32_t>(clock_.toSwarm(local_us)),
+                   cmd.timestamp);
+    max_age = COMMAND_MAX_AGE_US;
+  } else if (join_offset_) {
+    age = swarmAge(static_cast<uint32_t>(local_us) + *join_offset_,
+                   cmd.timestamp);
+    max_age = COMMAND_MAX_AGE_UNSYNCED_US;
+  } else {
+    return;
+  }
+  if (age > max_age || age < -max_age)
+    return; // süresi geçmiş komutu yoksay
 
   std::cout << "[Komut] " << cmd.command << std::endl;
 }
@@ -229,15 +563,25 @@ void Drone::handleJoinResponse(const JoinResponsePacket &resp) {
   std::cout << "[JoinResponse] ID " << static_cast<int>(resp.assigned_id)
             << " Channel " << static_cast<int>(resp.assigned_channel)
             << " Leader " << static_cast<int>(resp.current_leader_id)
+            << " Unicast " << static_cast<int>(resp.unicast_address)
             << std::endl;
 }
 
 void Drone::handleTelemetry(const TelemetryPacket &tlm) {
+  if (is_leader_) {
+    if (slot_owner_ && tlm.drone_id == *slot_owner_)
+      slot_arc_ = tlm.retries; // önceki gönderiminin ARC'si
+    link_stats_.recordRx(tlm.drone_id, frame_rx_us_);
+    noteUplink(tlm.drone_id);
+    aggregator_.add(tlm); // lider periyodunda toplu iletilir
+    return;
+  }
   std::cout << "[Telemetry] Drone " << static_cast<int>(tlm.drone_id)
             << " Altitude " << tlm.altitude << std::endl;
 }
 
 void Drone::handleHeartbeat(const HeartbeatPacket &hb) {
+  last_heartbeat_ = std::chrono::steady_clock::now();
   std::cout << "[Heartbeat] from " << static_cast<int>(hb.source_drone_id)
             << std::endl;
 }
@@ -248,3 +592,39 @@ void Drone::handleLeaderRequest(const LeaderRequestPacket &req) {
 }
 
 void Drone::handleUndefined() { std::cout << "UNDEFINED MESSAGE COME" << std::endl; }
+
+void Drone::handleTimeSyncRequest(const TimeSyncRequestPacket &req) {
+  noteUplink(req.drone_id);
+  if (sync_count_ == sync_queue_.size())
+    return;
+  // Yanıt lider periyodunda gönderilir, t2 alım anıdır
+  sync_queue_[sync_count_++] = {
+      req.drone_id, req.originate_us,
+      clock_.toSwarm(clock_.fromMonotonic(frame_rx_us_))};
+}
+
+void Drone::handleTimeSyncResponse(const TimeSyncResponsePacket &resp) {
+  if (!isForMe(resp.target_drone_id) || sync_originate_ != resp.originate_us)
+    return;
+  sync_originate_.reset();
+  clock_.addSample(resp.originate_us, resp.receive_us, resp.transmit_us,
+                   clock_.fromMonotonic(frame_rx_us_));
+}
+
+void Drone::handleBeacon(const BeaconPacket &beacon) {
+  // Beacon lider mesajı sayılır
+  last_heartbeat_ = std::chrono::steady_clock::now();
+  link_stats_.recordRx(beacon.leader_id, frame_rx_us_);
+  if (beacon.leader_id != network_id_.value_or(temp_id_))
+    current_leader_id_ = beacon.leader_id;
+  tdma_slot_ =
+      tdmaSlotFor(beacon, network_id_.value_or(temp_id_), frame_rx_us_);
+}
+
+void Drone::handleLinkControl(const LinkControlPacket &ctl) {
+  if (is_leader_ || !link_adaptation_ || !isForMe(ctl.target_drone_id))
+    return;
+  // Bir sonraki slottan itibaren geçerli
+  uplink_ = linkSettingsFrom(ctl);
+  uplink_miss_run_ = 0;
+}
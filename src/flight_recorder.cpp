@@ -0,0 +1,165 @@
+#include "../include/flight_recorder.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+FlightRecorder::~FlightRecorder() { close(); }
+
+bool FlightRecorder::open(const std::string &path, size_t records) {
+  close();
+  records = std::clamp<size_t>(records, 1, UINT32_MAX);
+  const size_t bytes = FLIGHT_HEADER_BYTES + records * sizeof(FlightRecord);
+
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+  if (fd < 0)
+    return false;
+  // posix_fallocate so that a full disk fails here and not with SIGBUS
+  // in the middle of a flight
+  void *mem = MAP_FAILED;
+  if (posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0)
+    mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED)
+    return false;
+
+  auto *header = new (mem) FlightHeader;
+  header->record_size = sizeof(FlightRecord);
+  header->capacity = static_cast<uint32_t>(records);
+  header->start_unix_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  header->start_monotonic_us = monotonicMicros();
+  header->pid = static_cast<int32_t>(getpid());
+  header->next.store(0, std::memory_order_relaxed);
+  header->version = FLIGHT_VERSION;
+  header->magic = FLIGHT_MAGIC;
+
+  header_ = header;
+  records_ = reinterpret_cast<FlightRecord *>(static_cast<uint8_t *>(mem) +
+                                              FLIGHT_HEADER_BYTES);
+  capacity_ = records;
+  bytes_ = bytes;
+  return true;
+}
+
+void FlightRecorder::close() {
+  if (!header_)
+    return;
+  msync(header_, bytes_, MS_ASYNC);
+  munmap(header_, bytes_);
+  header_ = nullptr;
+  records_ = nullptr;
+  capacity_ = 0;
+  bytes_ = 0;
+}
+
+void FlightRecorder::record(FlightDirection direction, const void *data,
+                            size_t size, uint64_t time_us, uint8_t pipe,
+                            uint8_t arc, uint8_t flags, uint8_t channel,
+                            RadioDataRate rate, uint64_t address) {
+  if (!header_)
+    return;
+  const uint64_t pos = header_->next.fetch_add(1, std::memory_order_relaxed);
+  FlightRecord &r = records_[pos % capacity_];
+  r.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  r.time_us = time_us;
+  r.address = address;
+  r.direction = direction;
+  r.pipe = pipe;
+  r.size = static_cast<uint8_t>(std::min(size, sizeof(r.data)));
+  r.arc = arc;
+  r.flags = flags;
+  r.channel = channel;
+  r.data_rate = static_cast<uint8_t>(rate);
+  r.reserved = 0;
+  std::memcpy(r.data, data, r.size);
+  std::memset(r.data + r.size, 0, sizeof(r.data) - r.size);
+  r.seq.store(pos + 1, std::memory_order_release);
+}
+
+void FlightRecorder::flush() {
+  if (header_)
+    msync(header_, bytes_, MS_ASYNC);
+}
+
+uint64_t FlightRecorder::recorded() const {
+  return header_ ? header_->next.load(std::memory_order_relaxed) : 0;
+}
+
+bool readFlightLog(const std::string &path, FlightLog &log) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  struct stat st {};
+  void *mem = MAP_FAILED;
+  size_t bytes = 0;
+  if (fstat(fd, &st) == 0 &&
+      static_cast<size_t>(st.st_size) >= FLIGHT_HEADER_BYTES) {
+    bytes = static_cast<size_t>(st.st_size);
+    mem = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (mem == MAP_FAILED)
+    return false;
+
+  const auto *header = static_cast<const FlightHeader *>(mem);
+  const bool valid =
+      header->magic == FLIGHT_MAGIC && header->version == FLIGHT_VERSION &&
+      header->record_size == sizeof(FlightRecord) && header->capacity > 0 &&
+      bytes >= FLIGHT_HEADER_BYTES +
+                   size_t{header->capacity} * sizeof(FlightRecord);
+  if (!valid) {
+    munmap(mem, bytes);
+    return false;
+  }
+
+  const auto *records = reinterpret_cast<const FlightRecord *>(
+      static_cast<const uint8_t *>(mem) + FLIGHT_HEADER_BYTES);
+  log = FlightLog{};
+  log.capacity = header->capacity;
+  log.start_unix_us = header->start_unix_us;
+  log.start_monotonic_us = header->start_monotonic_us;
+  log.pid = header->pid;
+  log.written = header->next.load(std::memory_order_acquire);
+
+  const uint64_t first =
+      log.written > log.capacity ? log.written - log.capacity : 0;
+  log.entries.reserve(static_cast<size_t>(log.written - first));
+  for (uint64_t pos = first; pos < log.written; pos++) {
+    const FlightRecord &r = records[pos % log.capacity];
+    if (r.seq.load(std::memory_order_acquire) != pos + 1) {
+      log.torn++;
+      continue;
+    }
+    FlightEntry e{};
+    e.seq = pos + 1;
+    e.time_us = r.time_us;
+    e.address = r.address;
+    e.direction = r.direction;
+    e.pipe = r.pipe;
+    e.size = std::min<uint8_t>(r.size, sizeof(e.data));
+    e.arc = r.arc;
+    e.flags = r.flags;
+    e.channel = r.channel;
+    e.data_rate = static_cast<RadioDataRate>(r.data_rate);
+    std::memcpy(e.data, r.data, e.size);
+    // A writer may have started a new lap on this slot meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (r.seq.load(std::memory_order_acquire) != pos + 1) {
+      log.torn++;
+      continue;
+    }
+    log.entries.push_back(e);
+  }
+  munmap(mem, bytes);
+  return true;
+}
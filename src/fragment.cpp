@@ -0,0 +1,236 @@
+#include "../include/fragment.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+FragmentSender::FragmentSender(RadioInterface &radio, DroneIdType self,
+                               FragmentConfig config)
+    : radio_(radio), self_(self), config_(config),
+      // Yeniden başlayan gönderen alıcının hâlâ tuttuğu kimliklerden başlamasın
+      message_id_(static_cast<uint8_t>(std::random_device{}())),
+      message_(FRAGMENT_MAX_MESSAGE) {}
+
+bool FragmentSender::start(DroneIdType dest, const void *data, size_t size) {
+  if (busy() || size == 0 || size > FRAGMENT_MAX_MESSAGE ||
+      !fragmentReachable(dest))
+    return false;
+  std::memcpy(message_.data(), data, size);
+  size_ = size;
+  dest_ = dest;
+  message_id_++;
+  count_ = static_cast<uint8_t>((size + FRAGMENT_PAYLOAD - 1) /
+                                FRAGMENT_PAYLOAD);
+  pending_.fill(false);
+  std::fill_n(pending_.begin(), count_, true);
+  rounds_ = 0;
+  acked_ = 0;
+  first_round_ = true;
+  waiting_ = false;
+  state_ = FragmentState::SENDING;
+  stats_.messages++;
+  return true;
+}
+
+void FragmentSender::poll(uint64_t now_us) {
+  if (state_ != FragmentState::SENDING)
+    return;
+  if (waiting_) {
+    if (now_us < deadline_us_)
+      return;
+    // Yanıt yok: son parça yoklama olarak yeniden gider
+    stats_.timeouts++;
+    pending_[count_ - 1] = true;
+    waiting_ = false;
+  }
+  if (rounds_ >= config_.max_rounds) {
+    state_ = FragmentState::FAILED;
+    stats_.failed++;
+    return;
+  }
+  sendRound(now_us);
+}
+
+void FragmentSender::sendRound(uint64_t now_us) {
+  size_t last = count_;
+  for (size_t i = 0; i < count_; ++i)
+    if (pending_[i])
+      last = i;
+  if (last == count_)
+    last = count_ - 1; // hepsi gitti ama ACK yok: yoklama
+  pending_[last] = true;
+
+  FragmentPacket frag{};
+  frag.source_id = self_;
+  frag.message_id = message_id_;
+  frag.count = count_;
+  request_failed_ = false;
+  for (size_t i = 0; i <= last; ++i) {
+    if (!pending_[i])
+      continue;
+    pending_[i] = false;
+    const size_t offset = i * FRAGMENT_PAYLOAD;
+    const size_t len = std::min(FRAGMENT_PAYLOAD, size_ - offset);
+    frag.index = static_cast<uint8_t>(i);
+    frag.length = static_cast<uint8_t>(len);
+    if (i == last)
+      frag.length |= FRAGMENT_ACK_REQUEST;
+    std::memcpy(frag.payload, message_.data() + offset, len);
+    queue(frag, i, i == last);
+    stats_.fragments++;
+    if (!first_round_)
+      stats_.resent++;
+  }
+  radio_.flushTx();
+  first_round_ = false;
+  rounds_++;
+  stats_.rounds++;
+  // İsteği taşıyan parça gitmediyse beklemeden yeni tur
+  waiting_ = !request_failed_;
+  deadline_us_ = std::max(now_us, monotonicMicros()) + config_.ack_timeout_us;
+}
+
+void FragmentSender::queue(const FragmentPacket &frag, size_t index,
+                           bool request) {
+  const uint64_t to = fragmentAddress(dest_);
+  auto done = [this, index, request](const TxCompletion &c) {
+    if (c.success)
+      return;
+    pending_[index] = true;
+    if (request)
+      request_failed_ = true;
+  };
+  if (radio_.postTo(to, &frag, sizeof(frag), config_.multicast, done))
+    return;
+  radio_.flushTx();
+  radio_.postTo(to, &frag, sizeof(frag), config_.multicast, done);
+}
+
+bool FragmentSender::handleFrame(const RadioFrame &frame, uint64_t now_us) {
+  const auto *ack = frame.as<FragmentAckPacket>();
+  if (!ack || ack->target_id != self_)
+    return false;
+  if (state_ != FragmentState::SENDING || ack->source_id != dest_ ||
+      ack->message_id != message_id_)
+    return true; // eski bir mesajın ya da turun yanıtı
+  if (ack->base >= count_) {
+    state_ = FragmentState::DELIVERED;
+    stats_.delivered++;
+    waiting_ = false;
+    return true;
+  }
+  std::fill_n(pending_.begin(), ack->base, false);
+  size_t acked = ack->base;
+  for (size_t bit = 0; bit < FRAGMENT_ACK_WINDOW && ack->base + bit < count_;
+       ++bit) {
+    const bool got = (ack->received[bit / 8] >> (bit % 8)) & 1;
+    pending_[ack->base + bit] = !got;
+    acked += got;
+  }
+  // Pencerenin ötesi sonraki ACK'lerde görünür
+  if (acked > acked_) {
+    acked_ = acked;
+    rounds_ = 0;
+  }
+  waiting_ = false;
+  deadline_us_ = now_us;
+  return true;
+}
+
+FragmentReceiver::FragmentReceiver(RadioInterface &radio, DroneIdType self,
+                                   FragmentConfig config)
+    : radio_(radio), self_(self), config_(config),
+      slots_(std::max<size_t>(1, config.slots)) {}
+
+const FragmentMessage *FragmentReceiver::handleFrame(const RadioFrame &frame,
+                                                     uint64_t now_us) {
+  const auto *frag = frame.as<FragmentPacket>();
+  if (!frag)
+    return nullptr;
+  const size_t len = frag->length & ~FRAGMENT_ACK_REQUEST;
+  const bool last = frag->index + 1 == frag->count;
+  if (frag->index >= frag->count || len > FRAGMENT_PAYLOAD ||
+      (!last && len != FRAGMENT_PAYLOAD) || len == 0)
+    return nullptr;
+  stats_.fragments++;
+
+  Slot &slot = slotFor(*frag, now_us);
+  slot.last_us = now_us;
+  const FragmentMessage *result = nullptr;
+  if (slot.complete || slot.received[frag->index]) {
+    stats_.duplicates++;
+  } else {
+    // Parça doğrudan havuzdaki tampona yazılır
+    std::memcpy(slot.data.data() + frag->index * FRAGMENT_PAYLOAD,
+                frag->payload, len);
+    slot.received[frag->index] = true;
+    slot.have++;
+    if (last)
+      slot.size = frag->index * FRAGMENT_PAYLOAD + len;
+    if (slot.have == slot.count) {
+      slot.complete = true;
+      stats_.messages++;
+      done_ = {slot.source, slot.message_id, slot.data.data(), slot.size};
+      result = &done_;
+    }
+  }
+  if ((frag->length & FRAGMENT_ACK_REQUEST) || result)
+    sendAck(slot);
+  return result;
+}
+
+FragmentReceiver::Slot &FragmentReceiver::slotFor(const FragmentPacket &frag,
+                                                  uint64_t now_us) {
+  Slot *free = nullptr;
+  Slot *done = nullptr;    // oldest finished message
+  Slot *oldest = nullptr;  // oldest unfinished message
+  for (Slot &s : slots_) {
+    // Biten mesaj da yalnızca yeniden ACK için, expire_us boyunca tutulur
+    if (s.used && now_us - s.last_us > config_.expire_us) {
+      s.used = false;
+      if (!s.complete)
+        stats_.evicted++;
+    }
+    if (!s.used) {
+      free = free ? free : &s;
+      continue;
+    }
+    if (s.source == frag.source_id && s.message_id == frag.message_id &&
+        s.count == frag.count)
+      return s;
+    Slot *&pick = s.complete ? done : oldest;
+    if (!pick || s.last_us < pick->last_us)
+      pick = &s;
+  }
+  Slot &s = free ? *free : done ? *done : *oldest;
+  if (!free && !done)
+    stats_.evicted++;
+  s.used = true;
+  s.complete = false;
+  s.source = frag.source_id;
+  s.message_id = frag.message_id;
+  s.count = frag.count;
+  s.have = 0;
+  s.size = 0;
+  s.received.fill(false);
+  return s;
+}
+
+void FragmentReceiver::sendAck(const Slot &slot) {
+  FragmentAckPacket ack{};
+  ack.source_id = self_;
+  ack.target_id = slot.source;
+  ack.message_id = slot.message_id;
+  size_t base = 0;
+  while (base < slot.count && slot.received[base])
+    base++;
+  ack.base = static_cast<uint8_t>(base);
+  for (size_t bit = 0; bit < FRAGMENT_ACK_WINDOW && base + bit < slot.count;
+       ++bit)
+    if (slot.received[base + bit])
+      ack.received[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+  // Link ACK'siz: kaybolan bir ACK'yi gönderenin yoklaması telafi eder,
+  // yeniden denemeler ise bir sonraki turla çakışırdı
+  radio_.sendTo(fragmentAddress(slot.source), &ack, sizeof(ack), true);
+  stats_.acks++;
+}
@@ -0,0 +1,247 @@
+// Yer istasyonu (GBS): katılma, lider ataması ve telemetri toplama.
+//
+//   ./gbs [--rx-thread] [--metrics] [--record PATH] [--status SEC]
+//         [--channel N] [--radio CE,CSN,SPI,IRQ[,KANAL] ...]
+//
+// Açılışta bant RPD ile taranır ve en sessiz kanal operasyon kanalı olur
+// (--channel ile verilebilir; JOIN_CHANNEL herkesi katılma kanalında
+// tutar). Katılmalar JOIN_CHANNEL'da: GBS her JOIN_PERIOD_US'de
+// JOIN_WINDOW_US boyunca oraya geçer, drone'lar yanıt gelene kadar
+// isteklerini tekrarlar ve JoinResponse'taki kanala geçer. Her --radio
+// ek bir modül ekler (kendi SPI veriyolu, IRQ hattı ve kanalı, verilmezse
+// taramadan seçilir); o zaman her modül ayrı bir sürüye hizmet eder,
+// katılanlar en az drone'lu modülün kanalına atanır ve çerçeveler tek,
+// sıralı ve tekrarsız bir akışta birleşir.
+#include "ground_station.hpp"
+#include "metrics.hpp"
+#include "radio.hpp"
+#include "radio_bank.hpp"
+#include "spectrum.hpp"
+#include "timebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#define TX_CE_PIN 27
+#define TX_CSN_PIN 0
+#define RX_CE_PIN 22
+#define RX_CSN_PIN 10
+#define RX_IRQ_PIN 24
+#define GPIO_CHIP "/dev/gpiochip0"
+
+constexpr uint64_t JOIN_PERIOD_US = 1500000;
+constexpr uint64_t JOIN_WINDOW_US = 150000;
+
+namespace {
+
+std::atomic<bool> stop_requested{false};
+
+void onSignal(int) { stop_requested = true; }
+
+struct ExtraRadio {
+  int ce, csn, spi, irq, channel; // channel 0: from the survey
+};
+
+// Seçilen kanal ve koruma bandı sonraki seçimler için dolu sayılır
+void reserve(SpectrumSurvey &survey, uint8_t channel,
+             const ChannelSelectConfig &select) {
+  const int lo = std::max(0, channel - select.guard - 1);
+  const int hi = std::min<int>(RADIO_CHANNELS - 1, channel + select.guard + 1);
+  for (int c = lo; c <= hi; ++c)
+    survey.hits[c] = std::max<uint16_t>(survey.sweeps, 1);
+  survey.sweeps = std::max<uint16_t>(survey.sweeps, 1);
+}
+
+void printStatus(const GroundStation &gbs, const RadioBank *bank,
+                 uint64_t now_us) {
+  const SwarmTable &t = gbs.table();
+  const GroundStationStats &s = gbs.stats();
+  std::printf("--- %zu drone, %llu çerçeve, %llu örnek, %llu bilinmeyen\n",
+              t.activeCount(), static_cast<unsigned long long>(s.frames),
+              static_cast<unsigned long long>(s.telemetry),
+              static_cast<unsigned long long>(s.unknown));
+  for (size_t r = 0; r < gbs.radios(); ++r)
+    std::printf("modül %zu: lider %d, %llu çerçeve\n", r,
+                gbs.leader(r) ? *gbs.leader(r) : -1,
+                static_cast<unsigned long long>(
+                    bank ? bank->stats().frames[r] : s.frames));
+  if (bank)
+    std::printf("birleşik akış: %llu tekrar atıldı, %llu geç\n",
+                static_cast<unsigned long long>(bank->stats().duplicates),
+                static_cast<unsigned long long>(bank->stats().late));
+  for (size_t id = 1; id <= GBS_MAX_DRONES; ++id) {
+    if (!t.temp_id[id])
+      continue;
+    std::printf("%3zu m%u %-20s son %6.1f s  örnek %7u  aralık %7.1f ms  "
+                "bat %.2f V  irt %.1f m  link %.0f%%\n",
+                id, t.radio[id], t.name[id].data(),
+                (now_us - t.last_seen_us[id]) / 1e6, t.samples[id],
+                t.gap_us[id] / 1e3, static_cast<double>(t.battery[id]),
+                static_cast<double>(t.altitude[id]),
+                static_cast<double>(t.link_quality[id]));
+  }
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool rx_thread = false;
+  bool metrics = false;
+  const char *record_path = nullptr;
+  int status_s = 5;
+  int channel = 0;
+  std::vector<ExtraRadio> extra;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--rx-thread") == 0)
+      rx_thread = true;
+    else if (std::strcmp(argv[i], "--metrics") == 0)
+      metrics = true;
+    else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+      record_path = argv[++i];
+    else if (std::strcmp(argv[i], "--status") == 0 && i + 1 < argc)
+      status_s = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--channel") == 0 && i + 1 < argc)
+      channel = std::clamp(std::atoi(argv[++i]), 0,
+                           static_cast<int>(RADIO_CHANNELS) - 1);
+    else if (std::strcmp(argv[i], "--radio") == 0 && i + 1 < argc) {
+      ExtraRadio r{};
+      if (std::sscanf(argv[++i], "%d,%d,%d,%d,%d", &r.ce, &r.csn, &r.spi,
+                      &r.irq, &r.channel) >= 4)
+        extra.push_back(r);
+      else
+        std::cerr << "--radio CE,CSN,SPI,IRQ[,KANAL] bekleniyor\n";
+    }
+  }
+
+  if (metrics && !metricsOpen())
+    std::cerr << "Metrik segmenti açılamadı, yalnızca süreç içinde tutulacak\n";
+
+  FlightRecorder recorder; // radyodan önce kurulur
+  RadioInterface radio(TX_CE_PIN, TX_CSN_PIN, RX_CE_PIN, RX_CSN_PIN);
+  if (!radio.begin()) {
+    std::cerr << "Radio başlatılamadı!\n";
+    return 1;
+  }
+  if (record_path) {
+    if (recorder.open(record_path))
+      radio.setFlightRecorder(&recorder);
+    else
+      std::cerr << "Uçuş kaydı açılamadı: " << record_path << "\n";
+  }
+  radio.configure(JOIN_CHANNEL, RadioDataRate::MEDIUM_RATE);
+
+  // Operasyon kanalları: verilmeyenler taramanın en sessizleri
+  const ChannelSelectConfig select;
+  SpectrumSurvey survey;
+  if (channel == 0 || std::any_of(extra.begin(), extra.end(),
+                                  [](const ExtraRadio &r) {
+                                    return r.channel == 0;
+                                  })) {
+    std::cout << "Bant taranıyor..." << std::endl;
+    survey = surveySpectrum(radio);
+  }
+  for (const ExtraRadio &r : extra)
+    if (r.channel)
+      reserve(survey, static_cast<uint8_t>(r.channel), select);
+  if (channel == 0)
+    channel = selectChannel(survey, select);
+  reserve(survey, static_cast<uint8_t>(channel), select);
+  for (ExtraRadio &r : extra) {
+    if (r.channel == 0) {
+      r.channel = selectChannel(survey, select);
+      reserve(survey, static_cast<uint8_t>(r.channel), select);
+    }
+  }
+  GroundStationConfig config;
+  config.channel = static_cast<uint8_t>(channel);
+
+  // Ek modüller: her biri kendi RX thread'iyle banka girer
+  std::vector<std::unique_ptr<RadioInterface>> modules;
+  RadioBank bank;
+  std::unique_ptr<GroundStation> gbs_ptr;
+  if (extra.empty()) {
+    if (rx_thread && !radio.startRxThread(GPIO_CHIP, RX_IRQ_PIN))
+      std::cerr << "IRQ hattı açılamadı, RX thread kapalı\n";
+    gbs_ptr = std::make_unique<GroundStation>(radio, config);
+  } else {
+    bank.add(radio, GPIO_CHIP, RX_IRQ_PIN);
+    for (const ExtraRadio &r : extra) {
+      auto module = std::make_unique<RadioInterface>(
+          static_cast<uint8_t>(r.ce), static_cast<uint8_t>(r.csn),
+          static_cast<uint8_t>(r.spi));
+      if (!module->begin()) {
+        std::cerr << "Modül başlatılamadı (CE " << r.ce << ")\n";
+        return 1;
+      }
+      module->configure(static_cast<uint8_t>(r.channel),
+                        RadioDataRate::MEDIUM_RATE);
+      if (bank.add(*module, GPIO_CHIP, static_cast<unsigned>(r.irq)) < 0) {
+        std::cerr << "En fazla " << RADIO_BANK_MAX << " modül\n";
+        return 1;
+      }
+      modules.push_back(std::move(module));
+    }
+    gbs_ptr = std::make_unique<GroundStation>(bank, config);
+  }
+  GroundStation &gbs = *gbs_ptr;
+  gbs.begin();
+  if (!extra.empty() && !bank.start()) {
+    std::cerr << "IRQ hatları açılamadı\n";
+    return 1;
+  }
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+  std::cout << "GBS dinliyor, katılma kanalı " << static_cast<int>(JOIN_CHANNEL)
+            << ", operasyon kanalı " << channel << std::endl;
+  for (const ExtraRadio &r : extra)
+    std::cout << "Modül (CE " << r.ce << ") kanal " << r.channel << std::endl;
+
+  // Modül 0 operasyon kanalında durur, katılma penceresinde JOIN_CHANNEL'a
+  // geçer; pencerede tick çalışmaz, lider duyuruları yanlış kanala gitmez
+  const bool hopping = channel != JOIN_CHANNEL;
+  bool joining = false;
+  uint64_t next_join = monotonicMicros();
+  uint64_t next_tick = 0;
+  uint64_t next_status = monotonicMicros() + status_s * 1000000ULL;
+  while (!stop_requested.load()) {
+    if (hopping) {
+      const uint64_t now = monotonicMicros();
+      if (!joining && now >= next_join) {
+        radio.setChannel(JOIN_CHANNEL);
+        joining = true;
+      } else if (joining && now >= next_join + JOIN_WINDOW_US) {
+        radio.setChannel(static_cast<uint8_t>(channel));
+        joining = false;
+        next_join += JOIN_PERIOD_US;
+      }
+    }
+    if (gbs.poll() == 0) {
+      if (extra.empty())
+        radio.waitForFrame(std::chrono::milliseconds(1));
+      else
+        bank.wait(std::chrono::milliseconds(1));
+    }
+    const uint64_t now = monotonicMicros();
+    if (!joining && now >= next_tick) {
+      gbs.tick(now);
+      next_tick = now + 10000;
+    }
+    if (now >= next_status) {
+      printStatus(gbs, extra.empty() ? nullptr : &bank, now);
+      next_status = now + status_s * 1000000ULL;
+    }
+  }
+  bank.stop();
+  radio.stopRxThread();
+  metricsClose();
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include "../include/gpio_irq.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+GpioIrqLine::~GpioIrqLine() { close(); }
+
+bool GpioIrqLine::open(const std::string &chip, unsigned line) {
+  close();
+  int chip_fd = ::open(chip.c_str(), O_RDONLY | O_CLOEXEC);
+  if (chip_fd < 0)
+    return false;
+
+  gpioevent_request req{};
+  req.lineoffset = line;
+  req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+  req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+  std::strncpy(req.consumer_label, "rf24drone-irq",
+               sizeof(req.consumer_label) - 1);
+
+  const int rc = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+  ::close(chip_fd);
+  if (rc < 0 || req.fd < 0)
+    return false;
+
+  fd = req.fd;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+void GpioIrqLine::close() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+void GpioIrqLine::clear() {
+  if (fd < 0)
+    return;
+  gpioevent_data events[8];
+  while (::read(fd, events, sizeof(events)) > 0) {
+  }
+}
@@ -0,0 +1,406 @@
+#include "../include/ground_station.hpp"
+#include "../include/packet_traits.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+size_t SwarmTable::activeCount() const {
+  return static_cast<size_t>(
+      std::count_if(temp_id.begin(), temp_id.end(),
+                     [](DroneIdType t) { return t != 0; }));
+}
+
+void SwarmTable::clear(DroneIdType id) {
+  temp_id[id] = 0;
+  nonce[id] = 0;
+  joined_us[id] = 0;
+  last_seen_us[id] = 0;
+  radio[id] = 0;
+  frames[id] = 0;
+  samples[id] = 0;
+  last_sample_us[id] = 0;
+  gap_us[id] = 0.0f;
+  retries[id] = 0;
+  link_quality[id] = 0.0f;
+  timestamp[id] = 0;
+  accel_x[id] = accel_y[id] = accel_z[id] = 0;
+  gyro_x[id] = gyro_y[id] = gyro_z[id] = 0;
+  battery[id] = 0.0f;
+  altitude[id] = 0.0f;
+  name[id] = {};
+}
+
+TelemetryPacket SwarmTable::telemetry(DroneIdType id) const {
+  TelemetryPacket tlm{};
+  tlm.drone_id = id;
+  tlm.timestamp = timestamp[id];
+  tlm.acceleration_x = accel_x[id];
+  tlm.acceleration_y = accel_y[id];
+  tlm.acceleration_z = accel_z[id];
+  tlm.gyroscope_x = gyro_x[id];
+  tlm.gyroscope_y = gyro_y[id];
+  tlm.gyroscope_z = gyro_z[id];
+  tlm.battery_voltage = battery[id];
+  tlm.altitude = altitude[id];
+  tlm.retries = retries[id];
+  tlm.link_quality = link_quality[id];
+  return tlm;
+}
+
+GroundStation::GroundStation(RadioInterface &radio,
+                             GroundStationConfig config)
+    : radios_{&radio}, config_(config),
+      decoders_(std::make_unique<
+                std::array<TelemetryDecoder, SWARM_TABLE_SIZE>>()) {
+  config_.group_size = std::max<uint8_t>(config_.group_size, 1);
+}
+
+GroundStation::GroundStation(RadioBank &bank, GroundStationConfig config)
+    : bank_(&bank), config_(config),
+      decoders_(std::make_unique<
+                std::array<TelemetryDecoder, SWARM_TABLE_SIZE>>()) {
+  config_.group_size = std::max<uint8_t>(config_.group_size, 1);
+  for (size_t i = 0; i < bank.size(); ++i)
+    radios_.push_back(&bank.radio(i));
+}
+
+void GroundStation::begin() {
+  for (RadioInterface *radio : radios_)
+    radio->setAddress(BASE_RX, BASE_TX);
+}
+
+struct GroundStation::PacketHandler {
+  GroundStation &gbs;
+
+  void operator()(const JoinRequestPacket &req) { gbs.handleJoinRequest(req); }
+  void operator()(const TelemetryPacket &tlm) { gbs.handleTelemetry(tlm); }
+  void operator()(const AggregateTelemetryPacket &agg) {
+    gbs.handleAggregate(agg);
+  }
+  void operator()(const CompressedTelemetryPacket &frame) {
+    gbs.handleCompressed(frame);
+  }
+  void operator()(const PermissionToSendPacket &perm) {
+    gbs.handlePermission(perm);
+  }
+  void operator()(const TimeSyncRequestPacket &req) {
+    gbs.handleTimeSync(req);
+  }
+  void operator()(const LeaderRequestPacket &req) {
+    gbs.handleLeaderRequest(req);
+  }
+  void operator()(const HeartbeatPacket &hb) { gbs.heard(hb.source_drone_id); }
+};
+
+void GroundStation::handleFrame(const RadioFrame &frame, uint8_t radio) {
+  frame_rx_us_ = frame.rx_time_us ? frame.rx_time_us : monotonicMicros();
+  frame_radio_ = radio < radios_.size() ? radio : 0;
+  stats_.frames++;
+  PacketHandler handler{*this};
+  dispatchPacket(handler, frame.data.data(), frame.size);
+}
+
+size_t GroundStation::poll(size_t max) {
+  size_t handled = 0;
+  if (bank_) {
+    BankFrame in;
+    while (handled < max && bank_->next(in)) {
+      handleFrame(in.frame, in.radio);
+      handled++;
+    }
+    return handled;
+  }
+  RadioFrame frame;
+  while (handled < max && radios_[0]->receive(frame)) {
+    handleFrame(frame);
+    handled++;
+  }
+  return handled;
+}
+
+void GroundStation::run(const std::atomic<bool> &stop) {
+  while (!stop.load(std::memory_order_relaxed)) {
+    if (poll() == 0) {
+      if (bank_)
+        bank_->wait(std::chrono::milliseconds(1));
+      else
+        radios_[0]->waitForFrame(std::chrono::milliseconds(1));
+    }
+    // Tarama 200 kimlik üzerinde, her çerçevede değil 10 ms'de bir
+    const uint64_t now = monotonicMicros();
+    if (now >= next_tick_us_) {
+      tick(now);
+      next_tick_us_ = now + 10000;
+    }
+  }
+}
+
+void GroundStation::tick(uint64_t now_us) {
+  if (config_.expire_us) {
+    for (size_t id = 1; id <= GBS_MAX_DRONES; ++id) {
+      if (table_.temp_id[id] &&
+          now_us > table_.last_seen_us[id] + config_.expire_us) {
+        release(static_cast<DroneIdType>(id));
+        stats_.expired++;
+      }
+    }
+  }
+
+  // Sessiz liderin yerine o sürüden en son duyulan drone
+  for (size_t r = 0; r < radios_.size(); ++r) {
+    if (leaderAlive(r, now_us))
+      continue;
+    DroneIdType best = 0;
+    uint64_t best_seen = 0;
+    for (size_t id = 1; id <= GBS_MAX_DRONES; ++id) {
+      if (table_.temp_id[id] && table_.radio[id] == r &&
+          id != leaders_[r] && table_.last_seen_us[id] > best_seen) {
+        best = static_cast<DroneIdType>(id);
+        best_seen = table_.last_seen_us[id];
+      }
+    }
+    if (best && now_us <= best_seen + config_.leader_timeout_us)
+      designateLeader(best);
+  }
+}
+
+bool GroundStation::leaderAlive(size_t radio, uint64_t now_us) const {
+  const auto &leader = leaders_[radio];
+  return leader &&
+         now_us <= table_.last_seen_us[*leader] + config_.leader_timeout_us;
+}
+
+uint8_t GroundStation::leastLoadedRadio() const {
+  std::array<size_t, RADIO_BANK_MAX> load{};
+  for (size_t id = 1; id <= GBS_MAX_DRONES; ++id)
+    if (table_.temp_id[id])
+      load[table_.radio[id]]++;
+  const auto it = std::min_element(load.begin(), load.begin() + radios_.size());
+  return static_cast<uint8_t>(it - load.begin());
+}
+
+void GroundStation::queueCommand(DroneIdType target, const char *text) {
+  CommandPacket cmd{};
+  cmd.target_drone_id = target;
+  std::strncpy(cmd.command, text, MAX_COMMAND_LENGTH - 1);
+  commands_.push_back(cmd);
+}
+
+bool GroundStation::designateLeader(DroneIdType id) {
+  if (!table_.active(id))
+    return false;
+  const uint8_t radio = table_.radio[id];
+  if (leaders_[radio] != id)
+    stats_.leader_changes++;
+  leaders_[radio] = id;
+  LeaderAnnouncementPacket ann{};
+  ann.new_leader_id = id;
+  ann.timestamp = clock_.now32();
+  radios_[radio]->sendTo(BASE_RX, &ann, sizeof(ann), true);
+  return true;
+}
+
+uint64_t GroundStation::addressOf(DroneIdType id) const {
+  const uint8_t unicast = unicastAddressByte(id);
+  return config_.unicast && unicast ? swarmAddress(unicast) : BASE_RX;
+}
+
+void GroundStation::heard(DroneIdType id) {
+  if (!table_.active(id))
+    return;
+  table_.last_seen_us[id] = frame_rx_us_;
+  table_.frames[id]++;
+}
+
+bool GroundStation::ingest(DroneIdType id) {
+  if (!table_.active(id)) {
+    stats_.unknown++;
+    return false;
+  }
+  stats_.telemetry++;
+  if (table_.samples[id]++) {
+    const auto gap =
+        static_cast<float>(frame_rx_us_ - table_.last_sample_us[id]);
+    table_.gap_us[id] += 0.125f * (gap - table_.gap_us[id]);
+  }
+  table_.last_sample_us[id] = frame_rx_us_;
+  table_.last_seen_us[id] = frame_rx_us_;
+  return true;
+}
+
+void GroundStation::store(const TelemetryPacket &tlm) {
+  const DroneIdType id = tlm.drone_id;
+  table_.timestamp[id] = tlm.timestamp;
+  table_.accel_x[id] = tlm.acceleration_x;
+  table_.accel_y[id] = tlm.acceleration_y;
+  table_.accel_z[id] = tlm.acceleration_z;
+  table_.gyro_x[id] = tlm.gyroscope_x;
+  table_.gyro_y[id] = tlm.gyroscope_y;
+  table_.gyro_z[id] = tlm.gyroscope_z;
+  table_.battery[id] = tlm.battery_voltage;
+  table_.altitude[id] = tlm.altitude;
+  table_.retries[id] = tlm.retries;
+  table_.link_quality[id] = tlm.link_quality;
+}
+
+void GroundStation::handleTelemetry(const TelemetryPacket &tlm) {
+  heard(tlm.drone_id);
+  if (ingest(tlm.drone_id))
+    store(tlm);
+}
+
+void GroundStation::handleAggregate(const AggregateTelemetryPacket &agg) {
+  heard(agg.leader_id);
+  const size_t n = std::min<size_t>(agg.count, MAX_AGGREGATE_ENTRIES);
+  for (size_t i = 0; i < n; ++i) {
+    const AggregateTelemetryEntry &e = agg.entries[i];
+    if (!ingest(e.drone_id))
+      continue;
+    // Yalnızca üst bayt taşınır (değer ~= ham / 256)
+    table_.accel_x[e.drone_id] = static_cast<int16_t>(e.acceleration[0] * 256);
+    table_.accel_y[e.drone_id] = static_cast<int16_t>(e.acceleration[1] * 256);
+    table_.accel_z[e.drone_id] = static_cast<int16_t>(e.acceleration[2] * 256);
+    table_.gyro_x[e.drone_id] = static_cast<int16_t>(e.gyroscope[0] * 256);
+    table_.gyro_y[e.drone_id] = static_cast<int16_t>(e.gyroscope[1] * 256);
+    table_.gyro_z[e.drone_id] = static_cast<int16_t>(e.gyroscope[2] * 256);
+  }
+}
+
+void GroundStation::handleCompressed(const CompressedTelemetryPacket &frame) {
+  heard(frame.drone_id);
+  if (!table_.active(frame.drone_id)) {
+    stats_.unknown++;
+    return;
+  }
+  TelemetryPacket samples[0x80];
+  const size_t n = (*decoders_)[frame.drone_id].decode(frame, samples, 0x80);
+  if (n == 0) {
+    stats_.undecodable++;
+    return;
+  }
+  for (size_t i = 0; i < n; ++i)
+    ingest(frame.drone_id);
+  store(samples[n - 1]);
+}
+
+void GroundStation::handlePermission(const PermissionToSendPacket &perm) {
+  const auto leader = leaders_[frame_radio_];
+  if (perm.target_drone_id != 0 || !leader)
+    return;
+  heard(*leader);
+  RadioInterface &radio = *radios_[frame_radio_];
+  // Lider izin verdi: bu sürünün bekleyen komutları, ardından periyodu
+  // kapatan no_need
+  for (auto it = commands_.begin(); it != commands_.end();) {
+    const DroneIdType to = it->target_drone_id ? it->target_drone_id : *leader;
+    if (it->target_drone_id && table_.radio[to] != frame_radio_) {
+      ++it;
+      continue;
+    }
+    CommandPacket cmd = *it;
+    it = commands_.erase(it);
+    cmd.timestamp = clock_.now32();
+    // Ortak adreste her dinleyici ACK'lardı: ACK istenmez
+    const uint64_t address = addressOf(to);
+    radio.sendTo(address, &cmd, sizeof(cmd), address == BASE_RX);
+    stats_.commands++;
+  }
+  CommandPacket done{};
+  done.target_drone_id = 0;
+  done.timestamp = clock_.now32();
+  std::strncpy(done.command, "no_need", MAX_COMMAND_LENGTH - 1);
+  const uint64_t address = addressOf(*leader);
+  radio.sendTo(address, &done, sizeof(done), address == BASE_RX);
+}
+
+void GroundStation::handleTimeSync(const TimeSyncRequestPacket &req) {
+  heard(req.drone_id);
+  TimeSyncResponsePacket resp{};
+  resp.target_drone_id = req.drone_id;
+  resp.originate_us = req.originate_us;
+  resp.receive_us = clock_.toSwarm(frame_rx_us_);
+  resp.transmit_us =
+      clock_.now() +
+      frameTxLeadUs(sizeof(resp), radios_[frame_radio_]->dataRate());
+  radios_[frame_radio_]->sendTo(addressOf(req.drone_id), &resp, sizeof(resp),
+                                true);
+  stats_.time_syncs++;
+}
+
+void GroundStation::handleLeaderRequest(const LeaderRequestPacket &req) {
+  heard(req.drone_id);
+  if (!table_.active(req.drone_id))
+    return;
+  // Lider yaşıyorsa yalnızca yeniden duyurulur
+  const uint8_t radio = table_.radio[req.drone_id];
+  designateLeader(leaderAlive(radio, frame_rx_us_) ? *leaders_[radio]
+                                                   : req.drone_id);
+}
+
+void GroundStation::handleJoinRequest(const JoinRequestPacket &req) {
+  const auto id = assignId(req);
+  if (!id) {
+    stats_.join_full++;
+    return;
+  }
+  table_.last_seen_us[*id] = frame_rx_us_;
+  const uint8_t radio = table_.radio[*id];
+  if (!leaders_[radio]) {
+    leaders_[radio] = *id;
+    stats_.leader_changes++;
+  }
+
+  JoinResponsePacket resp{};
+  resp.assigned_id = *id;
+  resp.current_leader_id = *leaders_[radio];
+  resp.assigned_channel =
+      radio == 0 ? config_.channel : radios_[radio]->channel();
+  resp.timestamp = clock_.now32();
+  resp.temp_id = req.temp_id;
+  resp.nonce = req.nonce;
+  if (config_.unicast) {
+    resp.unicast_address = unicastAddressByte(*id);
+    resp.group_address =
+        groupAddressByte(static_cast<uint8_t>((*id - 1) / config_.group_size));
+  }
+  // Kanaldaki bütün drone'lar BASE_RX'i dinler: ACK'siz, kaybolan yanıtın
+  // sahibi isteğini tekrarlar
+  radios_[frame_radio_]->sendTo(BASE_RX, &resp, sizeof(resp), true);
+  stats_.joins++;
+}
+
+std::optional<DroneIdType>
+GroundStation::assignId(const JoinRequestPacket &req) {
+  if (req.temp_id == 0 || req.nonce == 0)
+    return std::nullopt;
+  // Yanıtı kaybolan drone aynı istekle tekrar gelir: aynı kimlik
+  for (size_t id = 1; id <= GBS_MAX_DRONES; ++id)
+    if (table_.nonce[id] == req.nonce && table_.temp_id[id] == req.temp_id)
+      return static_cast<DroneIdType>(id);
+
+  for (size_t id = 1; id <= GBS_MAX_DRONES; ++id) {
+    if (table_.temp_id[id])
+      continue;
+    const auto assigned = static_cast<DroneIdType>(id);
+    const uint8_t radio = leastLoadedRadio();
+    table_.clear(assigned);
+    table_.temp_id[id] = req.temp_id;
+    table_.nonce[id] = req.nonce;
+    table_.radio[id] = radio;
+    table_.joined_us[id] = frame_rx_us_;
+    std::memcpy(table_.name[id].data(), req.requested_name,
+                MAX_NODE_NAME_LENGTH);
+    table_.name[id].back() = '\0';
+    (*decoders_)[id].reset();
+    return assigned;
+  }
+  return std::nullopt;
+}
+
+void GroundStation::release(DroneIdType id) {
+  if (leaders_[table_.radio[id]] == id)
+    leaders_[table_.radio[id]].reset();
+  table_.clear(id);
+  (*decoders_)[id].reset();
+}
@@ -0,0 +1,254 @@
+#include "../include/imu_filter.hpp"
+#include "../include/imu_filter_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+struct ScalarTraits {
+  using F = float;
+  using M = bool;
+  static constexpr size_t W = 1;
+  static F load(const float *p) { return *p; }
+  static void store(float *p, F v) { *p = v; }
+  static F loadi16(const int16_t *p) { return static_cast<float>(*p); }
+  static F set1(float v) { return v; }
+  static F add(F a, F b) { return a + b; }
+  static F sub(F a, F b) { return a - b; }
+  static F mul(F a, F b) { return a * b; }
+  static F div(F a, F b) { return a / b; }
+  static F fmadd(F a, F b, F c) { return a * b + c; }
+  static F sqrt(F a) { return std::sqrt(a); }
+  static F abs(F a) { return std::fabs(a); }
+  static F min(F a, F b) { return a < b ? a : b; }
+  static F max(F a, F b) { return a > b ? a : b; }
+  static M gt(F a, F b) { return a > b; }
+  static F select(M m, F a, F b) { return m ? a : b; }
+  static F copysign(F a, F s) { return std::copysign(a, s); }
+};
+
+#if defined(__SSE2__)
+struct Sse2Traits {
+  using F = __m128;
+  using M = __m128;
+  static constexpr size_t W = 4;
+  static F load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, F v) { _mm_storeu_ps(p, v); }
+  static F loadi16(const int16_t *p) {
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+    // Sign-extend by placing each int16 in the top half of an int32.
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+  }
+  static F set1(float v) { return _mm_set1_ps(v); }
+  static F add(F a, F b) { return _mm_add_ps(a, b); }
+  static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+  static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+  static F div(F a, F b) { return _mm_div_ps(a, b); }
+  static F fmadd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static F sqrt(F a) { return _mm_sqrt_ps(a); }
+  static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+  static F min(F a, F b) { return _mm_min_ps(a, b); }
+  static F max(F a, F b) { return _mm_max_ps(a, b); }
+  static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+  static F select(M m, F a, F b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+  static F copysign(F a, F s) {
+    const F sign = _mm_set1_ps(-0.0f);
+    return _mm_or_ps(_mm_andnot_ps(sign, a), _mm_and_ps(sign, s));
+  }
+};
+using SimdTraits = Sse2Traits;
+constexpr const char *SIMD_NAME = "sse2";
+#elif defined(__ARM_NEON)
+struct NeonTraits {
+  using F = float32x4_t;
+  using M = uint32x4_t;
+  static constexpr size_t W = 4;
+  static F load(const float *p) { return vld1q_f32(p); }
+  static void store(float *p, F v) { vst1q_f32(p, v); }
+  static F loadi16(const int16_t *p) {
+    return vcvtq_f32_s32(vmovl_s16(vld1_s16(p)));
+  }
+  static F set1(float v) { return vdupq_n_f32(v); }
+  static F add(F a, F b) { return vaddq_f32(a, b); }
+  static F sub(F a, F b) { return vsubq_f32(a, b); }
+  static F mul(F a, F b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+  static F div(F a, F b) { return vdivq_f32(a, b); }
+  static F sqrt(F a) { return vsqrtq_f32(a); }
+  static F fmadd(F a, F b, F c) { return vfmaq_f32(c, a, b); }
+#else
+  // ARMv7 NEON has no divide or square root: estimate and refine twice.
+  static F div(F a, F b) {
+    F r = vrecpeq_f32(b);
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    return vmulq_f32(a, r);
+  }
+  static F sqrt(F a) {
+    const F x = vmaxq_f32(a, vdupq_n_f32(1e-30f));
+    F r = vrsqrteq_f32(x);
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    return vmulq_f32(x, r);
+  }
+  static F fmadd(F a, F b, F c) { return vmlaq_f32(c, a, b); }
+#endif
+  static F abs(F a) { return vabsq_f32(a); }
+  static F min(F a, F b) { return vminq_f32(a, b); }
+  static F max(F a, F b) { return vmaxq_f32(a, b); }
+  static M gt(F a, F b) { return vcgtq_f32(a, b); }
+  static F select(M m, F a, F b) { return vbslq_f32(m, a, b); }
+  static F copysign(F a, F s) {
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    return vbslq_f32(sign, s, a);
+  }
+};
+using SimdTraits = NeonTraits;
+constexpr const char *SIMD_NAME = "neon";
+#endif
+
+// Windowed-sinc low-pass (Hamming), unity gain at DC.
+void designLowPass(float *taps, float cutoff_hz, float rate_hz) {
+  constexpr double TWO_PI = 6.283185307179586;
+  const double fc = std::clamp<double>(cutoff_hz / rate_hz, 1e-4, 0.49);
+  const double mid = (IMU_FIR_TAPS - 1) / 2.0;
+  double h[IMU_FIR_TAPS];
+  double sum = 0.0;
+  for (size_t k = 0; k < IMU_FIR_TAPS; ++k) {
+    const double t = TWO_PI * fc * (static_cast<double>(k) - mid);
+    const double sinc = t == 0.0 ? 1.0 : std::sin(t) / t;
+    const double window =
+        0.54 - 0.46 * std::cos(TWO_PI * static_cast<double>(k) /
+                               (IMU_FIR_TAPS - 1));
+    h[k] = sinc * window;
+    sum += h[k];
+  }
+  for (size_t k = 0; k < IMU_FIR_TAPS; ++k)
+    taps[k] = static_cast<float>(h[k] / sum);
+}
+
+} // namespace
+
+const ImuKernelOps &imuScalarKernels() {
+  static const ImuKernelOps ops = imuMakeKernels<ScalarTraits>("scalar");
+  return ops;
+}
+
+const ImuKernelOps *imuSimdKernels() {
+#ifdef RF24DRONE_HAS_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return &imuAvx2Kernels();
+#endif
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  static const ImuKernelOps ops = imuMakeKernels<SimdTraits>(SIMD_NAME);
+  return &ops;
+#else
+  return nullptr;
+#endif
+}
+
+size_t appendSamples(ImuBlock &block, const ImuSample *samples, size_t n) {
+  n = std::min(n, IMU_BLOCK - block.count);
+  for (size_t i = 0; i < n; ++i) {
+    const ImuSample &s = samples[i];
+    const size_t j = block.count + i;
+    block.raw[IMU_AX][j] = s.accel[0];
+    block.raw[IMU_AY][j] = s.accel[1];
+    block.raw[IMU_AZ][j] = s.accel[2];
+    block.raw[IMU_GX][j] = s.gyro[0];
+    block.raw[IMU_GY][j] = s.gyro[1];
+    block.raw[IMU_GZ][j] = s.gyro[2];
+  }
+  block.count += n;
+  return n;
+}
+
+// ==================== ImuFilter ==================== //
+
+ImuFilter::ImuFilter(ImuFilterConfig config, ImuCalibration cal,
+                     ImuKernel kernel)
+    : config_(config), cal_(cal) {
+  const ImuKernelOps *simd =
+      kernel == ImuKernel::SCALAR ? nullptr : imuSimdKernels();
+  ops_ = simd ? simd : &imuScalarKernels();
+  designLowPass(taps_, config_.cutoff_hz, config_.sample_rate_hz);
+  dt_ = 1.0f / config_.sample_rate_hz;
+  alpha_ = config_.attitude_tau_s / (config_.attitude_tau_s + dt_);
+  reset();
+}
+
+void ImuFilter::reset() {
+  std::memset(work_, 0, sizeof(work_));
+  primed_ = false;
+  roll_ = 0.0f;
+  pitch_ = 0.0f;
+}
+
+const char *ImuFilter::kernelName() const { return ops_->name; }
+
+void ImuFilter::process(ImuBlock &block) {
+  const size_t count = block.count;
+  if (count == 0)
+    return;
+  // Kernels work in whole vectors; lanes past `count` are ignored.
+  const size_t n = (count + 7) & ~size_t{7};
+
+  for (size_t c = 0; c < IMU_CHANNELS; ++c) {
+    const float scale = c < IMU_GX ? cal_.accel_scale : cal_.gyro_scale;
+    float *in = work_[c] + HISTORY;
+    ops_->calibrate(block.raw[c], in, n, cal_.bias[c], scale);
+    // Start from a steady state instead of ramping up from zero.
+    if (!primed_)
+      std::fill(work_[c], in, in[0]);
+    ops_->fir(in, block.value[c], n, taps_);
+    std::memmove(work_[c], work_[c] + count, HISTORY * sizeof(float));
+  }
+
+  ops_->attitude(block.value[IMU_AX], block.value[IMU_AY],
+                 block.value[IMU_AZ], block.value[IMU_GX],
+                 block.value[IMU_GY], block.roll, block.pitch, n, alpha_,
+                 dt_);
+  if (!primed_) {
+    const float ax = block.value[IMU_AX][0];
+    const float ay = block.value[IMU_AY][0];
+    const float az = block.value[IMU_AZ][0];
+    roll_ = std::atan2(ay, az);
+    pitch_ = std::atan2(-ax, std::sqrt(ay * ay + az * az));
+    primed_ = true;
+  }
+  // The recursion itself is serial.
+  for (size_t i = 0; i < count; ++i) {
+    roll_ = alpha_ * roll_ + block.roll[i];
+    pitch_ = alpha_ * pitch_ + block.pitch[i];
+    block.roll[i] = roll_;
+    block.pitch[i] = pitch_;
+  }
+}
+
+ImuCalibration ImuFilter::calibrateStationary(const ImuSample *samples,
+                                              size_t n, ImuCalibration base) {
+  if (n == 0)
+    return base;
+  double sum[IMU_CHANNELS] = {};
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t c = 0; c < 3; ++c) {
+      sum[c] += samples[i].accel[c];
+      sum[IMU_GX + c] += samples[i].gyro[c];
+    }
+  }
+  for (size_t c = 0; c < IMU_CHANNELS; ++c)
+    base.bias[c] = static_cast<float>(sum[c] / static_cast<double>(n));
+  // Gravity stays on Z.
+  base.bias[IMU_AZ] -= 1.0f / base.accel_scale;
+  return base;
+}
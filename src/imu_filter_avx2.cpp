@@ -0,0 +1,41 @@
+// AVX2 + FMA instantiation of the IMU kernels. Built with -mavx2 -mfma and
+// only entered after imuSimdKernels() has checked the CPU.
+#include "../include/imu_filter_kernels.hpp"
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Traits {
+  using F = __m256;
+  using M = __m256;
+  static constexpr size_t W = 8;
+  static F load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, F v) { _mm256_storeu_ps(p, v); }
+  static F loadi16(const int16_t *p) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+  }
+  static F set1(float v) { return _mm256_set1_ps(v); }
+  static F add(F a, F b) { return _mm256_add_ps(a, b); }
+  static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+  static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+  static F div(F a, F b) { return _mm256_div_ps(a, b); }
+  static F fmadd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+  static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+  static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+  static F min(F a, F b) { return _mm256_min_ps(a, b); }
+  static F max(F a, F b) { return _mm256_max_ps(a, b); }
+  static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+  static F copysign(F a, F s) {
+    const F sign = _mm256_set1_ps(-0.0f);
+    return _mm256_or_ps(_mm256_andnot_ps(sign, a), _mm256_and_ps(sign, s));
+  }
+};
+
+} // namespace
+
+const ImuKernelOps &imuAvx2Kernels() {
+  static const ImuKernelOps ops = imuMakeKernels<Avx2Traits>("avx2");
+  return ops;
+}
@@ -0,0 +1,159 @@
+#include "../include/link_adapter.hpp"
+#include "../include/tdma.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// At 250 kbps an ACK carrying a command needs 1500 us before a
+// retransmission, 500 us covers any ACK payload at 1 and 2 Mbps.
+constexpr std::array<LinkSettings, LinkAdapter::RUNGS> LADDER{{
+    {RadioDataRate::LOW_RATE, RadioPowerLevel::MAX_POWER, 5, 15},
+    {RadioDataRate::MEDIUM_RATE, RadioPowerLevel::MAX_POWER, 1, 15},
+    {RadioDataRate::HIGH_RATE, RadioPowerLevel::MAX_POWER, 1, 5},
+    {RadioDataRate::HIGH_RATE, RadioPowerLevel::HIGH_POWER, 1, 3},
+    {RadioDataRate::HIGH_RATE, RadioPowerLevel::LOW_POWER, 1, 3},
+}};
+
+} // namespace
+
+LinkAdapter::LinkAdapter(LinkAdapterConfig config)
+    : config_(config), up_windows_(config.up_windows) {
+  config_.max_rung = static_cast<uint8_t>(
+      std::min<size_t>(config_.max_rung, RUNGS - 1));
+  config_.min_rung = std::min(config_.min_rung, config_.max_rung);
+  config_.base_rung =
+      std::clamp(config_.base_rung, config_.min_rung, config_.max_rung);
+  config_.window = std::max<uint8_t>(config_.window, 1);
+  rung_ = config_.base_rung;
+}
+
+LinkSettings LinkAdapter::rungSettings(size_t rung) {
+  return LADDER[std::min(rung, RUNGS - 1)];
+}
+
+void LinkAdapter::reset() {
+  rung_ = config_.base_rung;
+  up_windows_ = config_.up_windows;
+  clean_windows_ = 0;
+  probing_ = false;
+  skip_arc_ = false;
+  miss_run_ = 0;
+  clearWindow();
+}
+
+void LinkAdapter::clearWindow() {
+  slots_ = 0;
+  misses_ = 0;
+  received_ = 0;
+  arc_sum_ = 0;
+  rpd_ = 0;
+}
+
+void LinkAdapter::step(size_t rung) {
+  if (rung > rung_)
+    steps_up_++;
+  else
+    steps_down_++;
+  rung_ = rung;
+  clean_windows_ = 0;
+  miss_run_ = 0;
+  skip_arc_ = true;
+  clearWindow();
+}
+
+void LinkAdapter::record(bool received, uint8_t arc, bool rpd) {
+  slots_++;
+  if (received) {
+    miss_run_ = 0;
+    if (skip_arc_) {
+      skip_arc_ = false; // measured on the previous rung
+    } else {
+      received_++;
+      arc_sum_ += arc;
+      rpd_ += rpd ? 1 : 0;
+    }
+  } else {
+    misses_++;
+    miss_run_++;
+  }
+
+  // Uplinks stopped: the follower may have missed a LinkControl
+  if (miss_run_ >= config_.fallback_misses) {
+    if (rung_ != config_.base_rung) {
+      fallbacks_++;
+      step(config_.base_rung);
+    }
+    return;
+  }
+
+  const float mean_arc =
+      received_ ? static_cast<float>(arc_sum_) / received_ : 0.0f;
+  const bool window_done = slots_ >= config_.window;
+  const bool bad = misses_ >= config_.down_misses ||
+                   (window_done && mean_arc >= config_.down_arc);
+  if (bad) {
+    if (probing_)
+      up_windows_ = std::min<uint8_t>(up_windows_ * 2, MAX_UP_WINDOWS);
+    probing_ = false;
+    if (rung_ > config_.min_rung)
+      step(rung_ - 1);
+    else
+      clearWindow();
+    return;
+  }
+  if (!window_done)
+    return;
+
+  if (probing_) {
+    probing_ = false; // the new rung held for a window
+    up_windows_ = config_.up_windows;
+  }
+  const bool clean =
+      misses_ <= config_.up_misses && mean_arc <= config_.up_arc;
+  clean_windows_ = clean ? clean_windows_ + 1 : 0;
+  if (clean && clean_windows_ >= up_windows_ && rung_ < config_.max_rung) {
+    // Düşük PA yalnızca güçlü bağlantılarda
+    const bool lowers_power =
+        rungSettings(rung_ + 1).power < rungSettings(rung_).power;
+    if (!lowers_power || rpd_ >= config_.up_rpd * received_) {
+      step(rung_ + 1);
+      probing_ = true;
+      return;
+    }
+  }
+  clearWindow();
+}
+
+uint8_t retriesWithin(uint32_t budget_us, size_t payload, RadioDataRate rate,
+                      uint8_t retry_delay, uint8_t max_count) {
+  const uint32_t attempt = tdmaExchangeUs(payload, rate);
+  if (budget_us <= attempt)
+    return 0;
+  const uint32_t retry = attempt + 250u * (retry_delay + 1u);
+  return static_cast<uint8_t>(
+      std::min<uint32_t>((budget_us - attempt) / retry, max_count));
+}
+
+LinkControlPacket makeLinkControl(DroneIdType target,
+                                  const LinkSettings &settings,
+                                  uint32_t timestamp) {
+  LinkControlPacket ctl{};
+  ctl.target_drone_id = target;
+  ctl.timestamp = timestamp;
+  ctl.data_rate = static_cast<uint8_t>(settings.rate);
+  ctl.power_level = static_cast<uint8_t>(settings.power);
+  ctl.retries = packRetries(settings.retry_delay, settings.retry_count);
+  return ctl;
+}
+
+LinkSettings linkSettingsFrom(const LinkControlPacket &ctl) {
+  LinkSettings settings;
+  settings.rate = static_cast<RadioDataRate>(std::min<uint8_t>(
+      ctl.data_rate, static_cast<uint8_t>(RadioDataRate::HIGH_RATE)));
+  settings.power = static_cast<RadioPowerLevel>(std::min<uint8_t>(
+      ctl.power_level, static_cast<uint8_t>(RadioPowerLevel::MAX_POWER)));
+  settings.retry_delay = ctl.retries >> 4;
+  settings.retry_count = ctl.retries & 0x0F;
+  return settings;
+}
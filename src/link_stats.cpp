@@ -0,0 +1,103 @@
+#include "../include/link_stats.hpp"
+#include "../include/transport.hpp"
+#include <algorithm>
+
+namespace {
+
+uint16_t bump(uint16_t counter, uint32_t by = 1) {
+  return static_cast<uint16_t>(std::min<uint32_t>(counter + by, UINT16_MAX));
+}
+
+} // namespace
+
+LinkStatsTable::LinkStatsTable(LinkStatsConfig config) : config_(config) {
+  config_.window_us = std::max<uint32_t>(config_.window_us, 1);
+}
+
+LinkStatsTable::Entry &LinkStatsTable::roll(DroneIdType peer,
+                                            uint64_t now_us) {
+  Entry &e = entries_[peer];
+  const auto index = static_cast<uint32_t>(now_us / config_.window_us);
+  if (index != e.window_index) {
+    // Pencere boyunca olay yoksa son pencere boştur
+    e.last = index == e.window_index + 1 ? e.current : LinkWindow{};
+    e.current = {};
+    e.window_index = index;
+  }
+  return e;
+}
+
+void LinkStatsTable::update(Entry &e, uint8_t bit, float &avg, float sample) {
+  if (!(e.primed & bit)) {
+    avg = sample;
+    e.primed |= bit;
+    return;
+  }
+  avg += config_.alpha * (sample - avg);
+}
+
+void LinkStatsTable::recordTx(DroneIdType peer, bool acked, uint8_t arc,
+                              uint64_t now_us) {
+  Entry &e = roll(peer, now_us);
+  e.current.attempts = bump(e.current.attempts);
+  if (acked)
+    e.current.delivered = bump(e.current.delivered);
+  update(e, DELIVERY, e.delivery, acked ? 1.0f : 0.0f);
+  if (arc == TX_ARC_UNKNOWN)
+    return; // burst ortasındaki çerçeve: teslim sayılır, ARC'si yok
+  e.current.retries = bump(e.current.retries, arc);
+  update(e, RETRIES, e.retries, arc);
+}
+
+void LinkStatsTable::recordSlot(DroneIdType peer, bool heard, bool rpd,
+                                uint64_t now_us) {
+  Entry &e = roll(peer, now_us);
+  e.current.attempts = bump(e.current.attempts);
+  update(e, DELIVERY, e.delivery, heard ? 1.0f : 0.0f);
+  if (!heard)
+    return;
+  e.current.delivered = bump(e.current.delivered);
+  if (rpd)
+    e.current.rpd_hits = bump(e.current.rpd_hits);
+  update(e, RPD, e.rpd, rpd ? 1.0f : 0.0f);
+}
+
+void LinkStatsTable::recordRx(DroneIdType peer, uint64_t now_us) {
+  Entry &e = roll(peer, now_us);
+  e.current.received = bump(e.current.received);
+  if (e.last_rx_us && now_us > e.last_rx_us) {
+    const uint64_t gap = now_us - e.last_rx_us;
+    e.current.max_gap_us = static_cast<uint32_t>(
+        std::max<uint64_t>(e.current.max_gap_us, std::min<uint64_t>(
+                                                     gap, UINT32_MAX)));
+    update(e, GAP, e.gap_us, static_cast<float>(gap));
+  }
+  e.last_rx_us = now_us;
+}
+
+LinkQuality LinkStatsTable::quality(DroneIdType peer, uint64_t now_us) const {
+  const Entry &e = entries_[peer];
+  LinkQuality q;
+  q.seen = e.primed != 0 || e.last_rx_us != 0;
+  q.delivery = e.delivery;
+  q.retries = e.retries;
+  q.rpd = e.rpd;
+  q.gap_us = e.gap_us;
+  const auto index = static_cast<uint32_t>(now_us / config_.window_us);
+  if (index == e.window_index)
+    q.window = e.last;
+  else if (index == e.window_index + 1)
+    q.window = e.current;
+  if (e.last_rx_us && now_us > e.last_rx_us)
+    q.silent_us = now_us - e.last_rx_us;
+  return q;
+}
+
+float LinkStatsTable::deliveryPercent(DroneIdType peer) const {
+  const Entry &e = entries_[peer];
+  return e.primed & DELIVERY ? 100.0f * e.delivery : 100.0f;
+}
+
+void LinkStatsTable::reset(DroneIdType peer) { entries_[peer] = Entry{}; }
+
+void LinkStatsTable::clear() { entries_.fill(Entry{}); }
@@ -0,0 +1,256 @@
+#include "../include/metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace metrics_detail {
+
+std::atomic<MetricsSegment *> segment{nullptr};
+std::atomic<uint32_t> generation{0};
+constinit thread_local ThreadShard local{};
+
+namespace {
+
+// Hands the shard back when its thread exits.
+struct ShardRelease {
+  ~ShardRelease() {
+    MetricsSegment *seg = segment.load(std::memory_order_acquire);
+    if (!seg || !local.shard ||
+        local.generation != generation.load(std::memory_order_relaxed))
+      return;
+    seg->threads.fetch_sub(1, std::memory_order_relaxed);
+    if (!local.shared)
+      local.shard->claimed.store(0, std::memory_order_release);
+    local = {};
+  }
+};
+
+} // namespace
+
+ThreadShard &claimShard(MetricsSegment *seg) {
+  thread_local ShardRelease release;
+  (void)release;
+
+  local.generation = generation.load(std::memory_order_acquire);
+  local.shared = true;
+  local.shard = &seg->shards[METRICS_MAX_SHARDS - 1];
+  for (size_t i = 0; i + 1 < METRICS_MAX_SHARDS; i++) {
+    uint32_t expected = 0;
+    if (seg->shards[i].claimed.compare_exchange_strong(
+            expected, 1, std::memory_order_acquire)) {
+      local.shard = &seg->shards[i];
+      local.shared = false;
+      break;
+    }
+  }
+  seg->threads.fetch_add(1, std::memory_order_relaxed);
+  return local;
+}
+
+} // namespace metrics_detail
+
+namespace {
+
+std::string shm_name;
+bool shm_shared = false;
+
+MetricsSegment *mapSegment(const std::string &name, bool &shared) {
+  constexpr size_t size = sizeof(MetricsSegment);
+  shared = false;
+  void *mem = MAP_FAILED;
+  if (!name.empty()) {
+    shm_unlink(name.c_str()); // leftovers of a crashed run
+    const int fd =
+        shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+      if (ftruncate(fd, size) == 0)
+        mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (mem == MAP_FAILED)
+        shm_unlink(name.c_str());
+      else
+        shared = true;
+    }
+  }
+  if (mem == MAP_FAILED)
+    mem = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    return nullptr;
+
+  // Fresh mappings are zero filled, which is every counter's start value
+  auto *seg = new (mem) MetricsSegment;
+  seg->version = METRICS_VERSION;
+  seg->size = static_cast<uint32_t>(size);
+  seg->pid = static_cast<int32_t>(getpid());
+  seg->started_unix_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  std::atomic_thread_fence(std::memory_order_release);
+  seg->magic = METRICS_MAGIC; // readers wait for it
+  return seg;
+}
+
+void snapshotHistogram(const MetricsHistogramData &d, HistogramSnapshot &out) {
+  out.count += d.count.load(std::memory_order_relaxed);
+  out.sum += d.sum.load(std::memory_order_relaxed);
+  out.max = std::max(out.max, d.max.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < METRICS_BUCKETS; i++)
+    out.buckets[i] += d.buckets[i].load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+bool metricsOpen(const std::string &name) {
+  metricsClose();
+  bool shared = false;
+  MetricsSegment *seg = mapSegment(name, shared);
+  if (!seg)
+    return false;
+  shm_name = shared ? name : std::string();
+  shm_shared = shared;
+  metrics_detail::generation.fetch_add(1, std::memory_order_release);
+  metrics_detail::segment.store(seg, std::memory_order_release);
+  return shared;
+}
+
+void metricsClose() {
+  MetricsSegment *seg =
+      metrics_detail::segment.exchange(nullptr, std::memory_order_acq_rel);
+  if (!seg)
+    return;
+  munmap(seg, sizeof(MetricsSegment));
+  if (shm_shared)
+    shm_unlink(shm_name.c_str());
+  shm_name.clear();
+  shm_shared = false;
+}
+
+bool metricsEnabled() { return metricsActive(); }
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+  if (!count)
+    return 0;
+  const auto target = static_cast<uint64_t>(
+      std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < METRICS_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= std::max<uint64_t>(target, 1))
+      return std::min(metricsBucketFloor(i), max);
+  }
+  return max;
+}
+
+MetricsSnapshot metricsSnapshot(const MetricsSegment &segment) {
+  MetricsSnapshot out;
+  out.pid = segment.pid;
+  out.started_unix_us = segment.started_unix_us;
+  out.threads = segment.threads.load(std::memory_order_relaxed);
+  for (const MetricsShard &shard : segment.shards) {
+    for (size_t i = 0; i < METRIC_COUNTERS; i++)
+      out.counters[i] += shard.counters[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < METRICS_PACKET_TYPES; i++) {
+      out.rx_packets[i] += shard.rx_packets[i].load(std::memory_order_relaxed);
+      out.tx_packets[i] += shard.tx_packets[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < METRIC_HISTOGRAMS; i++)
+      snapshotHistogram(shard.histograms[i], out.histograms[i]);
+  }
+  return out;
+}
+
+bool metricsSnapshot(MetricsSnapshot &out) {
+  MetricsSegment *seg =
+      metrics_detail::segment.load(std::memory_order_acquire);
+  if (!seg)
+    return false;
+  out = metricsSnapshot(*seg);
+  return true;
+}
+
+MetricsReader::~MetricsReader() { close(); }
+
+bool MetricsReader::open(const std::string &name) {
+  close();
+  const int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0)
+    return false;
+  struct stat st {};
+  void *mem = MAP_FAILED;
+  if (fstat(fd, &st) == 0 &&
+      static_cast<size_t>(st.st_size) == sizeof(MetricsSegment))
+    mem = mmap(nullptr, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED)
+    return false;
+  segment_ = static_cast<const MetricsSegment *>(mem);
+  return true;
+}
+
+void MetricsReader::close() {
+  if (segment_) {
+    munmap(const_cast<MetricsSegment *>(segment_), sizeof(MetricsSegment));
+    segment_ = nullptr;
+  }
+}
+
+bool MetricsReader::read(MetricsSnapshot &out) const {
+  if (!segment_ || segment_->magic != METRICS_MAGIC ||
+      segment_->version != METRICS_VERSION ||
+      segment_->size != sizeof(MetricsSegment))
+    return false;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  out = metricsSnapshot(*segment_);
+  return true;
+}
+
+const char *metricCounterName(MetricCounter c) {
+  switch (c) {
+  case MetricCounter::SEND_OK:
+    return "send_ok";
+  case MetricCounter::SEND_FAILED:
+    return "send_failed";
+  case MetricCounter::FRAMES_RX:
+    return "frames_rx";
+  case MetricCounter::ACK_PAYLOADS_RX:
+    return "ack_payloads_rx";
+  case MetricCounter::ACK_PAYLOADS_HELD:
+    return "ack_payloads_held";
+  case MetricCounter::POLL_CALLS:
+    return "poll_calls";
+  case MetricCounter::RX_THREAD_WAKEUPS:
+    return "rx_thread_wakeups";
+  case MetricCounter::RX_RING_STALLS:
+    return "rx_ring_stalls";
+  case MetricCounter::COUNT:
+    break;
+  }
+  return "?";
+}
+
+const char *metricHistogramName(MetricHistogram h) {
+  switch (h) {
+  case MetricHistogram::RADIO_SEND:
+    return "radio_send_ns";
+  case MetricHistogram::RADIO_RECEIVE:
+    return "radio_receive_ns";
+  case MetricHistogram::DISPATCH:
+    return "dispatch_ns";
+  case MetricHistogram::HANDLE_INCOMING:
+    return "handle_incoming_ns";
+  case MetricHistogram::POLL_BATCH:
+    return "poll_batch";
+  case MetricHistogram::RX_THREAD_BATCH:
+    return "rx_thread_batch";
+  case MetricHistogram::COUNT:
+    break;
+  }
+  return "?";
+}
@@ -2,12 +2,53 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
 #include <cstring>
 
+namespace {
+
+constexpr uint8_t REG_SMPLRT_DIV = 0x19;
+constexpr uint8_t REG_CONFIG = 0x1A;
+constexpr uint8_t REG_FIFO_EN = 0x23;
+constexpr uint8_t REG_ACCEL_XOUT_H = 0x3B;
+constexpr uint8_t REG_GYRO_XOUT_H = 0x43;
+constexpr uint8_t REG_USER_CTRL = 0x6A;
+constexpr uint8_t REG_PWR_MGMT_1 = 0x6B;
+constexpr uint8_t REG_FIFO_COUNT_H = 0x72;
+constexpr uint8_t REG_FIFO_R_W = 0x74;
+
+// FIFO_EN: temperature, gyro X/Y/Z and accel. The FIFO stores them in
+// register order, so a FIFO record has the same layout as 0x3B..0x48.
+constexpr uint8_t FIFO_EN_SAMPLE = 0xF8;
+constexpr uint8_t USER_CTRL_FIFO_EN = 0x40;
+constexpr uint8_t USER_CTRL_FIFO_RESET = 0x04;
+// DLPF 188 Hz: gyro output rate 1 kHz, the base of SMPLRT_DIV.
+constexpr uint8_t CONFIG_DLPF_188HZ = 0x01;
+
+int16_t be16(const uint8_t *p) {
+  return static_cast<int16_t>((p[0] << 8) | p[1]);
+}
+
+void decodeSample(const uint8_t *p, ImuSample &s) {
+  s.accel[0] = be16(p);
+  s.accel[1] = be16(p + 2);
+  s.accel[2] = be16(p + 4);
+  s.temperature = be16(p + 6);
+  s.gyro[0] = be16(p + 8);
+  s.gyro[1] = be16(p + 10);
+  s.gyro[2] = be16(p + 12);
+}
+
+} // namespace
+
 Mpu6050::~Mpu6050() {
   if (fd >= 0) {
+    if (fifo_enabled)
+      disableFifo();
     close(fd);
   }
 }
@@ -23,8 +64,7 @@ bool Mpu6050::init(const std::string &device, uint8_t addr) {
     return false;
   }
   // Wake up the device by clearing sleep bit in PWR_MGMT_1
-  uint8_t buf[2] = {0x6B, 0x00};
-  if (write(fd, buf, 2) != 2) {
+  if (!writeRegister(REG_PWR_MGMT_1, 0x00)) {
     close(fd);
     fd = -1;
     return false;
@@ -32,23 +72,43 @@ bool Mpu6050::init(const std::string &device, uint8_t addr) {
   return true;
 }
 
-static bool readRegisters(int fd, uint8_t reg, uint8_t *data, size_t len) {
+// Register address write and data read joined by a repeated start: one
+// I2C transaction and one syscall. Falls back to a write() + read() pair
+// on adapters without I2C_RDWR.
+bool Mpu6050::readRegisters(uint8_t reg, uint8_t *data, size_t len) {
+  if (combined_rw) {
+    i2c_msg msgs[2] = {
+        {address, 0, 1, &reg},
+        {address, I2C_M_RD, static_cast<uint16_t>(len), data},
+    };
+    i2c_rdwr_ioctl_data xfer{msgs, 2};
+    if (ioctl(fd, I2C_RDWR, &xfer) == 2)
+      return true;
+    if (errno != EOPNOTSUPP && errno != ENOTTY && errno != EINVAL)
+      return false;
+    combined_rw = false;
+  }
   if (write(fd, &reg, 1) != 1)
     return false;
-  if (read(fd, data, len) != static_cast<int>(len))
+  if (read(fd, data, len) != static_cast<ssize_t>(len))
     return false;
   return true;
 }
 
+bool Mpu6050::writeRegister(uint8_t reg, uint8_t value) {
+  uint8_t buf[2] = {reg, value};
+  return write(fd, buf, 2) == 2;
+}
+
 bool Mpu6050::readAcceleration(int16_t &ax, int16_t &ay, int16_t &az) {
   if (fd < 0)
     return false;
   uint8_t data[6];
-  if (!readRegisters(fd, 0x3B, data, sizeof(data)))
+  if (!readRegisters(REG_ACCEL_XOUT_H, data, sizeof(data)))
     return false;
-  ax = static_cast<int16_t>((data[0] << 8) | data[1]);
-  ay = static_cast<int16_t>((data[2] << 8) | data[3]);
-  az = static_cast<int16_t>((data[4] << 8) | data[5]);
+  ax = be16(data);
+  ay = be16(data + 2);
+  az = be16(data + 4);
   return true;
 }
 
@@ -56,10 +116,75 @@ bool Mpu6050::readGyro(int16_t &gx, int16_t &gy, int16_t &gz) {
   if (fd < 0)
     return false;
   uint8_t data[6];
-  if (!readRegisters(fd, 0x43, data, sizeof(data)))
+  if (!readRegisters(REG_GYRO_XOUT_H, data, sizeof(data)))
+    return false;
+  gx = be16(data);
+  gy = be16(data + 2);
+  gz = be16(data + 4);
+  return true;
+}
+
+bool Mpu6050::readSample(ImuSample &sample) {
+  if (fd < 0)
+    return false;
+  uint8_t data[MPU6050_SAMPLE_BYTES];
+  if (!readRegisters(REG_ACCEL_XOUT_H, data, sizeof(data)))
     return false;
-  gx = static_cast<int16_t>((data[0] << 8) | data[1]);
-  gy = static_cast<int16_t>((data[2] << 8) | data[3]);
-  gz = static_cast<int16_t>((data[4] << 8) | data[5]);
+  decodeSample(data, sample);
   return true;
 }
+
+// ==================== FIFO ==================== //
+
+bool Mpu6050::resetFifo() {
+  return writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET) &&
+         writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+bool Mpu6050::enableFifo(uint16_t rate_hz) {
+  if (fd < 0)
+    return false;
+  rate_hz = std::clamp<uint16_t>(rate_hz, 4, MPU6050_MAX_RATE_HZ);
+  const uint8_t div = static_cast<uint8_t>(MPU6050_MAX_RATE_HZ / rate_hz - 1);
+  if (!writeRegister(REG_USER_CTRL, 0x00) ||
+      !writeRegister(REG_CONFIG, CONFIG_DLPF_188HZ) ||
+      !writeRegister(REG_SMPLRT_DIV, div) ||
+      !writeRegister(REG_FIFO_EN, FIFO_EN_SAMPLE) || !resetFifo())
+    return false;
+  sample_rate_hz = static_cast<uint16_t>(MPU6050_MAX_RATE_HZ / (div + 1));
+  fifo_enabled = true;
+  return true;
+}
+
+void Mpu6050::disableFifo() {
+  if (fd < 0)
+    return;
+  writeRegister(REG_FIFO_EN, 0x00);
+  writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+  fifo_enabled = false;
+}
+
+int Mpu6050::readFifo(ImuSample *out, size_t max) {
+  if (fd < 0 || !fifo_enabled)
+    return -1;
+  uint8_t count_be[2];
+  if (!readRegisters(REG_FIFO_COUNT_H, count_be, sizeof(count_be)))
+    return -1;
+  const size_t count = static_cast<uint16_t>(be16(count_be));
+  // A full FIFO has overwritten its oldest bytes and lost record alignment.
+  if (count >= MPU6050_FIFO_BYTES) {
+    fifo_overflows++;
+    return resetFifo() ? 0 : -1;
+  }
+
+  // Whole records only; a record being written stays for the next call.
+  const size_t n = std::min(count / MPU6050_SAMPLE_BYTES, max);
+  if (n == 0)
+    return 0;
+  uint8_t data[MPU6050_FIFO_BYTES];
+  if (!readRegisters(REG_FIFO_R_W, data, n * MPU6050_SAMPLE_BYTES))
+    return -1;
+  for (size_t i = 0; i < n; ++i)
+    decodeSample(data + i * MPU6050_SAMPLE_BYTES, out[i]);
+  return static_cast<int>(n);
+}
@@ -1,31 +1,90 @@
 #include "../include/radio.hpp"
+#include "../include/metrics.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <ctime>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#ifdef RF24DRONE_HAS_RF24
+#include "../include/rf24_transport.hpp"
+#endif
+
+#ifdef RF24DRONE_HAS_RF24
 RadioInterface::RadioInterface(uint8_t cePin, uint8_t csnPin)
-    : tx_radio(std::make_unique<RF24>(cePin, csnPin)) {}
+    : tx_radio(std::make_unique<Rf24Transport>(cePin, csnPin)) {}
+
+RadioInterface::RadioInterface(uint8_t cePin, uint8_t csnPin, uint8_t spiPort)
+    : tx_radio(std::make_unique<Rf24Transport>(cePin, csnPin, spiPort)) {}
 
 RadioInterface::RadioInterface(uint8_t txCePin, uint8_t txCsnPin,
                                uint8_t rxCePin, uint8_t rxCsnPin)
-    : tx_radio(std::make_unique<RF24>(txCePin, txCsnPin)),
-      rx_radio(std::make_unique<RF24>(rxCePin, rxCsnPin)), full_duplex(true) {}
+    : tx_radio(std::make_unique<Rf24Transport>(txCePin, txCsnPin)),
+      rx_radio(std::make_unique<Rf24Transport>(rxCePin, rxCsnPin)),
+      full_duplex(true) {}
 
 RadioInterface::RadioInterface(uint8_t txCePin, uint8_t txCsnPin,
                                uint8_t txSpiPort, uint8_t rxCePin,
                                uint8_t rxCsnPin, uint8_t rxSpiPort)
-    : tx_radio(std::make_unique<RF24>(txCePin, txCsnPin, txSpiPort)),
-      rx_radio(std::make_unique<RF24>(rxCePin, rxCsnPin, rxSpiPort)),
+    : tx_radio(std::make_unique<Rf24Transport>(txCePin, txCsnPin, txSpiPort)),
+      rx_radio(std::make_unique<Rf24Transport>(rxCePin, rxCsnPin, rxSpiPort)),
       full_duplex(true) {}
+#else
+// Built without the RF24 submodule: only custom transports are available.
+RadioInterface::RadioInterface(uint8_t, uint8_t) {
+  throw std::runtime_error("RadioInterface: built without RF24 support");
+}
+
+RadioInterface::RadioInterface(uint8_t, uint8_t, uint8_t) {
+  throw std::runtime_error("RadioInterface: built without RF24 support");
+}
+
+RadioInterface::RadioInterface(uint8_t, uint8_t, uint8_t, uint8_t) {
+  throw std::runtime_error("RadioInterface: built without RF24 support");
+}
+
+RadioInterface::RadioInterface(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t,
+                               uint8_t) {
+  throw std::runtime_error("RadioInterface: built without RF24 support");
+}
+#endif
+
+RadioInterface::RadioInterface(std::unique_ptr<RadioTransport> transport)
+    : tx_radio(std::move(transport)) {}
+
+RadioInterface::RadioInterface(std::unique_ptr<RadioTransport> tx,
+                               std::unique_ptr<RadioTransport> rx)
+    : tx_radio(std::move(tx)), rx_radio(std::move(rx)),
+      full_duplex(rx_radio != nullptr) {}
+
+RadioInterface::~RadioInterface() {
+  stopTxThread();
+  stopRxThread();
+}
+
+RadioTransport *RadioInterface::rxTransport() {
+  return (full_duplex && rx_radio) ? rx_radio.get() : tx_radio.get();
+}
+
+std::mutex &RadioInterface::txMutex() { return tx_mutex_; }
+
+std::mutex &RadioInterface::rxMutex() {
+  return (full_duplex && rx_radio) ? rx_mutex_ : tx_mutex_;
+}
 
 bool RadioInterface::begin() {
+  std::scoped_lock lock(txMutex(), rx_mutex_);
   if (!tx_radio->begin())
     return false;
-  tx_radio->setPALevel(RF24_PA_MAX);
+  tx_radio->setPowerLevel(RadioPowerLevel::MAX_POWER);
   if (full_duplex && rx_radio) {
     if (!rx_radio->begin())
       return false;
-    rx_radio->setPALevel(RF24_PA_MAX);
+    rx_radio->setPowerLevel(RadioPowerLevel::MAX_POWER);
     rx_radio->startListening();
   } else {
     tx_radio->stopListening();
@@ -34,9 +93,11 @@ bool RadioInterface::begin() {
 }
 
 void RadioInterface::setAddress(uint64_t tx, uint64_t rx) {
+  std::scoped_lock lock(txMutex(), rx_mutex_);
   tx_address = tx;
   rx_address = rx;
   tx_radio->openWritingPipe(tx_address);
+  open_tx_address_ = tx_address;
   if (full_duplex && rx_radio)
     rx_radio->openReadingPipe(1, rx_address);
   else
@@ -44,29 +105,33 @@ void RadioInterface::setAddress(uint64_t tx, uint64_t rx) {
 }
 
 void RadioInterface::openListeningPipe(uint8_t pipe, uint64_t address) {
+  std::lock_guard<std::mutex> lock(rxMutex());
   if (full_duplex && rx_radio)
     rx_radio->openReadingPipe(pipe, address);
   else
     tx_radio->openReadingPipe(pipe, address);
 }
 
+void RadioInterface::closeListeningPipe(uint8_t pipe) {
+  std::lock_guard<std::mutex> lock(rxMutex());
+  if (full_duplex && rx_radio)
+    rx_radio->closeReadingPipe(pipe);
+  else
+    tx_radio->closeReadingPipe(pipe);
+}
+
 void RadioInterface::configure(uint8_t channel, RadioDataRate datarate) {
-  auto configureRadio = [&](RF24 *r) {
+  std::scoped_lock lock(txMutex(), rx_mutex_);
+  data_rate_ = datarate;
+  channel_ = channel;
+  tx_channel_ = channel;
+  auto configureRadio = [&](RadioTransport *r) {
     r->setChannel(channel);
-    switch (datarate) {
-    case RadioDataRate::LOW_RATE:
-      r->setDataRate(RF24_250KBPS);
-      break;
-    case RadioDataRate::MEDIUM_RATE:
-      r->setDataRate(RF24_1MBPS);
-      break;
-    case RadioDataRate::HIGH_RATE:
-      r->setDataRate(RF24_2MBPS);
-      break;
-    }
+    r->setDataRate(datarate);
     r->setAutoAck(true);
     r->enableDynamicPayloads();
     r->enableAckPayload();
+    r->enableDynamicAck();
   };
 
   configureRadio(tx_radio.get());
@@ -78,54 +143,546 @@ void RadioInterface::configure(uint8_t channel, RadioDataRate datarate) {
   }
 }
 
+void RadioInterface::setChannel(uint8_t channel) {
+  std::scoped_lock lock(txMutex(), rx_mutex_);
+  channel_ = channel;
+  tx_channel_ = channel;
+  tx_radio->setChannel(channel);
+  if (full_duplex && rx_radio)
+    rx_radio->setChannel(channel);
+  // Kanal değişimi RX modunda PLL'i yeniden kilitletmeli
+  rxTransport()->stopListening();
+  rxTransport()->startListening();
+}
+
+void RadioInterface::setTxChannel(uint8_t channel) {
+  std::lock_guard<std::mutex> lock(txMutex());
+  if (!full_duplex || !rx_radio)
+    return;
+  tx_channel_ = channel;
+  tx_radio->setChannel(channel);
+}
+
+void RadioInterface::setDataRate(RadioDataRate rate) {
+  std::scoped_lock lock(txMutex(), rx_mutex_);
+  data_rate_ = rate;
+  tx_radio->setDataRate(rate);
+  if (full_duplex && rx_radio)
+    rx_radio->setDataRate(rate);
+  rxTransport()->stopListening();
+  rxTransport()->startListening();
+}
+
+void RadioInterface::setPowerLevel(RadioPowerLevel level) {
+  std::lock_guard<std::mutex> lock(txMutex());
+  tx_radio->setPowerLevel(level);
+}
+
+void RadioInterface::setRetries(uint8_t delay, uint8_t count) {
+  std::lock_guard<std::mutex> lock(txMutex());
+  tx_radio->setRetries(delay, count);
+}
+
 bool RadioInterface::send(const void *data, size_t size) {
+  std::lock_guard<std::mutex> lock(txMutex());
+  return writeLocked(tx_address, data, size, false);
+}
+
+bool RadioInterface::sendTo(uint64_t address, const void *data, size_t size,
+                            bool multicast) {
+  std::lock_guard<std::mutex> lock(txMutex());
+  return writeLocked(address, data, size, multicast);
+}
+
+bool RadioInterface::writeLocked(uint64_t address, const void *data,
+                                 size_t size, bool multicast) {
+  MetricsTimer timer(MetricHistogram::RADIO_SEND);
+  if (size > 0)
+    metricsPacket(static_cast<PacketType>(*static_cast<const uint8_t *>(data)),
+                  true);
+  if (address != open_tx_address_) {
+    tx_radio->openWritingPipe(address);
+    open_tx_address_ = address;
+  }
+  const bool recording = recorder_.load(std::memory_order_acquire) != nullptr;
+  const uint64_t start_us = recording ? monotonicMicros() : 0;
   if (full_duplex && rx_radio) {
-    return tx_radio->write(data, static_cast<uint8_t>(size));
+    const bool success =
+        tx_radio->write(data, static_cast<uint8_t>(size), multicast);
+    if (recording)
+      recordTx(address, data, size, start_us, tx_radio->getARC(), success,
+               multicast);
+    metricsCount(success ? MetricCounter::SEND_OK
+                         : MetricCounter::SEND_FAILED);
+    if (success)
+      collectAckPayloads();
+    return success;
   }
   tx_radio->stopListening();
-  bool success = tx_radio->write(data, static_cast<uint8_t>(size));
+  bool success = tx_radio->write(data, static_cast<uint8_t>(size), multicast);
+  if (recording)
+    recordTx(address, data, size, start_us, tx_radio->getARC(), success,
+             multicast);
   tx_radio->startListening();
+  metricsCount(success ? MetricCounter::SEND_OK : MetricCounter::SEND_FAILED);
   return success;
 }
 
-bool RadioInterface::receive(void *data, size_t size, bool peekOnly) {
-  RF24 *rx = (full_duplex && rx_radio) ? rx_radio.get() : tx_radio.get();
+void RadioInterface::recordTx(uint64_t address, const void *data, size_t size,
+                              uint64_t start_us, uint8_t arc, bool success,
+                              bool multicast) {
+  FlightRecorder *recorder = recorder_.load(std::memory_order_acquire);
+  if (!recorder)
+    return;
+  const uint8_t flags =
+      (success ? FLIGHT_ACKED : 0) | (multicast ? FLIGHT_MULTICAST : 0);
+  recorder->record(FlightDirection::TX, data, size, start_us, 0, arc, flags,
+                   tx_channel_.load(), data_rate_.load(), address);
+}
 
-  if (peekOnly) {
+void RadioInterface::collectAckPayloads() {
+  // ACK payloads are received by the TX module. With the queue full they
+  // stay in its RX FIFO until takeAckPayload() makes room; dropping the
+  // oldest could lose a downlink command.
+  RadioFrame frame;
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(ack_mutex_);
+      if (ack_frames_.size() == ACK_QUEUE_DEPTH) {
+        if (tx_radio->available())
+          metricsCount(MetricCounter::ACK_PAYLOADS_HELD);
+        return;
+      }
+    }
+    if (!readAckFrame(frame))
+      return;
+    metricsCount(MetricCounter::ACK_PAYLOADS_RX);
+    std::lock_guard<std::mutex> lock(ack_mutex_);
+    ack_frames_.push_back(frame);
+    ack_pending_.store(ack_frames_.size(), std::memory_order_release);
+  }
+}
+
+bool RadioInterface::receive(RadioFrame &frame) {
+  if (cache_pending_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
     if (cached_packet) {
-      std::memcpy(data, cached_packet->data(), size);
+      frame = *cached_packet;
+      cached_packet.reset();
+      cache_pending_.store(false, std::memory_order_release);
       return true;
     }
+  }
+  if (takeAckPayload(frame))
+    return true;
 
-    if (!rx->available())
-      return false;
+  if (rxThreadRunning())
+    return rx_ring_.pop(frame);
 
-    cached_packet.emplace();
-    rx->read(cached_packet->data(),
-             static_cast<uint8_t>(cached_packet->size()));
-    std::memcpy(data, cached_packet->data(), size);
-    return true;
-  }
+  std::lock_guard<std::mutex> lock(rxMutex());
+  return readFrame(frame);
+}
 
-  if (cached_packet) {
-    std::memcpy(data, cached_packet->data(), size);
-    cached_packet.reset();
-    return true;
+bool RadioInterface::readFrame(RadioFrame &frame) {
+  if (!readFrom(rxTransport(), frame))
+    return false;
+  recordRx(rxTransport(), FlightDirection::RX, frame);
+  return true;
+}
+
+bool RadioInterface::readAckFrame(RadioFrame &frame) {
+  if (!readFrom(tx_radio.get(), frame))
+    return false;
+  recordRx(tx_radio.get(), FlightDirection::ACK_PAYLOAD, frame);
+  return true;
+}
+
+void RadioInterface::recordRx(RadioTransport *rx, FlightDirection direction,
+                              const RadioFrame &frame) {
+  FlightRecorder *recorder = recorder_.load(std::memory_order_acquire);
+  if (!recorder)
+    return;
+  const uint8_t flags = rx->testRPD() ? FLIGHT_RPD : 0;
+  recorder->record(direction, frame.data.data(), frame.size, frame.rx_time_us,
+                   frame.pipe, 0, flags, channel_.load(), data_rate_.load());
+}
+
+void RadioInterface::setFlightRecorder(FlightRecorder *recorder) {
+  recorder_.store(recorder, std::memory_order_release);
+}
+
+bool RadioInterface::readFrom(RadioTransport *rx, RadioFrame &frame) {
+  if (!rx->available(&frame.pipe))
+    return false;
+
+  MetricsTimer timer(MetricHistogram::RADIO_RECEIVE);
+  frame.size = rx->getDynamicPayloadSize();
+  if (frame.size == 0 || frame.size > RADIO_MAX_PAYLOAD) {
+    // Corrupt length: the driver flushes the FIFO, nothing to read.
+    frame.size = 0;
+    return false;
   }
+  const uint64_t arrival = rx->rxArrivalUs();
+  rx->read(frame.data.data(), frame.size);
+  frame.rx_time_us = arrival ? arrival : monotonicMicros();
+  metricsCount(MetricCounter::FRAMES_RX);
+  metricsPacket(static_cast<PacketType>(frame.data[0]), false);
+  return true;
+}
 
-  if (!rx->available())
+bool RadioInterface::receive(void *data, size_t size, bool peekOnly) {
+  RadioFrame frame;
+  if (!receive(frame))
     return false;
 
-  std::array<uint8_t, 32> buffer{};
-  rx->read(buffer.data(), buffer.size());
-  std::memcpy(data, buffer.data(), size);
-  cached_packet.reset();
+  std::memcpy(data, frame.data.data(), std::min(size, frame.data.size()));
+  if (peekOnly) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    cached_packet = frame;
+    cache_pending_.store(true, std::memory_order_release);
+  }
   return true;
 }
 
 bool RadioInterface::testRPD() {
-  RF24 *rx = (full_duplex && rx_radio) ? rx_radio.get() : tx_radio.get();
+  std::lock_guard<std::mutex> lock(rxMutex());
+  return rxTransport()->testRPD();
+}
+
+bool RadioInterface::probeChannel(uint8_t channel,
+                                  std::chrono::microseconds dwell) {
+  std::lock_guard<std::mutex> lock(rxMutex());
+  RadioTransport *rx = rxTransport();
+  rx->stopListening();
+  rx->setChannel(channel);
+  rx->startListening(); // RPD yeniden başlar
+  std::this_thread::sleep_for(dwell);
   return rx->testRPD();
 }
 
-uint8_t RadioInterface::getARC() { return tx_radio->getARC(); }
+uint8_t RadioInterface::getARC() {
+  std::lock_guard<std::mutex> lock(txMutex());
+  return tx_radio->getARC();
+}
+
+bool RadioInterface::queueAckPayload(uint8_t pipe, const void *data,
+                                     size_t size) {
+  if (size > RADIO_MAX_PAYLOAD)
+    return false;
+  std::lock_guard<std::mutex> lock(rxMutex());
+  return rxTransport()->writeAckPayload(pipe, data,
+                                        static_cast<uint8_t>(size));
+}
+
+void RadioInterface::flushAckPayloads() {
+  std::lock_guard<std::mutex> lock(rxMutex());
+  rxTransport()->flushAckPayloads();
+}
+
+bool RadioInterface::takeAckPayload(RadioFrame &frame) {
+  if (ack_pending_.load(std::memory_order_acquire) == 0)
+    return false;
+  std::lock_guard<std::mutex> lock(ack_mutex_);
+  if (ack_frames_.empty())
+    return false;
+  frame = ack_frames_.front();
+  ack_frames_.pop_front();
+  ack_pending_.store(ack_frames_.size(), std::memory_order_release);
+  return true;
+}
+
+bool RadioInterface::startRxThread(const std::string &gpiochip,
+                                   unsigned irqLine) {
+  if (rxThreadRunning())
+    return true;
+  if (!gpiochip.empty() && !irq_line_.open(gpiochip, irqLine))
+    return false;
+
+  notify_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (notify_fd_ < 0) {
+    irq_line_.close();
+    return false;
+  }
+  rx_running_ = true;
+  rx_thread_ = std::thread(&RadioInterface::rxThreadLoop, this);
+  return true;
+}
+
+void RadioInterface::stopRxThread() {
+  if (!rx_thread_.joinable())
+    return;
+  rx_running_ = false;
+  rx_thread_.join();
+  irq_line_.close();
+  close(notify_fd_);
+  notify_fd_ = -1;
+}
+
+bool RadioInterface::rxThreadRunning() const {
+  return rx_running_.load(std::memory_order_acquire);
+}
+
+void RadioInterface::rxThreadLoop() {
+  int irq_fd = irq_line_.isOpen() ? irq_line_.eventFd()
+                                  : rxTransport()->interruptFd();
+  bool stalled = false;
+
+  while (rx_running_.load(std::memory_order_relaxed)) {
+    // The IRQ is edge triggered, so a periodic timeout also catches an
+    // edge that fired before the descriptor was armed. Without any IRQ
+    // source the module is polled every 200 us.
+    if (irq_fd >= 0) {
+      pollfd pfd{irq_fd, POLLIN, 0};
+      if (poll(&pfd, 1, stalled ? 1 : 50) > 0) {
+        if (irq_line_.isOpen()) {
+          irq_line_.clear();
+        } else {
+          uint64_t events;
+          [[maybe_unused]] ssize_t n = read(irq_fd, &events, sizeof(events));
+        }
+      }
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    size_t drained = 0;
+    stalled = false;
+    {
+      std::lock_guard<std::mutex> lock(rxMutex());
+      while (RadioFrame *slot = rx_ring_.acquire()) {
+        if (!readFrame(*slot))
+          break;
+        rx_ring_.publish();
+        drained++;
+      }
+      if (rx_ring_.acquire() == nullptr && rxTransport()->available()) {
+        stalled = true;
+        rx_ring_stalls_.fetch_add(1, std::memory_order_relaxed);
+        metricsCount(MetricCounter::RX_RING_STALLS);
+      }
+    }
+
+    if (drained > 0) {
+      metricsCount(MetricCounter::RX_THREAD_WAKEUPS);
+      metricsRecord(MetricHistogram::RX_THREAD_BATCH, drained);
+      uint64_t one = 1;
+      [[maybe_unused]] ssize_t n = write(notify_fd_, &one, sizeof(one));
+    }
+  }
+}
+
+bool RadioInterface::startTxThread() {
+  if (txThreadRunning())
+    return true;
+  tx_notify_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (tx_notify_fd_ < 0)
+    return false;
+  tx_flush_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (tx_flush_fd_ < 0) {
+    close(tx_notify_fd_);
+    tx_notify_fd_ = -1;
+    return false;
+  }
+  tx_running_ = true;
+  tx_thread_ = std::thread(&RadioInterface::txThreadLoop, this);
+  return true;
+}
+
+void RadioInterface::stopTxThread() {
+  if (!tx_thread_.joinable())
+    return;
+  tx_running_ = false;
+  uint64_t one = 1;
+  [[maybe_unused]] ssize_t n = write(tx_notify_fd_, &one, sizeof(one));
+  tx_thread_.join();
+  close(tx_notify_fd_);
+  tx_notify_fd_ = -1;
+  close(tx_flush_fd_);
+  tx_flush_fd_ = -1;
+}
+
+bool RadioInterface::txThreadRunning() const {
+  return tx_running_.load(std::memory_order_acquire);
+}
+
+bool RadioInterface::post(const void *data, size_t size, TxCallback done) {
+  return postTo(0, data, size, false, std::move(done));
+}
+
+bool RadioInterface::postTo(uint64_t address, const void *data, size_t size,
+                            bool multicast, TxCallback done) {
+  if (size == 0 || size > RADIO_MAX_PAYLOAD)
+    return false;
+  TxFrame *slot = tx_ring_.acquire();
+  if (!slot)
+    return false;
+  std::memcpy(slot->data.data(), data, size);
+  slot->size = static_cast<uint8_t>(size);
+  slot->multicast = multicast;
+  slot->address = address;
+  slot->done = std::move(done);
+  tx_ring_.publish();
+  tx_posted_++;
+  if (!txThreadRunning())
+    return true;
+  // Pairs with the fence in txThreadLoop: either the thread sees the frame
+  // before sleeping or we see it idle and wake it.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (tx_idle_.exchange(false)) {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(tx_notify_fd_, &one, sizeof(one));
+  }
+  return true;
+}
+
+size_t RadioInterface::txPending() const { return tx_ring_.size(); }
+
+uint64_t RadioInterface::txSent() const {
+  return tx_sent_.load(std::memory_order_relaxed);
+}
+
+uint64_t RadioInterface::txFailed() const {
+  return tx_failed_.load(std::memory_order_relaxed);
+}
+
+void RadioInterface::flushTx() {
+  if (!txThreadRunning()) {
+    while (const size_t count = std::min(tx_ring_.size(), TX_BURST_MAX))
+      writeQueued(count);
+    return;
+  }
+  // post() ile aynı el sıkışma: ya TX thread'inin sayacını görürüz ya da
+  // o bizi uyurken görüp eventfd'ye yazar
+  const uint64_t target = tx_posted_;
+  while (tx_completed_.load(std::memory_order_acquire) < target) {
+    tx_flushing_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (tx_completed_.load(std::memory_order_acquire) >= target)
+      break;
+    pollfd pfd{tx_flush_fd_, POLLIN, 0};
+    if (poll(&pfd, 1, 50) > 0) {
+      uint64_t events;
+      [[maybe_unused]] ssize_t n = read(tx_flush_fd_, &events, sizeof(events));
+    }
+  }
+  tx_flushing_.store(false);
+}
+
+void RadioInterface::writeQueued(size_t count) {
+  std::array<TxBurstFrame, TX_BURST_MAX> burst;
+  std::array<TxFrame *, TX_BURST_MAX> queued;
+  for (size_t i = 0; i < count; ++i) {
+    // Yuva pop() edilene kadar üretici dokunmaz
+    queued[i] = tx_ring_.peek(i);
+    burst[i].data = queued[i]->data.data();
+    burst[i].size = queued[i]->size;
+    burst[i].multicast = queued[i]->multicast;
+  }
+  auto addressOf = [&](size_t i) {
+    return queued[i]->address ? queued[i]->address : tx_address;
+  };
+
+  std::array<uint64_t, TX_BURST_MAX> address;
+  {
+    std::lock_guard<std::mutex> lock(txMutex());
+    // Tek modülde RX -> TX geçişi çerçeve başına değil, burst başına bir kez
+    const bool duplex = full_duplex && rx_radio;
+    if (!duplex)
+      tx_radio->stopListening();
+    // Yazma adresi FIFO doluyken değişemez: aynı adrese gidenler bir arada
+    for (size_t i = 0; i < count;) {
+      const uint64_t to = addressOf(i);
+      size_t run = 1;
+      while (i + run < count && addressOf(i + run) == to)
+        run++;
+      if (to != open_tx_address_) {
+        tx_radio->openWritingPipe(to);
+        open_tx_address_ = to;
+      }
+      tx_radio->writeBurst(&burst[i], run);
+      for (size_t k = i; k < i + run; ++k)
+        address[k] = to;
+      i += run;
+    }
+    if (duplex)
+      collectAckPayloads();
+    else
+      tx_radio->startListening();
+  }
+
+  // Yuvalar geri çağrılardan önce boşalır; çerçeve verisi ondan önce işlenir
+  std::array<TxCallback, TX_BURST_MAX> done;
+  for (size_t i = 0; i < count; ++i) {
+    const TxBurstFrame &f = burst[i];
+    metricsPacket(static_cast<PacketType>(queued[i]->data[0]), true);
+    metricsCount(f.success ? MetricCounter::SEND_OK
+                           : MetricCounter::SEND_FAILED);
+    recordTx(address[i], f.data, f.size, f.start_us, f.arc, f.success,
+             f.multicast);
+    done[i] = std::move(queued[i]->done);
+    queued[i]->done = nullptr;
+    (f.success ? tx_sent_ : tx_failed_).fetch_add(1, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < count; ++i)
+    tx_ring_.pop();
+  for (size_t i = 0; i < count; ++i)
+    if (done[i])
+      done[i](TxCompletion{burst[i].success, burst[i].arc});
+
+  tx_completed_.fetch_add(count, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (tx_flushing_.exchange(false)) {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(tx_flush_fd_, &one, sizeof(one));
+  }
+}
+
+void RadioInterface::txThreadLoop() {
+  for (;;) {
+    const size_t count = std::min(tx_ring_.size(), TX_BURST_MAX);
+    if (count == 0) {
+      if (!tx_running_.load(std::memory_order_acquire))
+        return;
+      tx_idle_.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (tx_ring_.empty()) {
+        pollfd pfd{tx_notify_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 50) > 0) {
+          uint64_t events;
+          [[maybe_unused]] ssize_t n =
+              read(tx_notify_fd_, &events, sizeof(events));
+        }
+      }
+      tx_idle_.store(false);
+      continue;
+    }
+    writeQueued(count);
+  }
+}
+
+bool RadioInterface::waitForFrame(std::chrono::microseconds timeout) {
+  if (!rxThreadRunning()) {
+    std::this_thread::sleep_for(timeout);
+    return false;
+  }
+  if (!rx_ring_.empty() || ack_pending_.load(std::memory_order_acquire) > 0)
+    return true;
+
+  pollfd pfd{notify_fd_, POLLIN, 0};
+  const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  const timespec ts{static_cast<time_t>(secs.count()),
+                    static_cast<long>((timeout - secs).count() * 1000)};
+  if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+    uint64_t events;
+    [[maybe_unused]] ssize_t n = read(notify_fd_, &events, sizeof(events));
+  }
+  return !rx_ring_.empty() || ack_pending_.load(std::memory_order_acquire) > 0;
+}
+
+const RadioFrame *RadioInterface::frontFrame() { return rx_ring_.front(); }
+
+void RadioInterface::popFrame() { rx_ring_.pop(); }
+
+uint64_t RadioInterface::rxRingStalls() const {
+  return rx_ring_stalls_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,128 @@
+#include "../include/radio_bank.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Min-heap on arrival time for std::push_heap/pop_heap.
+bool later(const BankFrame &a, const BankFrame &b) {
+  return a.frame.rx_time_us > b.frame.rx_time_us;
+}
+
+// FNV-1a over the payload; the length is hashed too.
+uint64_t payloadHash(const RadioFrame &frame) {
+  uint64_t h = 0xCBF29CE484222325ULL ^ frame.size;
+  for (size_t i = 0; i < frame.size; ++i) {
+    h ^= frame.data[i];
+    h *= 0x100000001B3ULL;
+  }
+  return h | 1; // 0 marks an empty slot
+}
+
+} // namespace
+
+RadioBank::RadioBank(RadioBankConfig config) : config_(config) {}
+
+RadioBank::~RadioBank() { stop(); }
+
+int RadioBank::add(RadioInterface &radio, const std::string &gpiochip,
+                   unsigned irq_line) {
+  if (radios_.size() >= RADIO_BANK_MAX)
+    return -1;
+  radios_.push_back({&radio, gpiochip, irq_line});
+  return static_cast<int>(radios_.size() - 1);
+}
+
+bool RadioBank::start() {
+  for (Module &m : radios_)
+    if (!m.radio->startRxThread(m.gpiochip, m.irq_line))
+      return false;
+  return true;
+}
+
+void RadioBank::stop() {
+  for (Module &m : radios_)
+    m.radio->stopRxThread();
+}
+
+bool RadioBank::duplicate(const RadioFrame &frame) {
+  const uint64_t hash = payloadHash(frame);
+  Seen &slot = seen_[hash % SEEN_SLOTS];
+  const uint64_t gap = frame.rx_time_us > slot.time_us
+                           ? frame.rx_time_us - slot.time_us
+                           : slot.time_us - frame.rx_time_us;
+  const bool dup = slot.hash == hash && gap <= config_.dedup_us;
+  if (!dup)
+    slot = {hash, frame.rx_time_us};
+  return dup;
+}
+
+void RadioBank::pull(uint64_t now_us) {
+  for (size_t i = 0; i < radios_.size(); ++i) {
+    BankFrame in;
+    in.radio = static_cast<uint8_t>(i);
+    while (radios_[i].radio->receive(in.frame)) {
+      stats_.frames[i]++;
+      if (in.frame.rx_time_us == 0)
+        in.frame.rx_time_us = now_us;
+      // Aynı yük: çeşitleme ya da ACK'i kaybolmuş yeniden gönderim
+      if (duplicate(in.frame)) {
+        stats_.duplicates++;
+        continue;
+      }
+      pending_.push_back(in);
+      std::push_heap(pending_.begin(), pending_.end(), later);
+    }
+  }
+}
+
+bool RadioBank::next(BankFrame &out) { return next(out, monotonicMicros()); }
+
+bool RadioBank::next(BankFrame &out, uint64_t now_us) {
+  pull(now_us);
+  if (pending_.empty() ||
+      pending_.front().frame.rx_time_us + config_.reorder_us > now_us)
+    return false;
+  std::pop_heap(pending_.begin(), pending_.end(), later);
+  out = pending_.back();
+  pending_.pop_back();
+  if (out.frame.rx_time_us < last_released_us_)
+    stats_.late++;
+  else
+    last_released_us_ = out.frame.rx_time_us;
+  stats_.delivered++;
+  return true;
+}
+
+void RadioBank::wait(std::chrono::microseconds timeout) {
+  // Bekleyen çerçeve varsa yalnızca sırası gelene kadar uyunur
+  if (!pending_.empty()) {
+    const uint64_t due = pending_.front().frame.rx_time_us + config_.reorder_us;
+    const uint64_t now = monotonicMicros();
+    timeout = std::min<std::chrono::microseconds>(
+        timeout, std::chrono::microseconds(due > now ? due - now : 0));
+  }
+  std::array<pollfd, RADIO_BANK_MAX> fds{};
+  nfds_t n = 0;
+  for (const Module &m : radios_)
+    if (m.radio->rxNotifyFd() >= 0)
+      fds[n++] = {m.radio->rxNotifyFd(), POLLIN, 0};
+  if (n == 0) {
+    std::this_thread::sleep_for(timeout);
+    return;
+  }
+  const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  const timespec ts{static_cast<time_t>(secs.count()),
+                    static_cast<long>((timeout - secs).count() * 1000)};
+  if (ppoll(fds.data(), n, &ts, nullptr) <= 0)
+    return;
+  for (nfds_t i = 0; i < n; ++i) {
+    if (fds[i].revents & POLLIN) {
+      uint64_t events;
+      [[maybe_unused]] ssize_t r = read(fds[i].fd, &events, sizeof(events));
+    }
+  }
+}
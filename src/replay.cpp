@@ -0,0 +1,389 @@
+#include "../include/replay.hpp"
+#include "../include/drone.hpp"
+#include "../include/radio.hpp"
+#include "../include/swarm_address.hpp"
+#include "../include/tdma.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+
+void ReplayTransport::push(const ReplayFrame &frame, uint64_t arrival_us) {
+  rx_.push_back({frame, arrival_us});
+}
+
+uint64_t ReplayTransport::writes(PacketType type) const {
+  return writes_by_type_[static_cast<uint8_t>(type)];
+}
+
+bool ReplayTransport::takeTimeSyncRequest(TimeSyncRequestPacket &req) {
+  if (!sync_request_)
+    return false;
+  req = *sync_request_;
+  sync_request_.reset();
+  return true;
+}
+
+bool ReplayTransport::write(const void *data, uint8_t size, bool multicast) {
+  writes_++;
+  if (size > 0)
+    writes_by_type_[*static_cast<const uint8_t *>(data)]++;
+  if (size == sizeof(TimeSyncRequestPacket) &&
+      *static_cast<const uint8_t *>(data) ==
+          static_cast<uint8_t>(PacketType::TIME_SYNC_REQUEST)) {
+    sync_request_.emplace();
+    std::memcpy(&*sync_request_, data, size);
+  }
+  return multicast || write_acked_;
+}
+
+bool ReplayTransport::available(uint8_t *pipe) {
+  if (rx_.empty())
+    return false;
+  if (pipe)
+    *pipe = rx_.front().frame.pipe;
+  return true;
+}
+
+uint8_t ReplayTransport::getDynamicPayloadSize() {
+  return rx_.empty() ? 0 : rx_.front().frame.size;
+}
+
+uint64_t ReplayTransport::rxArrivalUs() {
+  return rx_.empty() ? 0 : rx_.front().arrival_us;
+}
+
+void ReplayTransport::read(void *data, uint8_t size) {
+  if (rx_.empty())
+    return;
+  const ReplayFrame &f = rx_.front().frame;
+  std::memcpy(data, f.data.data(), std::min<size_t>(size, f.data.size()));
+  rpd_ = f.rpd;
+  rx_.pop_front();
+}
+
+const char *replayEventName(ReplayEvent event) {
+  switch (event) {
+  case ReplayEvent::LEADER_CHANGED:
+    return "leader_changed";
+  case ReplayEvent::ROLE_CHANGED:
+    return "role_changed";
+  case ReplayEvent::PERMISSION:
+    return "permission";
+  case ReplayEvent::TDMA_SLOT:
+    return "tdma_slot";
+  case ReplayEvent::CLOCK_SYNCED:
+    return "clock_synced";
+  }
+  return "?";
+}
+
+std::vector<ReplayFrame> framesFromFlightLog(const FlightLog &log) {
+  std::vector<ReplayFrame> frames;
+  frames.reserve(log.entries.size());
+  for (const FlightEntry &e : log.entries) {
+    if (e.direction == FlightDirection::TX || e.size == 0)
+      continue;
+    ReplayFrame f;
+    f.time_us = e.time_us;
+    f.pipe = e.pipe;
+    f.rpd = (e.flags & FLIGHT_RPD) != 0;
+    f.size = e.size;
+    std::memcpy(f.data.data(), e.data, e.size);
+    frames.push_back(f);
+  }
+  return frames;
+}
+
+namespace {
+
+template <typename T> ReplayFrame makeFrame(const T &packet, uint64_t t,
+                                            uint8_t pipe, bool rpd = false) {
+  ReplayFrame f;
+  f.time_us = t;
+  f.pipe = pipe;
+  f.rpd = rpd;
+  f.size = sizeof(T);
+  std::memcpy(f.data.data(), &packet, sizeof(T));
+  return f;
+}
+
+CommandPacket makeCommand(DroneIdType target, uint64_t t, const char *text) {
+  CommandPacket cmd{};
+  cmd.target_drone_id = target;
+  cmd.timestamp = static_cast<uint32_t>(t);
+  std::strncpy(cmd.command, text, MAX_COMMAND_LENGTH - 1);
+  return cmd;
+}
+
+void followerView(const SyntheticTrafficConfig &config, std::mt19937 &rng,
+                  std::vector<ReplayFrame> &out) {
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  const uint64_t end_us = static_cast<uint64_t>(config.seconds * 1e6);
+  const uint64_t change_us =
+      static_cast<uint64_t>(config.leader_change_s * 1e6);
+  // Liderlik test edilen drone olmayan ilk takipçiye geçip geri döner
+  const auto backup = static_cast<DroneIdType>(
+      config.drone_id == config.leader_id + 1 ? config.leader_id + 2
+                                              : config.leader_id + 1);
+  DroneIdType leader = config.leader_id;
+  uint64_t next_change = change_us ? change_us : end_us;
+
+  std::vector<DroneIdType> members;
+  for (size_t i = 0; i < config.followers; i++)
+    members.push_back(static_cast<DroneIdType>(config.leader_id + 1 + i));
+  TdmaConfig tdma;
+  tdma.superframe_us = config.superframe_us;
+  TdmaScheduler scheduler(tdma);
+  scheduler.setMembers(members);
+
+  uint32_t superframe = 0;
+  for (uint64_t t = 0; t < end_us; t += config.superframe_us, superframe++) {
+    if (t >= next_change) {
+      leader = leader == config.leader_id ? backup : config.leader_id;
+      LeaderAnnouncementPacket ann{};
+      ann.new_leader_id = leader;
+      ann.timestamp = static_cast<uint32_t>(t);
+      out.push_back(makeFrame(ann, t, GROUP_PIPE));
+      next_change += change_us;
+    }
+
+    const BeaconPacket beacon =
+        scheduler.nextBeacon(leader, static_cast<uint32_t>(t));
+    out.push_back(makeFrame(beacon, t + 100, GROUP_PIPE, u(rng) < 0.5));
+
+    // Slot telemetry'sinin ACK'ı: LinkControl ya da bekleyen komut
+    if (const auto slot = tdmaSlotFor(beacon, config.drone_id, t + 100)) {
+      const uint64_t ack_t = slot->start_us + slot->length_us / 4;
+      if (u(rng) < 0.1) {
+        LinkControlPacket ctl{};
+        ctl.target_drone_id = config.drone_id;
+        ctl.timestamp = static_cast<uint32_t>(ack_t);
+        ctl.data_rate = static_cast<uint8_t>(RadioDataRate::HIGH_RATE);
+        ctl.power_level = static_cast<uint8_t>(RadioPowerLevel::MAX_POWER);
+        ctl.retries = 0x15;
+        out.push_back(makeFrame(ctl, ack_t, 0));
+      } else if (u(rng) < 0.05) {
+        out.push_back(
+            makeFrame(makeCommand(config.drone_id, ack_t, "hover"), ack_t, 0));
+      }
+    }
+
+    const uint64_t period = t + config.superframe_us * 9 / 10;
+    if (superframe % 10 == 0) {
+      out.push_back(makeFrame(makeCommand(config.drone_id, period, "status"),
+                              period + 600, UNICAST_PIPE));
+    }
+    if (superframe % 20 == 5) {
+      PermissionToSendPacket perm{};
+      perm.target_drone_id = config.drone_id;
+      perm.timestamp = static_cast<uint32_t>(period);
+      out.push_back(makeFrame(perm, period + 900, UNICAST_PIPE));
+    }
+  }
+}
+
+void leaderView(const SyntheticTrafficConfig &config, std::mt19937 &rng,
+                std::vector<ReplayFrame> &out) {
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::uniform_int_distribution<int> imu(-2000, 2000);
+  const uint64_t end_us = static_cast<uint64_t>(config.seconds * 1e6);
+
+  std::vector<DroneIdType> members;
+  for (size_t i = 0; i < config.followers; i++)
+    members.push_back(static_cast<DroneIdType>(config.leader_id + 1 + i));
+  TdmaConfig tdma;
+  tdma.superframe_us = config.superframe_us;
+  TdmaScheduler scheduler(tdma);
+  scheduler.setMembers(members);
+
+  uint32_t superframe = 0;
+  for (uint64_t t = 0; t < end_us; t += config.superframe_us, superframe++) {
+    const BeaconPacket beacon =
+        scheduler.nextBeacon(config.leader_id, static_cast<uint32_t>(t));
+    for (uint8_t i = 0; i < beacon.slot_count; i++) {
+      const DroneIdType id = beacon.slots[i];
+      const auto slot = tdmaSlotFor(beacon, id, t);
+      if (!slot || u(rng) < config.loss)
+        continue;
+      uint64_t at = slot->start_us + 300;
+      TelemetryPacket tlm{};
+      tlm.drone_id = id;
+      tlm.timestamp = static_cast<uint32_t>(at);
+      tlm.acceleration_x = static_cast<int16_t>(imu(rng));
+      tlm.acceleration_y = static_cast<int16_t>(imu(rng));
+      tlm.acceleration_z = static_cast<int16_t>(16384 + imu(rng));
+      tlm.gyroscope_x = static_cast<int16_t>(imu(rng));
+      tlm.gyroscope_y = static_cast<int16_t>(imu(rng));
+      tlm.gyroscope_z = static_cast<int16_t>(imu(rng));
+      tlm.battery_voltage = 3.7f;
+      tlm.altitude = 120.0f;
+      tlm.retries = u(rng) < 0.1 ? 1 : 0;
+      tlm.link_quality = 100.0f;
+      out.push_back(makeFrame(tlm, at, LEADER_PIPE, u(rng) < 0.6));
+      if ((superframe + i) % 10 == 0) {
+        TimeSyncRequestPacket req{};
+        req.drone_id = id;
+        req.originate_us = at + 500;
+        out.push_back(makeFrame(req, at + 600, LEADER_PIPE));
+      }
+    }
+
+    // GBS'nin izin yanıtı ACK yüküyle, arada bir takipçi komutu
+    const uint64_t period = t + TdmaScheduler::slotsEndUs(beacon) + 500;
+    out.push_back(makeFrame(makeCommand(0, period, "no_need"), period, 0));
+    if (superframe % 10 == 3) {
+      const DroneIdType target = members[superframe / 10 % members.size()];
+      out.push_back(makeFrame(makeCommand(target, period, "status"),
+                              period + 800, 0));
+    }
+  }
+}
+
+} // namespace
+
+std::vector<ReplayFrame> syntheticTraffic(const SyntheticTrafficConfig &config) {
+  std::mt19937 rng(config.seed);
+  std::vector<ReplayFrame> frames;
+  if (config.leader_view)
+    leaderView(config, rng, frames);
+  else
+    followerView(config, rng, frames);
+  std::stable_sort(frames.begin(), frames.end(),
+                   [](const ReplayFrame &a, const ReplayFrame &b) {
+                     return a.time_us < b.time_us;
+                   });
+  return frames;
+}
+
+ReplayReport replayFrames(const std::vector<ReplayFrame> &frames,
+                          const ReplayOptions &options) {
+  ReplayReport report;
+  if (frames.empty())
+    return report;
+
+  auto transport = std::make_unique<ReplayTransport>();
+  ReplayTransport &fake = *transport;
+  RadioInterface radio(std::move(transport));
+  radio.begin();
+  radio.setAddress(BASE_TX, BASE_RX);
+
+  Drone drone(radio, options.leader, "Replay");
+  JoinResponsePacket join{};
+  join.assigned_id = options.leader ? options.leader_id : options.drone_id;
+  join.current_leader_id = options.leader_id;
+  if (options.unicast) {
+    join.unicast_address = unicastAddressByte(join.assigned_id);
+    join.group_address = groupAddressByte(0);
+  }
+  drone.applyJoinResponse(join);
+  drone.clearRoleChanged();
+
+  const uint64_t t0 = frames.front().time_us;
+  const uint64_t span = frames.back().time_us - t0 + options.service_us;
+  const auto wall_start = std::chrono::steady_clock::now();
+  const uint64_t base_us = monotonicMicros();
+
+  auto prev_leader = drone.getCurrentLeaderId();
+  bool prev_permission = false;
+  bool prev_synced = drone.clock().synced();
+  uint64_t next_service = options.service_us;
+  const size_t batch = std::max<size_t>(options.batch, 1);
+  const size_t passes = std::max<size_t>(options.passes, 1);
+
+  auto note = [&](ReplayEvent event, uint32_t value, uint64_t at) {
+    report.events[static_cast<size_t>(event)]++;
+    report.transitions.push_back({report.frames, at, event, value});
+  };
+
+  for (size_t pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < frames.size(); i += batch) {
+      const size_t n = std::min(batch, frames.size() - i);
+      const uint64_t rel = pass * span + (frames[i].time_us - t0);
+
+      if (options.realtime) {
+        const auto due =
+            wall_start + std::chrono::microseconds(static_cast<int64_t>(
+                             rel / std::max(options.speed, 1e-3)));
+        std::this_thread::sleep_until(due);
+      }
+      // Lider periyodu ya da takipçinin zaman eşitleme isteği. İstek kaydın
+      // zaman çizgisinde yapılır; yanıtlayan liderin saati o çizginin kendisi
+      while (rel >= next_service) {
+        const uint64_t at = base_us + next_service;
+        if (drone.isLeader()) {
+          drone.forwardTelemetry();
+          drone.answerTimeSync(BASE_RX);
+        } else if (drone.requestTimeSync(at) && options.answer_time_sync) {
+          TimeSyncRequestPacket req;
+          if (fake.takeTimeSyncRequest(req)) {
+            TimeSyncResponsePacket resp{};
+            resp.target_drone_id = req.drone_id;
+            resp.originate_us = req.originate_us;
+            resp.receive_us = next_service + 300;
+            resp.transmit_us = resp.receive_us + 200;
+            fake.push(makeFrame(resp, next_service + 800, UNICAST_PIPE),
+                      at + 800);
+          }
+        }
+        next_service += options.service_us;
+      }
+
+      for (size_t k = 0; k < n; k++) {
+        const ReplayFrame &f = frames[i + k];
+        fake.push(f, base_us + pass * span + (f.time_us - t0));
+      }
+      const uint8_t type = frames[i].size ? frames[i].data[0] : 0;
+      const auto start = std::chrono::steady_clock::now();
+      const size_t handled = drone.handleIncoming();
+      const auto ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+      report.frames += n;
+      report.handled += handled;
+      report.all.add(ns);
+      if (type < METRICS_PACKET_TYPES) {
+        report.latency[type].add(ns);
+        for (size_t k = 0; k < n; k++) {
+          const ReplayFrame &f = frames[i + k];
+          if (f.size && f.data[0] < METRICS_PACKET_TYPES)
+            report.frames_by_type[f.data[0]]++;
+        }
+      }
+
+      const auto leader = drone.getCurrentLeaderId();
+      if (leader != prev_leader) {
+        note(ReplayEvent::LEADER_CHANGED, leader.value_or(0), rel);
+        prev_leader = leader;
+      }
+      if (drone.hasRoleChanged()) {
+        note(ReplayEvent::ROLE_CHANGED, drone.isLeader() ? 1 : 0, rel);
+        drone.clearRoleChanged();
+      }
+      const bool permission = drone.hasPermissionToSend();
+      if (permission && !prev_permission)
+        note(ReplayEvent::PERMISSION, 1, rel);
+      if (type == static_cast<uint8_t>(PacketType::BEACON) && drone.tdmaSlot())
+        report.events[static_cast<size_t>(ReplayEvent::TDMA_SLOT)]++;
+      if (permission && options.respond)
+        drone.sendTelemetry(); // izni kullanır
+      prev_permission = drone.hasPermissionToSend();
+      const bool synced = drone.clock().synced();
+      if (synced && !prev_synced)
+        note(ReplayEvent::CLOCK_SYNCED, 1, rel);
+      prev_synced = synced;
+    }
+  }
+
+  report.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - wall_start)
+                       .count();
+  report.writes = fake.writes();
+  for (size_t t = 0; t < METRICS_PACKET_TYPES; t++)
+    report.writes_by_type[t] = fake.writes(static_cast<PacketType>(t));
+  return report;
+}
@@ -0,0 +1,159 @@
+#include "../include/rf24_transport.hpp"
+#include "../include/timebase.hpp"
+
+Rf24Transport::Rf24Transport(uint8_t cePin, uint8_t csnPin)
+    : radio(cePin, csnPin) {}
+
+Rf24Transport::Rf24Transport(uint8_t cePin, uint8_t csnPin, uint8_t spiPort)
+    : radio(cePin, csnPin, spiPort) {}
+
+bool Rf24Transport::begin() { return radio.begin(); }
+
+void Rf24Transport::setChannel(uint8_t channel) { radio.setChannel(channel); }
+
+void Rf24Transport::setDataRate(RadioDataRate rate) {
+  switch (rate) {
+  case RadioDataRate::LOW_RATE:
+    radio.setDataRate(RF24_250KBPS);
+    break;
+  case RadioDataRate::MEDIUM_RATE:
+    radio.setDataRate(RF24_1MBPS);
+    break;
+  case RadioDataRate::HIGH_RATE:
+    radio.setDataRate(RF24_2MBPS);
+    break;
+  }
+}
+
+void Rf24Transport::setPowerLevel(RadioPowerLevel level) {
+  switch (level) {
+  case RadioPowerLevel::MIN_POWER:
+    radio.setPALevel(RF24_PA_MIN);
+    break;
+  case RadioPowerLevel::LOW_POWER:
+    radio.setPALevel(RF24_PA_LOW);
+    break;
+  case RadioPowerLevel::HIGH_POWER:
+    radio.setPALevel(RF24_PA_HIGH);
+    break;
+  case RadioPowerLevel::MAX_POWER:
+    radio.setPALevel(RF24_PA_MAX);
+    break;
+  }
+}
+
+void Rf24Transport::setRetries(uint8_t delay, uint8_t count) {
+  radio.setRetries(delay, count);
+}
+
+void Rf24Transport::setAutoAck(bool enable) { radio.setAutoAck(enable); }
+
+void Rf24Transport::enableDynamicPayloads() { radio.enableDynamicPayloads(); }
+
+void Rf24Transport::enableAckPayload() { radio.enableAckPayload(); }
+
+void Rf24Transport::enableDynamicAck() { radio.enableDynamicAck(); }
+
+void Rf24Transport::openWritingPipe(uint64_t address) {
+  radio.openWritingPipe(address);
+}
+
+void Rf24Transport::openReadingPipe(uint8_t pipe, uint64_t address) {
+  radio.openReadingPipe(pipe, address);
+}
+
+void Rf24Transport::closeReadingPipe(uint8_t pipe) {
+  radio.closeReadingPipe(pipe);
+}
+
+void Rf24Transport::startListening() { radio.startListening(); }
+
+void Rf24Transport::stopListening() { radio.stopListening(); }
+
+bool Rf24Transport::write(const void *data, uint8_t size, bool multicast) {
+  return radio.write(data, size, multicast);
+}
+
+void Rf24Transport::writeBurst(TxBurstFrame *frames, size_t count) {
+  // TX_DS ve MAX_RT tek bitlik mandallardır, FIFO_STATUS da yalnızca boş
+  // ya da dolu der. Uçuşta en fazla iki çerçeve tutulur: FIFO boşsa ikisi
+  // de, TX_DS gelmiş ama boş değilse yalnızca baştaki bitmiştir. ARC_CNT
+  // bir sonraki çerçeve başlayınca sıfırlanır, bu yüzden yalnızca MAX_RT'de
+  // ve arkasında başlayan olmayan son çerçevede okunur.
+  constexpr size_t IN_FLIGHT = 2;
+  constexpr uint64_t TIMEOUT_US = 95000; // RF24::write() ile aynı
+  size_t queued = 0; // FIFO'ya yüklenen
+  size_t done = 0;   // sonucu bilinen
+  uint64_t progress_us = monotonicMicros();
+  auto finish = [&](bool success, uint8_t arc) {
+    frames[done].success = success;
+    frames[done].arc = arc;
+    done++;
+    progress_us = monotonicMicros();
+    if (done < queued)
+      frames[done].start_us = progress_us; // arkadaki şimdi başladı
+  };
+  while (done < count) {
+    if (queued < count && queued - done < IN_FLIGHT) {
+      TxBurstFrame &f = frames[queued];
+      if (queued++ == done)
+        f.start_us = monotonicMicros(); // FIFO boştu, hemen başlar
+      radio.writeFast(f.data, f.size, f.multicast);
+      continue;
+    }
+    // Önce bayraklar, sonra FIFO: arada biten çerçeve FIFO'da görünür
+    bool tx_ok, tx_fail, rx_ready;
+    radio.whatHappened(tx_ok, tx_fail, rx_ready);
+    const bool empty = radio.isFifo(true, true);
+    if (tx_fail) {
+      // MAX_RT vericiyi durdurur: aynı okumadaki TX_DS öndekine aittir,
+      // ARC_CNT ise takılan çerçevenin sayacıdır
+      if (tx_ok && queued - done == IN_FLIGHT)
+        finish(true, TX_ARC_UNKNOWN);
+      finish(false, radio.getARC());
+      radio.flush_tx(); // arkasındakiler yeniden yüklenir
+      queued = done;
+    } else if (empty) {
+      // Hepsi bitti; yalnızca sonuncudan sonra başlayan olmadı
+      const uint8_t arc = radio.getARC();
+      while (done < queued)
+        finish(true, done + 1 == queued ? arc : TX_ARC_UNKNOWN);
+      // Okumadan sonra kalkan TX_DS sayılmış bir çerçeveye ait
+      radio.whatHappened(tx_ok, tx_fail, rx_ready);
+    } else if (tx_ok) {
+      // Boş değil ve en fazla iki uçuşta: tam olarak baştaki bitti
+      finish(true, TX_ARC_UNKNOWN);
+    } else if (monotonicMicros() - progress_us > TIMEOUT_US) {
+      for (; done < count; ++done) {
+        frames[done].success = false;
+        frames[done].arc = TX_ARC_UNKNOWN;
+        if (!frames[done].start_us)
+          frames[done].start_us = progress_us;
+      }
+      radio.flush_tx();
+      break;
+    }
+  }
+  radio.txStandBy();
+}
+
+bool Rf24Transport::writeAckPayload(uint8_t pipe, const void *data,
+                                    uint8_t size) {
+  return radio.writeAckPayload(pipe, data, size);
+}
+
+void Rf24Transport::flushAckPayloads() { radio.flush_tx(); }
+
+bool Rf24Transport::available(uint8_t *pipe) {
+  return pipe ? radio.available(pipe) : radio.available();
+}
+
+uint8_t Rf24Transport::getDynamicPayloadSize() {
+  return radio.getDynamicPayloadSize();
+}
+
+void Rf24Transport::read(void *data, uint8_t size) { radio.read(data, size); }
+
+bool Rf24Transport::testRPD() { return radio.testRPD(); }
+
+uint8_t Rf24Transport::getARC() { return radio.getARC(); }
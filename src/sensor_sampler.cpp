@@ -0,0 +1,138 @@
+#include "../include/sensor_sampler.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+namespace {
+
+// Bias removal and FIR overshoot can take a saturated axis past int16;
+// the cast would wrap it to full scale of the opposite sign.
+int16_t toRaw(float value, float scale) {
+  const float raw = std::clamp(value / scale, float{INT16_MIN},
+                               float{INT16_MAX});
+  return static_cast<int16_t>(std::lround(raw));
+}
+
+} // namespace
+
+SensorSampler::SensorSampler(Mpu6050 &sensor, SensorSamplerConfig config)
+    : sensor_(sensor), config_(config) {
+  config_.rate_hz = std::clamp<uint16_t>(config_.rate_hz, 1,
+                                         MPU6050_MAX_RATE_HZ);
+  config_.decimation = std::max<uint16_t>(config_.decimation, 1);
+}
+
+SensorSampler::~SensorSampler() { stop(); }
+
+bool SensorSampler::start() {
+  if (thread_.joinable())
+    return true;
+  running_ = true;
+  thread_ = std::thread(&SensorSampler::run, this);
+  return true;
+}
+
+void SensorSampler::stop() {
+  if (!thread_.joinable())
+    return;
+  running_ = false;
+  thread_.join();
+}
+
+bool SensorSampler::running() const {
+  return running_.load(std::memory_order_acquire);
+}
+
+void SensorSampler::run() {
+  const bool fifo = sensor_.enableFifo(config_.rate_hz);
+  ImuFilterConfig filter_config;
+  filter_config.sample_rate_hz =
+      fifo ? sensor_.sampleRateHz() : config_.rate_hz;
+  // Low-pass corner at 40% of the published rate.
+  filter_config.cutoff_hz =
+      0.4f * filter_config.sample_rate_hz / config_.decimation;
+  ImuFilter filter(filter_config, config_.calibration);
+
+  if (fifo) {
+    runFifo(filter);
+    sensor_.disableFifo();
+  } else {
+    runPolled(filter);
+  }
+}
+
+void SensorSampler::runFifo(ImuFilter &filter) {
+  const uint64_t period_us = 1000000 / sensor_.sampleRateHz();
+  ImuSample batch[MPU6050_FIFO_BYTES / MPU6050_SAMPLE_BYTES];
+  auto next = std::chrono::steady_clock::now();
+  while (running_.load(std::memory_order_relaxed)) {
+    next += std::chrono::milliseconds(DRAIN_PERIOD_MS);
+    std::this_thread::sleep_until(next);
+    const int n = sensor_.readFifo(batch, std::size(batch));
+    if (n < 0) {
+      read_errors_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    // The newest record was taken at most one period ago; older ones are
+    // spaced by the sample period.
+    const uint64_t now = monotonicMicros();
+    for (int i = 0; i < n; ++i)
+      push(filter, batch[i],
+           now - static_cast<uint64_t>(n - 1 - i) * period_us);
+    flush(filter);
+  }
+}
+
+void SensorSampler::runPolled(ImuFilter &filter) {
+  const auto period = std::chrono::microseconds(1000000 / config_.rate_hz);
+  auto next = std::chrono::steady_clock::now();
+  while (running_.load(std::memory_order_relaxed)) {
+    next += period;
+    std::this_thread::sleep_until(next);
+    ImuSample sample;
+    if (sensor_.readSample(sample))
+      push(filter, sample, monotonicMicros());
+    else
+      read_errors_.fetch_add(1, std::memory_order_relaxed);
+    if (block_.count >= config_.decimation)
+      flush(filter);
+  }
+}
+
+void SensorSampler::push(ImuFilter &filter, const ImuSample &sample,
+                         uint64_t timestamp_us) {
+  stamps_[block_.count] = timestamp_us;
+  appendSamples(block_, &sample, 1);
+  temperature_ = sample.temperature;
+  if (block_.count == IMU_BLOCK)
+    flush(filter);
+}
+
+// Filters the pending samples and publishes every `decimation`-th one.
+void SensorSampler::flush(ImuFilter &filter) {
+  if (block_.count == 0)
+    return;
+  filter.process(block_);
+  const ImuCalibration &cal = filter.calibration();
+  for (size_t i = 0; i < block_.count; ++i) {
+    if (++since_publish_ < config_.decimation)
+      continue;
+    since_publish_ = 0;
+    SensorReading reading{};
+    for (size_t c = 0; c < 3; ++c) {
+      reading.imu.accel[c] =
+          toRaw(block_.value[IMU_AX + c][i], cal.accel_scale);
+      reading.imu.gyro[c] = toRaw(block_.value[IMU_GX + c][i], cal.gyro_scale);
+    }
+    reading.imu.temperature = temperature_;
+    reading.roll = block_.roll[i];
+    reading.pitch = block_.pitch[i];
+    reading.timestamp_us = stamps_[i];
+    reading.sequence = ++sequence_;
+    latest_.store(reading);
+  }
+  block_.count = 0;
+}
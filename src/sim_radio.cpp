@@ -0,0 +1,433 @@
+#include "../include/sim_radio.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::chrono::microseconds TX_SETTLE{RADIO_TX_SETTLE_US};
+constexpr double RPD_THRESHOLD_DBM = -64.0;
+
+double powerDbm(RadioPowerLevel level) {
+  switch (level) {
+  case RadioPowerLevel::MIN_POWER:
+    return -18.0;
+  case RadioPowerLevel::LOW_POWER:
+    return -12.0;
+  case RadioPowerLevel::HIGH_POWER:
+    return -6.0;
+  case RadioPowerLevel::MAX_POWER:
+  default:
+    return 0.0;
+  }
+}
+
+// Receiver sensitivity from the nRF24L01+ datasheet.
+double sensitivityDbm(RadioDataRate rate) {
+  switch (rate) {
+  case RadioDataRate::LOW_RATE:
+    return -94.0;
+  case RadioDataRate::HIGH_RATE:
+    return -82.0;
+  case RadioDataRate::MEDIUM_RATE:
+  default:
+    return -85.0;
+  }
+}
+
+} // namespace
+
+SimInterferer wifiInterferer(int wifi_channel, double duty) {
+  // Wi-Fi channel n is centred on 2407 + 5n MHz and 22 MHz wide.
+  const int centre = 7 + 5 * std::clamp(wifi_channel, 1, 13);
+  return SimInterferer{static_cast<uint8_t>(centre - 11),
+                       static_cast<uint8_t>(centre + 11), duty};
+}
+
+// ==================== SimMedium ==================== //
+
+SimMedium::SimMedium(SimMediumConfig config)
+    : config_(config), rng_(config.seed) {}
+
+SimMediumStats SimMedium::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void SimMedium::resetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_ = {};
+}
+
+void SimMedium::attach(SimTransport *node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nodes_.push_back(node);
+}
+
+void SimMedium::detach(SimTransport *node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nodes_.erase(std::remove(nodes_.begin(), nodes_.end(), node), nodes_.end());
+}
+
+uint64_t SimMedium::beginTransmission(const SimTransport &sender,
+                                     uint8_t channel) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Transmission tx{next_id_++, channel, false, &sender};
+  if (interfered(channel)) {
+    tx.collided = true;
+    stats_.interfered++;
+  }
+  // Any frame still on air on this channel overlaps with the new one.
+  for (auto &other : active_) {
+    if (other.channel == channel) {
+      other.collided = true;
+      tx.collided = true;
+    }
+  }
+  active_.push_back(tx);
+  return tx.id;
+}
+
+bool SimMedium::endTransmission(uint64_t id, SimTransport &sender,
+                                const uint8_t *data, uint8_t size,
+                                bool wants_ack, uint8_t &ack_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ack_size = 0;
+  auto it = std::find_if(active_.begin(), active_.end(),
+                         [id](const Transmission &t) { return t.id == id; });
+  if (it == active_.end())
+    return false;
+  const Transmission tx = *it;
+  active_.erase(it);
+
+  stats_.transmissions++;
+  if (tx.collided) {
+    stats_.collisions++;
+    return false;
+  }
+
+  const auto ready = Clock::now() + config_.latency;
+  bool acked = false;
+  for (SimTransport *node : nodes_) {
+    if (node == &sender || !node->listening_ || node->channel_ != tx.channel)
+      continue;
+
+    const double rx_dbm = receivedPower(sender, *node);
+    if (rx_dbm >= RPD_THRESHOLD_DBM)
+      node->rpd_ = true;
+    if (node->rate_ != sender.rate_)
+      continue;
+
+    std::optional<uint8_t> pipe;
+    for (uint8_t p = 0; p < node->rx_pipes_.size(); ++p) {
+      if (node->rx_pipes_[p] && *node->rx_pipes_[p] == sender.tx_address_) {
+        pipe = p;
+        break;
+      }
+    }
+    if (!pipe)
+      continue;
+
+    // Frame error rate rises smoothly as the margin over the receiver
+    // sensitivity shrinks.
+    const double margin = rx_dbm - sensitivityDbm(node->rate_);
+    const double weak = 1.0 / (1.0 + std::exp(margin / 1.5));
+    const double loss =
+        config_.loss_probability + (1.0 - config_.loss_probability) * weak;
+    if (roll(loss)) {
+      stats_.lost++;
+      continue;
+    }
+    if (node->rx_fifo_.size() >= SimTransport::RX_FIFO_DEPTH) {
+      stats_.rx_overflows++; // a full FIFO neither stores nor ACKs
+      continue;
+    }
+
+    SimTransport::Frame frame;
+    std::memcpy(frame.data.data(), data, size);
+    frame.size = size;
+    frame.pipe = *pipe;
+    frame.ready = ready;
+    node->rx_fifo_.push_back(frame);
+    node->rpd_ = rx_dbm >= RPD_THRESHOLD_DBM; // latched per valid packet
+    stats_.delivered++;
+    if (node->irq_fd_ >= 0) {
+      uint64_t one = 1;
+      [[maybe_unused]] ssize_t n = ::write(node->irq_fd_, &one, sizeof(one));
+    }
+
+    // The ACK travels back over the same link and can be lost as well. A
+    // lost ACK keeps its payload for the retransmission.
+    if (wants_ack && node->auto_ack_ && !roll(loss)) {
+      acked = true;
+      auto ack = std::find_if(
+          node->ack_payloads_.begin(), node->ack_payloads_.end(),
+          [&](const SimTransport::Frame &f) { return f.pipe == *pipe; });
+      if (ack != node->ack_payloads_.end()) {
+        ack_size = ack->size;
+        if (sender.rx_fifo_.size() < SimTransport::RX_FIFO_DEPTH) {
+          SimTransport::Frame reply = *ack;
+          reply.pipe = 0;
+          reply.ready = ready + std::chrono::microseconds(
+                                    TX_SETTLE.count() +
+                                    frameAirtimeUs(ack->size, sender.rate_));
+          sender.rx_fifo_.push_back(reply);
+          stats_.ack_payloads++;
+          if (sender.irq_fd_ >= 0) {
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t n =
+                ::write(sender.irq_fd_, &one, sizeof(one));
+          }
+        } else {
+          stats_.rx_overflows++;
+        }
+        node->ack_payloads_.erase(ack);
+      }
+    }
+  }
+  return acked;
+}
+
+double SimMedium::receivedPower(const SimTransport &from,
+                                const SimTransport &to) const {
+  const double d = std::max(0.1, std::hypot(from.x_ - to.x_, from.y_ - to.y_));
+  // Free space path loss at 2.4 GHz referenced to one metre.
+  const double path_loss = 40.05 + 20.0 * std::log10(d);
+  return powerDbm(from.power_) - path_loss;
+}
+
+bool SimMedium::interfered(uint8_t channel) {
+  for (const SimInterferer &i : config_.interferers) {
+    if (channel >= i.first_channel && channel <= i.last_channel &&
+        roll(i.duty))
+      return true;
+  }
+  return false;
+}
+
+bool SimMedium::carrierOn(const SimTransport &node) {
+  for (const Transmission &tx : active_) {
+    if (tx.channel == node.channel_ && tx.sender != &node &&
+        receivedPower(*tx.sender, node) >= RPD_THRESHOLD_DBM)
+      return true;
+  }
+  return interfered(node.channel_);
+}
+
+bool SimMedium::roll(double probability) {
+  if (probability <= 0.0)
+    return false;
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  return dist(rng_) < probability;
+}
+
+// ==================== SimTransport ==================== //
+
+SimTransport::SimTransport(SimMedium &medium, double x, double y)
+    : medium_(medium), x_(x), y_(y),
+      irq_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  medium_.attach(this);
+}
+
+SimTransport::~SimTransport() {
+  medium_.detach(this);
+  if (irq_fd_ >= 0)
+    close(irq_fd_);
+}
+
+void SimTransport::setPosition(double x, double y) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  x_ = x;
+  y_ = y;
+}
+
+bool SimTransport::begin() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  retry_delay_ = 5;
+  retry_count_ = 15;
+  rx_fifo_.clear();
+  return true;
+}
+
+void SimTransport::setChannel(uint8_t channel) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  channel_ = std::min<uint8_t>(channel, 125);
+}
+
+void SimTransport::setDataRate(RadioDataRate rate) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  rate_ = rate;
+}
+
+void SimTransport::setPowerLevel(RadioPowerLevel level) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  power_ = level;
+}
+
+void SimTransport::setRetries(uint8_t delay, uint8_t count) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  retry_delay_ = std::min<uint8_t>(delay, 15);
+  retry_count_ = std::min<uint8_t>(count, 15);
+}
+
+void SimTransport::setAutoAck(bool enable) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  auto_ack_ = enable;
+}
+
+// Payloads are always dynamic in the simulator.
+void SimTransport::enableDynamicPayloads() {}
+
+void SimTransport::enableAckPayload() {}
+
+void SimTransport::enableDynamicAck() {}
+
+void SimTransport::openWritingPipe(uint64_t address) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  tx_address_ = address;
+}
+
+void SimTransport::openReadingPipe(uint8_t pipe, uint64_t address) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  if (pipe < rx_pipes_.size())
+    rx_pipes_[pipe] = address;
+}
+
+void SimTransport::closeReadingPipe(uint8_t pipe) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  if (pipe < rx_pipes_.size())
+    rx_pipes_[pipe].reset();
+}
+
+void SimTransport::startListening() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  listening_ = true;
+  rpd_ = false;
+}
+
+void SimTransport::stopListening() {
+  bool was_listening;
+  {
+    std::lock_guard<std::mutex> lock(medium_.mutex_);
+    was_listening = listening_;
+    listening_ = false;
+    ack_payloads_.clear();
+  }
+  if (was_listening && medium_.config_.turnaround.count() > 0)
+    std::this_thread::sleep_for(medium_.config_.turnaround);
+}
+
+bool SimTransport::write(const void *data, uint8_t size, bool multicast) {
+  size = std::min<uint8_t>(size, RADIO_MAX_PAYLOAD);
+  uint8_t channel;
+  bool auto_ack;
+  uint8_t retry_count;
+  RadioDataRate rate;
+  std::chrono::microseconds airtime, retry_delay;
+  {
+    std::lock_guard<std::mutex> lock(medium_.mutex_);
+    channel = channel_;
+    auto_ack = auto_ack_ && !multicast;
+    retry_count = retry_count_;
+    rate = rate_;
+    airtime = std::chrono::microseconds(frameAirtimeUs(size, rate_));
+    retry_delay = std::chrono::microseconds(250 * (retry_delay_ + 1));
+  }
+
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  for (uint8_t attempt = 0;; ++attempt) {
+    std::this_thread::sleep_for(TX_SETTLE);
+    const uint64_t id = medium_.beginTransmission(*this, channel);
+    std::this_thread::sleep_for(airtime);
+    uint8_t ack_size = 0;
+    const bool acked =
+        medium_.endTransmission(id, *this, bytes, size, auto_ack, ack_size);
+
+    if (!auto_ack || acked || attempt >= retry_count) {
+      if (acked)
+        std::this_thread::sleep_for(
+            TX_SETTLE +
+            std::chrono::microseconds(frameAirtimeUs(ack_size, rate)));
+      std::lock_guard<std::mutex> lock(medium_.mutex_);
+      arc_ = attempt;
+      const bool ok = !auto_ack || acked;
+      if (ok)
+        medium_.stats_.acked++;
+      else
+        medium_.stats_.failed++;
+      return ok;
+    }
+    std::this_thread::sleep_for(retry_delay);
+  }
+}
+
+bool SimTransport::writeAckPayload(uint8_t pipe, const void *data,
+                                   uint8_t size) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  if (pipe >= rx_pipes_.size() || ack_payloads_.size() >= TX_FIFO_DEPTH)
+    return false;
+  Frame frame;
+  frame.size = std::min<uint8_t>(size, RADIO_MAX_PAYLOAD);
+  std::memcpy(frame.data.data(), data, frame.size);
+  frame.pipe = pipe;
+  ack_payloads_.push_back(frame);
+  return true;
+}
+
+void SimTransport::flushAckPayloads() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  ack_payloads_.clear();
+}
+
+bool SimTransport::available(uint8_t *pipe) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  if (rx_fifo_.empty() || rx_fifo_.front().ready > Clock::now())
+    return false;
+  if (pipe)
+    *pipe = rx_fifo_.front().pipe;
+  return true;
+}
+
+uint8_t SimTransport::getDynamicPayloadSize() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  return rx_fifo_.empty() ? 0 : rx_fifo_.front().size;
+}
+
+void SimTransport::read(void *data, uint8_t size) {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  auto *out = static_cast<uint8_t *>(data);
+  if (rx_fifo_.empty()) {
+    std::memset(out, 0, size);
+    return;
+  }
+  const Frame &frame = rx_fifo_.front();
+  const uint8_t n = std::min(size, frame.size);
+  std::memcpy(out, frame.data.data(), n);
+  std::memset(out + n, 0, size - n);
+  rx_fifo_.pop_front();
+}
+
+uint64_t SimTransport::rxArrivalUs() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  if (rx_fifo_.empty())
+    return 0;
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          rx_fifo_.front().ready.time_since_epoch())
+          .count());
+}
+
+bool SimTransport::testRPD() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  return rpd_ || (listening_ && medium_.carrierOn(*this));
+}
+
+uint8_t SimTransport::getARC() {
+  std::lock_guard<std::mutex> lock(medium_.mutex_);
+  return arc_;
+}
+
+int SimTransport::interruptFd() { return irq_fd_; }
@@ -56,9 +56,15 @@ int main() {
   while (true) {
     int16_t ax = 0, ay = 0, az = 0;
     int16_t gx = 0, gy = 0, gz = 0;
-    bool ok =
-        sensor.readAcceleration(ax, ay, az) && sensor.readGyro(gx, gy, gz);
-    if (!ok) {
+    ImuSample s;
+    if (sensor.readSample(s)) {
+      ax = s.accel[0];
+      ay = s.accel[1];
+      az = s.accel[2];
+      gx = s.gyro[0];
+      gy = s.gyro[1];
+      gz = s.gyro[2];
+    } else {
       ax = randAccel(rng);
       ay = randAccel(rng);
       az = randAccel(rng);
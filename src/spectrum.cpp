@@ -0,0 +1,58 @@
+#include "../include/spectrum.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Integer hash (lowbias32) so neighbouring salts give unrelated orders.
+uint32_t mix(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
+}
+
+} // namespace
+
+SpectrumSurvey surveySpectrum(RadioInterface &radio, uint16_t sweeps,
+                              std::chrono::microseconds dwell) {
+  SpectrumSurvey survey;
+  const uint8_t channel = radio.channel();
+  for (uint16_t s = 0; s < sweeps; ++s) {
+    for (size_t ch = 0; ch < RADIO_CHANNELS; ++ch) {
+      if (radio.probeChannel(static_cast<uint8_t>(ch), dwell))
+        survey.hits[ch]++;
+    }
+    survey.sweeps++;
+  }
+  radio.setChannel(channel);
+  return survey;
+}
+
+uint8_t selectChannel(const SpectrumSurvey &survey,
+                      const ChannelSelectConfig &config, uint32_t salt) {
+  const int last = std::min<int>(config.last, RADIO_CHANNELS - 1);
+  int best = -1;
+  uint16_t best_hits = 0;
+  uint32_t best_rank = 0;
+  for (int ch = config.first; ch <= last; ++ch) {
+    if (std::abs(ch - JOIN_CHANNEL) < config.join_spacing)
+      continue;
+    uint16_t hits = 0;
+    const int lo = std::max(0, ch - config.guard);
+    const int hi = std::min<int>(RADIO_CHANNELS - 1, ch + config.guard);
+    for (int n = lo; n <= hi; ++n)
+      hits = std::max(hits, survey.hits[n]);
+    // Eşitlikte kanal sırası salt ile karıştırılır
+    const uint32_t rank = mix(static_cast<uint32_t>(ch) ^ (salt << 8));
+    if (best < 0 || hits < best_hits ||
+        (hits == best_hits && rank < best_rank)) {
+      best = ch;
+      best_hits = hits;
+      best_rank = rank;
+    }
+  }
+  return best < 0 ? JOIN_CHANNEL : static_cast<uint8_t>(best);
+}
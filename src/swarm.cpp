@@ -0,0 +1,159 @@
+#include "../include/swarm.hpp"
+#include "../include/packets.hpp"
+#include "../include/tdma.hpp"
+#include "../include/timebase.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static bool stopRequested(const std::atomic<bool> *stop) {
+  return stop && stop->load(std::memory_order_relaxed);
+}
+
+// Gelen paketleri işleyerek `deadline_us` anına kadar bekler
+static void serviceUntil(RadioInterface &radio, Drone &drone,
+                         uint64_t deadline_us) {
+  for (uint64_t now = monotonicMicros(); now < deadline_us;
+       now = monotonicMicros()) {
+    drone.handleIncoming();
+    radio.waitForFrame(std::chrono::microseconds(
+        std::min<uint64_t>(deadline_us - now, 10000)));
+  }
+  drone.handleIncoming();
+}
+
+// Örnekleyici thread'in son yayınladığı değeri alır, I2C beklemez
+static void sampleSensors(Drone &drone, const SensorSampler *sensors) {
+  SensorReading reading;
+  if (sensors && sensors->latest(reading)) {
+    drone.updateSensors(reading, 120.0f, 3.7f);
+    return;
+  }
+  const int16_t ax = static_cast<int16_t>(rand() % 100);
+  const int16_t ay = static_cast<int16_t>(rand() % 100);
+  const int16_t az = static_cast<int16_t>(rand() % 100);
+  const int16_t gx = static_cast<int16_t>(rand() % 50);
+  const int16_t gy = static_cast<int16_t>(rand() % 50);
+  const int16_t gz = static_cast<int16_t>(rand() % 50);
+  drone.updateSensors(ax, ay, az, gx, gy, gz, 120.0f, 3.7f);
+}
+
+// Lider döngüsü: her süper çerçeveyi bir beacon ile açar, takipçiler kendi
+// slotlarında telemetriyi lidere yollar, lider periyodunda toplanan
+// telemetri GBS'ye iletilir ve yer istasyonuyla konuşulur.
+void leaderLoop(RadioInterface &radio, Drone &drone,
+                const std::vector<DroneIdType> &swarm,
+                const std::atomic<bool> *stop, LeaderLoopStats *stats) {
+  radio.configure(radio.channel(), RadioDataRate::MEDIUM_RATE);
+  radio.setAddress(BASE_TX, BASE_RX);
+  radio.openListeningPipe(LEADER_PIPE, LEADER_TX);
+
+  // Slotlar en yavaş uplink oranına göre boyutlanır
+  TdmaConfig tdma;
+  if (drone.linkAdaptation())
+    tdma.rate = LinkAdapter::rungSettings(drone.linkConfig().min_rung).rate;
+  TdmaScheduler scheduler(tdma);
+  scheduler.setMembers(swarm);
+  const DroneIdType self = drone.getNetworkId().value_or(drone.getTempId());
+
+  while (drone.isLeader() && !stopRequested(stop)) {
+    BeaconPacket beacon = scheduler.nextBeacon(self, drone.clock().now32());
+    radio.sendTo(BASE_RX, &beacon, sizeof(beacon), true);
+    const uint64_t start = monotonicMicros();
+    if (stats) {
+      stats->superframes++;
+      stats->slots += beacon.slot_count;
+    }
+
+    // Takipçi slotları. Her slottan önce lider o takipçinin hızına geçer;
+    // ACK yükü modunda bekleyen komutu ACK yüküne yerleştirilir.
+    for (uint8_t i = 0; i < beacon.slot_count; ++i) {
+      const auto slot = tdmaSlotFor(beacon, beacon.slots[i], start);
+      drone.openSlot(beacon.slots[i], LEADER_PIPE);
+      drone.armDownlink(beacon.slots[i], LEADER_PIPE);
+      serviceUntil(radio, drone, slot->start_us + slot->length_us);
+    }
+    serviceUntil(radio, drone, start + TdmaScheduler::slotsEndUs(beacon));
+    drone.closeSlots();
+
+    // Lider periyodu: telemetriyi toplu ilet, takipçilerin saat isteklerini
+    // yanıtla, GBS ile saat eşle, yer istasyonuna izin ver ve komut bekle
+    drone.forwardTelemetry();
+    drone.flushDownlink(BASE_RX);
+    drone.answerTimeSync(BASE_RX);
+    drone.requestTimeSync();
+    PermissionToSendPacket perm{};
+    perm.target_drone_id = 0; // 0 -> GBS
+    perm.timestamp = drone.clock().now32();
+    radio.send(&perm, sizeof(perm));
+
+    const uint64_t end = start + scheduler.superframeUs(beacon);
+    for (uint64_t now = monotonicMicros(); now < end;
+         now = monotonicMicros()) {
+      RadioFrame frame;
+      if (radio.receive(frame)) {
+        const auto *cmd = frame.as<CommandPacket>();
+        if (cmd && cmd->target_drone_id == 0) {
+          if (std::strcmp(cmd->command, "no_need") == 0) {
+            // no action needed, simply noted
+          }
+          break;
+        }
+        drone.handleFrame(frame);
+        continue;
+      }
+      radio.waitForFrame(std::chrono::microseconds(end - now));
+    }
+
+    if (drone.hasRoleChanged()) {
+      drone.clearRoleChanged();
+      break;
+    }
+  }
+  radio.closeListeningPipe(LEADER_PIPE);
+}
+
+void followerLoop(RadioInterface &radio, Drone &drone,
+                  const SensorSampler *sensors,
+                  const std::atomic<bool> *stop) {
+  radio.setAddress(LEADER_TX, BASE_RX);
+  auto last_leader = std::chrono::steady_clock::now();
+
+  while (!drone.isLeader() && !stopRequested(stop)) {
+    drone.handleIncoming();
+    if (drone.lastHeartbeat() > last_leader)
+      last_leader = drone.lastHeartbeat();
+
+    // Kendi slotumuz geldiyse telemetri gönder
+    auto wait = std::chrono::microseconds(50000);
+    if (auto slot = drone.tdmaSlot()) {
+      const uint64_t now_us = monotonicMicros();
+      if (now_us >= slot->start_us) {
+        sampleSensors(drone, sensors);
+        if (drone.sendTelemetry())
+          drone.requestTimeSync(); // aynı slotta
+        drone.finishUplink();
+      } else {
+        wait = std::min(wait, std::chrono::microseconds(slot->start_us - now_us));
+      }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_leader > std::chrono::seconds(5)) {
+      LeaderRequestPacket req{};
+      req.drone_id = drone.getNetworkId().value_or(drone.getTempId());
+      req.timestamp = drone.clock().now32();
+      radio.sendTo(BASE_TX, &req, sizeof(req));
+      last_leader = now;
+    }
+
+    if (drone.hasRoleChanged()) {
+      drone.clearRoleChanged();
+      break;
+    }
+
+    radio.waitForFrame(wait);
+  }
+}
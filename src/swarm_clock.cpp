@@ -0,0 +1,137 @@
+#include "../include/swarm_clock.hpp"
+#include <algorithm>
+#include <cmath>
+
+uint64_t SwarmClock::fromMonotonic(uint64_t mono_us) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (model_offset_ == 0 && model_drift_ == 0.0)
+    return mono_us;
+  const double skew = static_cast<double>(mono_us) * model_drift_ * 1e-6;
+  return static_cast<uint64_t>(static_cast<int64_t>(mono_us) + model_offset_ +
+                               static_cast<int64_t>(std::llround(skew)));
+}
+
+uint64_t SwarmClock::toSwarm(uint64_t local_us) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const double since =
+      static_cast<double>(static_cast<int64_t>(local_us - anchor_));
+  return local_us + static_cast<uint64_t>(offset_) +
+         static_cast<uint64_t>(std::llround(since * drift_));
+}
+
+bool SwarmClock::addSample(uint64_t t1, uint64_t t2, uint64_t t3,
+                           uint64_t t4) {
+  const int64_t local_span = static_cast<int64_t>(t4 - t1);
+  const int64_t remote_hold = static_cast<int64_t>(t3 - t2);
+  if (local_span < 0 || remote_hold < 0)
+    return false;
+
+  Sample s;
+  s.local_us = t1 + static_cast<uint64_t>(local_span / 2);
+  s.offset_us =
+      (static_cast<int64_t>(t2 - t1) + static_cast<int64_t>(t3 - t4)) / 2;
+  s.delay_us = std::max<int64_t>(local_span - remote_hold, 0);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The reference stepped (e.g. a new leader, or the leader synced to the
+  // ground station): older samples no longer describe it.
+  if (count_ > 0) {
+    const double since =
+        static_cast<double>(static_cast<int64_t>(s.local_us - anchor_));
+    const double predicted = static_cast<double>(offset_) + since * drift_;
+    if (std::fabs(static_cast<double>(s.offset_us) - predicted) >
+        SWARM_CLOCK_STEP_US) {
+      count_ = 0;
+      next_ = 0;
+      drift_ = 0.0;
+    }
+  }
+  window_[next_] = s;
+  next_ = (next_ + 1) % window_.size();
+  count_ = std::min(count_ + 1, window_.size());
+  updateEstimate();
+  return true;
+}
+
+void SwarmClock::updateEstimate() {
+  const Sample *best = &window_[0];
+  for (size_t i = 1; i < count_; ++i)
+    if (window_[i].delay_us < best->delay_us)
+      best = &window_[i];
+
+  // Weighted fit: samples delayed by queueing well beyond the best one
+  // carry an asymmetric error and count little.
+  double sw = 0, sx = 0, sy = 0;
+  std::array<double, SWARM_CLOCK_WINDOW> w{}, x{}, y{};
+  for (size_t i = 0; i < count_; ++i) {
+    const Sample &s = window_[i];
+    const double excess =
+        static_cast<double>(s.delay_us - best->delay_us) / 250.0;
+    w[i] = 1.0 / (1.0 + excess * excess);
+    x[i] = static_cast<double>(
+        static_cast<int64_t>(s.local_us - best->local_us));
+    y[i] = static_cast<double>(s.offset_us - best->offset_us);
+    sw += w[i];
+    sx += w[i] * x[i];
+    sy += w[i] * y[i];
+  }
+  const double mx = sx / sw;
+  const double my = sy / sw;
+  double sxx = 0, sxy = 0;
+  for (size_t i = 0; i < count_; ++i) {
+    sxx += w[i] * (x[i] - mx) * (x[i] - mx);
+    sxy += w[i] * (x[i] - mx) * (y[i] - my);
+  }
+  double drift = drift_;
+  // Require about a second of spread so noise does not dominate the slope.
+  if (count_ >= 3 && sxx > sw * 0.25e12) {
+    const double max = SWARM_CLOCK_MAX_DRIFT_PPM * 1e-6;
+    drift = std::clamp(sxy / sxx, -max, max);
+  }
+
+  anchor_ = best->local_us + static_cast<uint64_t>(std::llround(mx));
+  offset_ = best->offset_us + std::llround(my);
+  drift_ = drift;
+  delay_ = best->delay_us;
+}
+
+bool SwarmClock::synced() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_ >= 2;
+}
+
+size_t SwarmClock::samples() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+int64_t SwarmClock::offsetUs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return offset_;
+}
+
+double SwarmClock::driftPpm() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return drift_ * 1e6;
+}
+
+int64_t SwarmClock::delayUs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return delay_;
+}
+
+void SwarmClock::setLocalModel(int64_t offset_us, double drift_ppm) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  model_offset_ = offset_us;
+  model_drift_ = drift_ppm;
+}
+
+void SwarmClock::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  count_ = 0;
+  next_ = 0;
+  anchor_ = 0;
+  offset_ = 0;
+  drift_ = 0.0;
+  delay_ = 0;
+}
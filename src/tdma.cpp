@@ -0,0 +1,73 @@
+#include "../include/tdma.hpp"
+#include <algorithm>
+#include <limits>
+
+uint32_t tdmaExchangeUs(size_t payload, RadioDataRate rate,
+                        size_t ack_payload) {
+  return frameTxLeadUs(payload, rate) + frameTxLeadUs(ack_payload, rate);
+}
+
+TdmaScheduler::TdmaScheduler(TdmaConfig config) : config_(config) {}
+
+void TdmaScheduler::setMembers(std::vector<DroneIdType> members) {
+  members_ = std::move(members);
+  next_member_ = 0;
+}
+
+uint32_t TdmaScheduler::minSlotUs() const {
+  return tdmaExchangeUs(RADIO_MAX_PAYLOAD, config_.rate,
+                        sizeof(CommandPacket)) +
+         tdmaExchangeUs(RADIO_MAX_PAYLOAD, config_.rate) + config_.guard_us;
+}
+
+uint32_t TdmaScheduler::slotLength(size_t slot_count) const {
+  if (slot_count == 0)
+    return 0;
+  const uint32_t fixed = config_.guard_us + config_.leader_us;
+  const uint32_t available =
+      config_.superframe_us > fixed ? config_.superframe_us - fixed : 0;
+  const uint32_t share = available / static_cast<uint32_t>(slot_count);
+  const uint32_t upper =
+      std::min<uint32_t>(std::max(config_.max_slot_us, minSlotUs()),
+                         std::numeric_limits<uint16_t>::max());
+  return std::clamp(share, minSlotUs(), upper);
+}
+
+BeaconPacket TdmaScheduler::nextBeacon(DroneIdType leader_id,
+                                       uint32_t timestamp) {
+  BeaconPacket beacon{};
+  beacon.leader_id = leader_id;
+  beacon.superframe = superframe_++;
+  beacon.timestamp = timestamp;
+  beacon.slot_offset_us = static_cast<uint16_t>(config_.guard_us);
+
+  const size_t count = std::min(members_.size(), MAX_TDMA_SLOTS);
+  for (size_t i = 0; i < count; ++i) {
+    beacon.slots[i] = members_[next_member_];
+    next_member_ = (next_member_ + 1) % members_.size();
+  }
+  beacon.slot_count = static_cast<uint8_t>(count);
+  beacon.slot_us = static_cast<uint16_t>(slotLength(count));
+  return beacon;
+}
+
+uint32_t TdmaScheduler::slotsEndUs(const BeaconPacket &beacon) {
+  return beacon.slot_offset_us +
+         static_cast<uint32_t>(beacon.slot_count) * beacon.slot_us;
+}
+
+uint32_t TdmaScheduler::superframeUs(const BeaconPacket &beacon) const {
+  return slotsEndUs(beacon) + config_.leader_us;
+}
+
+std::optional<TdmaSlot> tdmaSlotFor(const BeaconPacket &beacon,
+                                    DroneIdType self, uint64_t beacon_rx_us) {
+  const size_t count = std::min<size_t>(beacon.slot_count, MAX_TDMA_SLOTS);
+  for (size_t i = 0; i < count; ++i) {
+    if (beacon.slots[i] == self)
+      return TdmaSlot{beacon_rx_us + beacon.slot_offset_us +
+                          static_cast<uint64_t>(i) * beacon.slot_us,
+                      beacon.slot_us};
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,66 @@
+#include "../include/telemetry_aggregator.hpp"
+#include <algorithm>
+
+namespace {
+
+// Rounds to the nearest multiple of 256 and keeps the high byte.
+int8_t reduce(int16_t raw) {
+  const int value = (static_cast<int>(raw) + 128) >> 8;
+  return static_cast<int8_t>(std::clamp(value, -128, 127));
+}
+
+int16_t expand(int8_t reduced) {
+  return static_cast<int16_t>(static_cast<int>(reduced) * 256);
+}
+
+} // namespace
+
+AggregateTelemetryEntry packTelemetry(const TelemetryPacket &tlm) {
+  AggregateTelemetryEntry entry{};
+  entry.drone_id = tlm.drone_id;
+  entry.acceleration[0] = reduce(tlm.acceleration_x);
+  entry.acceleration[1] = reduce(tlm.acceleration_y);
+  entry.acceleration[2] = reduce(tlm.acceleration_z);
+  entry.gyroscope[0] = reduce(tlm.gyroscope_x);
+  entry.gyroscope[1] = reduce(tlm.gyroscope_y);
+  entry.gyroscope[2] = reduce(tlm.gyroscope_z);
+  return entry;
+}
+
+TelemetryPacket unpackTelemetry(const AggregateTelemetryEntry &entry) {
+  TelemetryPacket tlm{};
+  tlm.drone_id = entry.drone_id;
+  tlm.acceleration_x = expand(entry.acceleration[0]);
+  tlm.acceleration_y = expand(entry.acceleration[1]);
+  tlm.acceleration_z = expand(entry.acceleration[2]);
+  tlm.gyroscope_x = expand(entry.gyroscope[0]);
+  tlm.gyroscope_y = expand(entry.gyroscope[1]);
+  tlm.gyroscope_z = expand(entry.gyroscope[2]);
+  return tlm;
+}
+
+void TelemetryAggregator::add(const TelemetryPacket &tlm) {
+  const AggregateTelemetryEntry entry = packTelemetry(tlm);
+  for (auto &e : pending_) {
+    if (e.drone_id == entry.drone_id) {
+      e = entry;
+      return;
+    }
+  }
+  pending_.push_back(entry);
+}
+
+bool TelemetryAggregator::nextFrame(DroneIdType leader_id,
+                                    AggregateTelemetryPacket &out) {
+  if (pending_.empty())
+    return false;
+
+  const size_t count = std::min(pending_.size(), MAX_AGGREGATE_ENTRIES);
+  out = AggregateTelemetryPacket{};
+  out.leader_id = leader_id;
+  out.sequence = sequence_++;
+  out.count = static_cast<uint8_t>(count);
+  std::copy_n(pending_.begin(), count, out.entries);
+  pending_.erase(pending_.begin(), pending_.begin() + count);
+  return true;
+}
@@ -0,0 +1,330 @@
+#include "../include/telemetry_codec.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t KEYFRAME_FLAG = 0x80;
+constexpr uint8_t COUNT_MASK = 0x7F;
+// Fixed-width first sample of a keyframe: imu 6x2, timestamp 4, battery 2,
+// altitude 4, link quality 1, status 1.
+constexpr size_t KEYFRAME_SAMPLE_SIZE = 24;
+// Mask byte plus 11 varints of at most 5 bytes.
+constexpr size_t MAX_DELTA_SAMPLE_SIZE = 1 + 11 * 5;
+
+// Delta samples: mask byte, six IMU varints, then the slow fields whose
+// mask bit is set (bit 0 timestamp, 1 battery, 2 altitude, 3 link quality,
+// 4 status).
+
+uint32_t zigzag(int32_t v) {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+int32_t unzigzag(uint32_t v) {
+  return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+size_t putVarint(uint8_t *out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+// Returns false on a truncated or over-long varint.
+bool getVarint(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 35 && p < end; shift += 7) {
+    const uint8_t byte = *p++;
+    v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+int32_t diff(int32_t a, int32_t b) {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) -
+                              static_cast<uint32_t>(b));
+}
+
+int32_t add(int32_t a, int32_t b) {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) +
+                              static_cast<uint32_t>(b));
+}
+
+size_t encodeDelta(const QuantisedTelemetry &s, const QuantisedTelemetry &ref,
+                   uint8_t *out) {
+  uint8_t mask = 0;
+  size_t n = 1;
+  for (int i = 0; i < 6; ++i)
+    n += putVarint(out + n, zigzag(diff(s.imu[i], ref.imu[i])));
+
+  const int32_t slow[] = {
+      diff(static_cast<int32_t>(s.timestamp),
+           static_cast<int32_t>(ref.timestamp)),
+      diff(s.battery_10mv, ref.battery_10mv),
+      diff(s.altitude_cm, ref.altitude_cm),
+      diff(s.link_quality_half, ref.link_quality_half),
+      diff(s.status, ref.status)};
+  for (int i = 0; i < 5; ++i) {
+    if (slow[i] != 0) {
+      mask |= static_cast<uint8_t>(1 << i);
+      n += putVarint(out + n, zigzag(slow[i]));
+    }
+  }
+  out[0] = mask;
+  return n;
+}
+
+bool decodeDelta(const uint8_t *&p, const uint8_t *end,
+                 const QuantisedTelemetry &ref, QuantisedTelemetry &s) {
+  if (p >= end)
+    return false;
+  const uint8_t mask = *p++;
+  uint32_t v;
+  for (int i = 0; i < 6; ++i) {
+    if (!getVarint(p, end, v))
+      return false;
+    s.imu[i] = add(ref.imu[i], unzigzag(v));
+  }
+
+  int32_t slow[] = {static_cast<int32_t>(ref.timestamp), ref.battery_10mv,
+                    ref.altitude_cm, ref.link_quality_half, ref.status};
+  for (int i = 0; i < 5; ++i) {
+    if (!(mask & (1 << i)))
+      continue;
+    if (!getVarint(p, end, v))
+      return false;
+    slow[i] = add(slow[i], unzigzag(v));
+  }
+  s.timestamp = static_cast<uint32_t>(slow[0]);
+  s.battery_10mv = slow[1];
+  s.altitude_cm = slow[2];
+  s.link_quality_half = slow[3];
+  s.status = slow[4];
+  return true;
+}
+
+template <typename T> void putFixed(uint8_t *&out, T v) {
+  std::memcpy(out, &v, sizeof(v));
+  out += sizeof(v);
+}
+
+template <typename T> T getFixed(const uint8_t *&p) {
+  T v;
+  std::memcpy(&v, p, sizeof(v));
+  p += sizeof(v);
+  return v;
+}
+
+size_t encodeKeyframe(const QuantisedTelemetry &s, uint8_t *out) {
+  uint8_t *p = out;
+  for (int i = 0; i < 6; ++i)
+    putFixed(p, static_cast<int16_t>(s.imu[i]));
+  putFixed(p, s.timestamp);
+  putFixed(p, static_cast<uint16_t>(s.battery_10mv));
+  putFixed(p, s.altitude_cm);
+  putFixed(p, static_cast<uint8_t>(s.link_quality_half));
+  putFixed(p, static_cast<uint8_t>(s.status));
+  return static_cast<size_t>(p - out);
+}
+
+void decodeKeyframe(const uint8_t *&p, QuantisedTelemetry &s) {
+  for (int i = 0; i < 6; ++i)
+    s.imu[i] = getFixed<int16_t>(p);
+  s.timestamp = getFixed<uint32_t>(p);
+  s.battery_10mv = getFixed<uint16_t>(p);
+  s.altitude_cm = getFixed<int32_t>(p);
+  s.link_quality_half = getFixed<uint8_t>(p);
+  s.status = getFixed<uint8_t>(p);
+}
+
+int32_t quantise(float value, float scale, int32_t lo, int32_t hi) {
+  if (!std::isfinite(value))
+    return 0;
+  const double q = std::round(static_cast<double>(value) * scale);
+  return static_cast<int32_t>(std::clamp<double>(q, lo, hi));
+}
+
+} // namespace
+
+static_assert(KEYFRAME_SAMPLE_SIZE <= COMPRESSED_TELEMETRY_PAYLOAD,
+              "keyframe sample must fit in an empty frame");
+
+QuantisedTelemetry quantiseTelemetry(const TelemetryPacket &tlm) {
+  QuantisedTelemetry q;
+  q.timestamp = tlm.timestamp;
+  q.imu[0] = tlm.acceleration_x;
+  q.imu[1] = tlm.acceleration_y;
+  q.imu[2] = tlm.acceleration_z;
+  q.imu[3] = tlm.gyroscope_x;
+  q.imu[4] = tlm.gyroscope_y;
+  q.imu[5] = tlm.gyroscope_z;
+  q.battery_10mv = quantise(tlm.battery_voltage, 100.0f, 0, 0xFFFF);
+  q.altitude_cm = quantise(tlm.altitude, 100.0f, -2000000000, 2000000000);
+  q.link_quality_half = quantise(tlm.link_quality, 2.0f, 0, 200);
+  q.status = (tlm.rpd & 1) | (std::min<int32_t>(tlm.retries, 127) << 1);
+  return q;
+}
+
+TelemetryPacket dequantiseTelemetry(const QuantisedTelemetry &q,
+                                    DroneIdType drone_id) {
+  TelemetryPacket tlm{};
+  tlm.drone_id = drone_id;
+  tlm.timestamp = q.timestamp;
+  tlm.acceleration_x = static_cast<int16_t>(q.imu[0]);
+  tlm.acceleration_y = static_cast<int16_t>(q.imu[1]);
+  tlm.acceleration_z = static_cast<int16_t>(q.imu[2]);
+  tlm.gyroscope_x = static_cast<int16_t>(q.imu[3]);
+  tlm.gyroscope_y = static_cast<int16_t>(q.imu[4]);
+  tlm.gyroscope_z = static_cast<int16_t>(q.imu[5]);
+  tlm.battery_voltage = static_cast<float>(q.battery_10mv) / 100.0f;
+  tlm.altitude = static_cast<float>(q.altitude_cm) / 100.0f;
+  tlm.link_quality = static_cast<float>(q.link_quality_half) / 2.0f;
+  tlm.rpd = static_cast<uint8_t>(q.status & 1);
+  tlm.retries = static_cast<uint8_t>(q.status >> 1);
+  return tlm;
+}
+
+// ==================== Encoder ==================== //
+
+TelemetryEncoder::TelemetryEncoder(DroneIdType drone_id,
+                                   uint8_t keyframe_interval)
+    : drone_id_(drone_id), keyframe_interval_(keyframe_interval) {}
+
+bool TelemetryEncoder::needKeyframe() const {
+  if (!reference_ || since_keyframe_ >= keyframe_interval_)
+    return true;
+  const uint8_t age = static_cast<uint8_t>(next_sequence_ - *reference_);
+  return age >= TELEMETRY_CODEC_HISTORY;
+}
+
+bool TelemetryEncoder::push(const TelemetryPacket &tlm) {
+  const QuantisedTelemetry q = quantiseTelemetry(tlm);
+  uint8_t buf[MAX_DELTA_SAMPLE_SIZE];
+  size_t n;
+
+  if (count_ == 0) {
+    frame_ = CompressedTelemetryPacket{};
+    frame_.drone_id = drone_id_;
+    frame_.sequence = next_sequence_;
+    bool keyframe = needKeyframe();
+    if (!keyframe) {
+      n = encodeDelta(q, reference_sample_, buf);
+      keyframe = n > COMPRESSED_TELEMETRY_PAYLOAD;
+    }
+    if (keyframe) {
+      n = encodeKeyframe(q, buf);
+      frame_.reference = frame_.sequence;
+      frame_.flags = KEYFRAME_FLAG;
+      since_keyframe_ = 0;
+    } else {
+      frame_.reference = *reference_;
+    }
+  } else {
+    if (count_ == COUNT_MASK)
+      return false;
+    n = encodeDelta(q, previous_, buf);
+    if (used_ + n > COMPRESSED_TELEMETRY_PAYLOAD)
+      return false;
+  }
+
+  std::memcpy(frame_.payload + used_, buf, n);
+  used_ = static_cast<uint8_t>(used_ + n);
+  count_++;
+  next_sequence_++;
+  if (since_keyframe_ < 0xFF)
+    since_keyframe_++;
+  previous_ = q;
+  return true;
+}
+
+CompressedTelemetryPacket TelemetryEncoder::takeFrame() {
+  CompressedTelemetryPacket frame = frame_;
+  frame.flags = static_cast<uint8_t>((frame_.flags & KEYFRAME_FLAG) | count_);
+  if (count_ > 0) {
+    const uint8_t last = static_cast<uint8_t>(next_sequence_ - 1);
+    sent_[last % TELEMETRY_CODEC_HISTORY] = previous_;
+    sent_seq_[last % TELEMETRY_CODEC_HISTORY] = last;
+  }
+  count_ = 0;
+  used_ = 0;
+  return frame;
+}
+
+void TelemetryEncoder::acknowledge(const CompressedTelemetryPacket &frame) {
+  const uint8_t count = frame.flags & COUNT_MASK;
+  if (count == 0)
+    return;
+  const uint8_t last = static_cast<uint8_t>(frame.sequence + count - 1);
+  const size_t slot = last % TELEMETRY_CODEC_HISTORY;
+  if (sent_seq_[slot] != last ||
+      static_cast<uint8_t>(next_sequence_ - 1 - last) >=
+          TELEMETRY_CODEC_HISTORY)
+    return;
+  // Never move the reference backwards on a late ACK.
+  if (reference_ && static_cast<int8_t>(last - *reference_) <= 0)
+    return;
+  reference_ = last;
+  reference_sample_ = sent_[slot];
+}
+
+void TelemetryEncoder::reset() {
+  count_ = 0;
+  used_ = 0;
+  since_keyframe_ = 0;
+  sent_seq_ = {};
+  reference_.reset();
+}
+
+// ==================== Decoder ==================== //
+
+size_t TelemetryDecoder::decode(const CompressedTelemetryPacket &frame,
+                                TelemetryPacket *out, size_t max) {
+  const size_t count = frame.flags & COUNT_MASK;
+  const bool keyframe = frame.flags & KEYFRAME_FLAG;
+  if (count == 0)
+    return 0;
+
+  QuantisedTelemetry sample;
+  if (!keyframe) {
+    const size_t slot = frame.reference % TELEMETRY_CODEC_HISTORY;
+    if (history_seq_[slot] != frame.reference)
+      return 0;
+    sample = history_[slot];
+  }
+
+  // Decode into a scratch copy first so a malformed frame changes nothing.
+  std::array<QuantisedTelemetry, COMPRESSED_TELEMETRY_PAYLOAD> decoded;
+  if (count > decoded.size())
+    return 0;
+  const uint8_t *p = frame.payload;
+  const uint8_t *end = frame.payload + COMPRESSED_TELEMETRY_PAYLOAD;
+  for (size_t i = 0; i < count; ++i) {
+    if (i == 0 && keyframe) {
+      decodeKeyframe(p, sample);
+    } else {
+      QuantisedTelemetry next;
+      if (!decodeDelta(p, end, sample, next))
+        return 0;
+      sample = next;
+    }
+    decoded[i] = sample;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const uint8_t seq = static_cast<uint8_t>(frame.sequence + i);
+    history_[seq % TELEMETRY_CODEC_HISTORY] = decoded[i];
+    history_seq_[seq % TELEMETRY_CODEC_HISTORY] = seq;
+    if (i < max)
+      out[i] = dequantiseTelemetry(decoded[i], frame.drone_id);
+  }
+  return std::min(count, max);
+}
+
+void TelemetryDecoder::reset() { history_seq_ = {}; }